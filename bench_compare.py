@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+import sys
+import json
+import argparse
+
+def load_results(path):
+    """Benchmarks of a bench.json file, keyed by name."""
+    with open(path) as f_json:
+        data = json.load(f_json)
+    return {b["name"]: b for b in data.get("benchmarks", [])}
+
+def relative_change(current, baseline):
+    """Change of current over baseline, as a fraction of the baseline."""
+    if baseline == 0:
+        return 0.0 if current == 0 else float("inf")
+    return (current - baseline) / baseline
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare micro-benchmark results against a saved baseline")
+    parser.add_argument("current", help="bench.json of the run under test")
+    parser.add_argument("baseline", help="bench.json saved as the baseline (make bench_baseline)")
+    parser.add_argument("--cycle-tol", type=float, default=0.0,
+                        help="Allowed relative increase of the simulated cycles per sample or beat (default: 0)")
+    parser.add_argument("--speed-tol", type=float, default=0.25,
+                        help="Allowed relative increase of the host ns per simulated cycle (default: 0.25)")
+    args = parser.parse_args()
+
+    current = load_results(args.current)
+    baseline = load_results(args.baseline)
+
+    hw_regressions = []
+    speed_regressions = []
+    print(f"{'benchmark':<14} {'cycles/unit':>12} {'baseline':>10} {'change':>8}   {'ns/cycle':>9} {'baseline':>9} {'change':>8}")
+    for name, cur in current.items():
+        base = baseline.get(name)
+        if base is None:
+            print(f"{name:<14} {cur['cycles_per_unit']:>12.3f} {'-':>10} {'new':>8}   {cur['host_ns_per_cycle']:>9.1f} {'-':>9} {'new':>8}")
+            continue
+        hw = relative_change(cur["cycles_per_unit"], base["cycles_per_unit"])
+        speed = relative_change(cur["host_ns_per_cycle"], base["host_ns_per_cycle"])
+        flags = ""
+        if hw > args.cycle_tol + 1e-9:
+            hw_regressions.append(name)
+            flags += " [HW REGRESSION]"
+        if speed > args.speed_tol:
+            speed_regressions.append(name)
+            flags += " [SPEED REGRESSION]"
+        print(f"{name:<14} {cur['cycles_per_unit']:>12.3f} {base['cycles_per_unit']:>10.3f} {hw:>+8.1%}   "
+              f"{cur['host_ns_per_cycle']:>9.1f} {base['host_ns_per_cycle']:>9.1f} {speed:>+8.1%}{flags}")
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<14} missing from {args.current}")
+            hw_regressions.append(name)
+
+    # Hardware throughput is deterministic; host speed varies with the machine and its load
+    if hw_regressions:
+        print(f"[ FAIL ] Hardware throughput regressed: {', '.join(hw_regressions)}")
+    if speed_regressions:
+        print(f"[ FAIL ] Model speed regressed by more than {args.speed_tol:.0%}: {', '.join(speed_regressions)}")
+    if not hw_regressions and not speed_regressions:
+        print("[ PASS ] No regression against the baseline")
+    sys.exit((1 if hw_regressions else 0) | (2 if speed_regressions else 0))
+
+if __name__ == "__main__":
+    main()
@@ -1,8 +1,15 @@
+import argparse
 import numpy as np
 import os
 
-def generate_stimulus_file(filename, samples, core_id):
-    """Generates standard address_hex,data_hex CSV file matching SlaveFromFile format."""
+def generate_stimulus_file(filename, samples, core_id, fmt=None, lanes=1, real=False):
+    """Generates an address_hex,data_hex CSV file matching the SlaveFromFile format, or with
+    fmt "bin" (default for a .bin filename) the packed little-endian 64-bit words read by
+    the mmap backdoor loaders (STIMULUS_BIN, Memory::load). A word holds lanes samples
+    (FFT_LANES builds), each with 64 / (2 * lanes)-bit parts. With real (FFT_REAL_INPUT
+    builds) the real signal is written two samples per word, the even one in the real part."""
+    if fmt is None:
+        fmt = "bin" if filename.endswith(".bin") else "csv"
     os.makedirs(os.path.dirname(filename), exist_ok=True)
     
     # We align the waveforms to a base period of 8 samples so they are periodic
@@ -54,17 +61,40 @@ def generate_stimulus_file(filename, samples, core_id):
         freq = 1.0 + (core_id % 3)
         real_data = amplitude * np.sin(2 * np.pi * freq * t / period)
 
+    if real:
+        real_data, imag_data = real_data[0::2], real_data[1::2]
+        samples //= 2
+
+    # Two's complement parts of 64 / (2 * lanes) bits (sign-extended to 32 bits for one lane),
+    # sample l of a word in bits [2 * l * bits, 2 * (l + 1) * bits), real part upper
+    bits = 64 // (2 * lanes)
+    mask = (1 << bits) - 1
+    real_words = np.round(real_data).astype(np.int64) & mask
+    imag_words = np.round(imag_data).astype(np.int64) & mask
+    samples_words = (real_words.astype(np.uint64) << np.uint64(bits)) | imag_words.astype(np.uint64)
+    packed = np.zeros(samples // lanes, dtype=np.uint64)
+    for l in range(lanes):
+        packed |= samples_words[l::lanes][:len(packed)] << np.uint64(2 * bits * l)
+    if fmt == "bin":
+        packed.astype("<u8").tofile(filename)
+        return
+
     with open(filename, 'w') as f:
-        for i in range(samples):
+        for i in range(len(packed)):
             byte_addr = i * 8
-            # Sign-extend the 16-bit values to 32 bits to correctly represent negative numbers
-            real_val = int(np.round(real_data[i])) & 0xFFFFFFFF
-            imag_val = int(np.round(imag_data[i])) & 0xFFFFFFFF
-            packed_val = (real_val << 32) | imag_val
-            f.write(f"0x{byte_addr:08x},0x{packed_val:016x}\n")
+            f.write(f"0x{byte_addr:08x},0x{int(packed[i]):016x}\n")
 
 if __name__ == "__main__":
-    NUM_CORES = 2
-    SAMPLES = 128
-    for i in range(NUM_CORES):
-        generate_stimulus_file("out/test_runs/test_n8_file_stim/stimulus_core_{}.csv".format(i+1), SAMPLES, i)
+    parser = argparse.ArgumentParser(description="Generate per-core FFT stimulus files")
+    parser.add_argument("--num_cores", type=int, default=2, help="Number of cores")
+    parser.add_argument("--samples", type=int, default=128, help="Samples per core")
+    parser.add_argument("--format", choices=["csv", "bin"], default="csv",
+                        help="SlaveFromFile CSV or binary words for STIMULUS_BIN")
+    parser.add_argument("--lanes", type=int, default=1, help="Samples per 64-bit word (FFT_LANES)")
+    parser.add_argument("--real", action="store_true", help="Two real samples per word (FFT_REAL_INPUT)")
+    parser.add_argument("--out_dir", type=str, default="out/test_runs/test_n8_file_stim",
+                        help="Output directory")
+    args = parser.parse_args()
+    for i in range(args.num_cores):
+        filename = os.path.join(args.out_dir, f"stimulus_core_{i + 1}.{args.format}")
+        generate_stimulus_file(filename, args.samples, i, args.format, args.lanes, args.real)
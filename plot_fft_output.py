@@ -12,6 +12,7 @@ def main():
     parser.add_argument('--input_files', type=str, default="out/data/core{}_input.csv", help="Input file path template")
     parser.add_argument('--output_files', type=str, default="out/data/core{}_output.csv", help="Output file path template")
     parser.add_argument('--out_img_dir', type=str, default="out/img", help="Output directory for generated plots")
+    parser.add_argument('--natural_order', action='store_true', help="Outputs were written in natural order (no bit-reversal)")
     parser.add_argument('--fs', type=float, default=1e9, help="Sampling frequency (default: 1e9 for 1 GHz)")
     
     args = parser.parse_args()
@@ -52,7 +53,9 @@ def main():
         expected_spectrum = np.mean(np.abs(expected_fft), axis=0)
 
         # Handle N=1 edge case for bit-reversal
-        if N > 1:
+        if args.natural_order:
+            order = list(range(N))
+        elif N > 1:
             num_bits = int(np.log2(N))
             order = [int(f"{b:0{num_bits}b}"[::-1], 2) for b in range(N)]
         else:
@@ -4,15 +4,29 @@ import subprocess
 import time
 import json
 import argparse
+import re
 from generate_stimulus import generate_stimulus_file
 
 TARGET = "tb_system_wmem"
 
+# Cases using any of these parameters run on tb_system, which models them (tb_system_wmem
+# has no block-floating-point datapath, runs every job forward at length N and unwindowed,
+# neither prunes butterflies nor selects bins, simulates all cores in one kernel, and moves
+# one complex sample per beat)
+SYSTEM_TARGET = "tb_system"
+SYSTEM_PARAMS = ("BFP", "FFT_LEN", "STFT_HOP", "WINDOW", "PRUNE", "BIN_LO", "BIN_HI",
+                 "INVERSE", "PARTITION", "LANES", "REAL_INPUT")
+
 def run_command(cmd, env=None):
     """Runs a shell command and returns output, error, and return code."""
     res = subprocess.run(cmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, env=env)
     return res.stdout, res.stderr, res.returncode
 
+def perf_cycles(sim_out):
+    """CYCLES of the PERFORMANCE_RESULT line of a simulation log (None without one)."""
+    match = re.search(r"PERFORMANCE_RESULT:.*\bCYCLES=(\S+)", sim_out)
+    return float(match.group(1)) if match else None
+
 def main():
     print("=" * 60)
     print(" FFT SystemC Multi-Configuration Test Runner")
@@ -61,11 +75,33 @@ def main():
         samples = params["SAMPLES"]
         num_adds = params["NUM_ADDS"] if "NUM_ADDS" in params else 6
         num_muls = params["NUM_MULS"] if "NUM_MULS" in params else 4
+        radix = params["RADIX"] if "RADIX" in params else 2
+        stream_jobs = params["STREAM_JOBS"] if "STREAM_JOBS" in params else 0
+        desc_frames = params["DESC_FRAMES"] if "DESC_FRAMES" in params else 0
+        sched_jobs = params["SCHED_JOBS"] if "SCHED_JOBS" in params else 0
+        fft_len = params["FFT_LEN"] if "FFT_LEN" in params else 0
+        stft_hop = params["STFT_HOP"] if "STFT_HOP" in params else 0
+        window = params["WINDOW"] if "WINDOW" in params else 0
+        prune = 1 if params.get("PRUNE", False) else 0
+        bin_lo = params["BIN_LO"] if "BIN_LO" in params else 0
+        bin_hi = params["BIN_HI"] if "BIN_HI" in params else 0
+        inverse = 1 if params.get("INVERSE", False) else 0
+        partition = 1 if params.get("PARTITION", False) else 0
+        natural_order = 1 if params.get("NATURAL_ORDER", False) else 0
+        fold_bf = params["FOLD_BF"] if "FOLD_BF" in params else 0
+        shared_banks = params["SHARED_BANKS"] if "SHARED_BANKS" in params else 0
+        lanes = params["LANES"] if "LANES" in params else 1
+        real_input = 1 if params.get("REAL_INPUT", False) else 0
+        bfp = 1 if params.get("BFP", False) else 0
+        scale_mask = params["SCALE_MASK"] if "SCALE_MASK" in params else 0
+        fixed_w = params["FIXED_W"] if "FIXED_W" in params else None
+        fixed_i = params["FIXED_I"] if "FIXED_I" in params else 32
         use_file_stim = params["use_file_stim"]
-        print(f"\n[ RUNNING ] {name} (N={N}, Cores={num_cores}, Hop={hop}, Samples={samples}, Adds={num_adds}, Muls={num_muls})")
+        target = SYSTEM_TARGET if any(params.get(key) for key in SYSTEM_PARAMS) else TARGET
+        print(f"\n[ RUNNING ] {name} (N={N}, Cores={num_cores}, Hop={hop}, Samples={samples}, Adds={num_adds}, Muls={num_muls}, Radix={radix}, Target={target})")
         
         # Clean build artifacts of tb_system to force rebuild with new parameters
-        run_command(f"rm -f build/{TARGET}.o build/{TARGET}")
+        run_command(f"rm -f build/{target}.o build/{target}")
         
         # Build command with configuration parameters passed as compiler macros
         cxx_flags = (
@@ -74,12 +110,32 @@ def main():
             f"-DFFT_HOP={hop} "
             f"-DFFT_SAMPLES={samples} "
             f"-DFFT_NUM_MULT={num_muls} "
-            f"-DFFT_NUM_ADD={num_adds}"
+            f"-DFFT_NUM_ADD={num_adds} "
+            f"-DFFT_RADIX={radix} "
+            f"-DFFT_SCALE_MASK={scale_mask} "
+            f"-DFFT_STREAM_JOBS={stream_jobs} "
+            f"-DFFT_DESC_FRAMES={desc_frames} "
+            f"-DFFT_SCHED_JOBS={sched_jobs} "
+            f"-DFFT_LEN={fft_len} "
+            f"-DFFT_STFT_HOP={stft_hop} "
+            f"-DFFT_WINDOW={window} "
+            f"-DFFT_PRUNE={prune} "
+            f"-DFFT_BIN_LO={bin_lo} "
+            f"-DFFT_BIN_HI={bin_hi} "
+            f"-DFFT_INVERSE={inverse} "
+            f"-DFFT_PARTITION={partition} "
+            f"-DFFT_NATURAL_ORDER={natural_order} "
+            f"-DFFT_FOLD_BF={fold_bf} "
+            f"-DFFT_SHARED_BANKS={shared_banks} "
+            f"-DFFT_LANES={lanes} "
+            f"-DFFT_REAL_INPUT={real_input}"
         )
+        if fixed_w is not None:
+            cxx_flags += f" -DFFT_FIXED_W={fixed_w} -DFFT_FIXED_I={fixed_i} -DFFT_BFP={bfp}"
         if use_file_stim:
             cxx_flags += " -DUSE_CSV_INIT"
             
-        build_cmd = f"make build/{TARGET} EXTRA_CXXFLAGS=\"{cxx_flags}\""
+        build_cmd = f"make build/{target} EXTRA_CXXFLAGS=\"{cxx_flags}\""
         
         print("  Compiling testbench...")
         build_out, build_err, build_rc = run_command(build_cmd)
@@ -97,19 +153,19 @@ def main():
             print("  Overwriting previous test run")
         os.makedirs(sim_out_dir, exist_ok=True)
         
-        if use_file_stim and TARGET != "tb_system_wmem":
+        if use_file_stim and target != "tb_system_wmem":
             run_env["STIMULUS_FILE"] = os.path.join(sim_out_dir, "stimulus_core_%d.csv")
             for i in range(num_cores):
                 filename = run_env["STIMULUS_FILE"] % (i + 1)
                 if not os.path.isfile(filename):
-                    generate_stimulus_file(filename, samples, i)
+                    generate_stimulus_file(filename, samples, i, lanes=lanes, real=bool(real_input))
                     print(f"  Generated stimulus file: {filename}")
 
         # Execute simulation
         print("  Simulating...")
         start_time = time.time()
         # Direct execution of compiled binary
-        sim_out, sim_err, sim_rc = run_command(f"./build/{TARGET}", env=run_env)
+        sim_out, sim_err, sim_rc = run_command(f"./build/{target}", env=run_env)
         elapsed = time.time() - start_time
         
         # Save logs
@@ -119,11 +175,33 @@ def main():
             f.write("\n=== STDERR ===\n")
             f.write(sim_err)
             
+        # A partitioned run must take the cycles of the same case simulated in one kernel
+        cycles_match = True
+        if partition and "TESTBENCH PASS" in sim_out and sim_rc == 0:
+            print("  Simulating in one kernel...")
+            single_env = run_env.copy()
+            single_env["SIM_OUT_DIR"] = os.path.join(sim_out_dir, "single_kernel")
+            os.makedirs(single_env["SIM_OUT_DIR"], exist_ok=True)
+            single_out, single_err, single_rc = run_command(f"./build/{target} PARTITION=0", env=single_env)
+            cycles = perf_cycles(sim_out)
+            single_cycles = perf_cycles(single_out)
+            print(f"  Partitioned CYCLES={cycles}, single-kernel CYCLES={single_cycles}")
+            cycles_match = single_rc == 0 and cycles is not None and cycles == single_cycles
+
         # Analyze outcome
-        if "TESTBENCH PASS" in sim_out and sim_rc == 0:
+        if not cycles_match:
+            print("  [ FAILED ] Partitioned cycle count differs from the single-kernel run!")
+            results.append((name, "CYCLES_MISMATCH", elapsed))
+        elif "TESTBENCH PASS" in sim_out and sim_rc == 0:
             print(f"[ PASSED ] in {elapsed:.2f} seconds")
             results.append((name, "PASSED", elapsed))
             
+            # Convert the binary sample logs for plotting
+            conv_out, conv_err, conv_rc = run_command(
+                f"python3 sample_log_convert.py \"{os.path.join(sim_out_dir, 'data')}\"")
+            if conv_rc != 0:
+                print(f"  [ WARNING ] Sample log conversion failed: {conv_err.strip()}")
+
             # Run plot output script
             print("  Generating output plots...")
             plot_cmd = (
@@ -136,6 +214,8 @@ def main():
             )
             if "fs" in params:
                 plot_cmd += f" --fs {params['fs']}"
+            if natural_order:
+                plot_cmd += " --natural_order"
             plot_out, plot_err, plot_rc = run_command(plot_cmd)
             if plot_rc != 0:
                 print(f"  [ WARNING ] Plot generation failed: {plot_err.strip()}")
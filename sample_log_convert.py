@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+import argparse
+import glob
+import os
+import struct
+import sys
+
+MAGICS = (b"FFTBEAT1", b"FFTBEAT2")
+UNITS = [("s", 10**12), ("ms", 10**9), ("us", 10**6), ("ns", 10**3), ("ps", 1)]
+
+def format_time(ps):
+    """Same text as sc_time::to_string(): the largest unit that represents the time exactly."""
+    if ps == 0:
+        return "0 s"
+    for unit, scale in UNITS:
+        if ps % scale == 0:
+            return f"{ps // scale} {unit}"
+
+def signed(value, bits):
+    return value - (1 << bits) if value & (1 << (bits - 1)) else value
+
+def unpack(word, width, lanes):
+    """Real/imaginary parts of the samples of one AXI word, as unpack_beat() in src/fft_types.h."""
+    bits = width // (2 * lanes)
+    mask = (1 << bits) - 1
+    return [(signed((word >> (2 * l + 1) * bits) & mask, bits), signed((word >> 2 * l * bits) & mask, bits))
+            for l in range(lanes)]
+
+def convert(bin_path, csv_path):
+    """Writes the Timestamp,Real,Imaginary CSV of one binary beat log; returns the beat count."""
+    with open(bin_path, "rb") as f_in:
+        data = f_in.read()
+    if data[:8] not in MAGICS:
+        raise ValueError(f"{bin_path}: not a sample log")
+    if data[:8] == b"FFTBEAT1":
+        # Version 1: one sample per beat, the imaginary part only on 64-bit words
+        (width,) = struct.unpack_from("=I", data, 8)
+        lanes, start = 1, 12
+    else:
+        width, lanes = struct.unpack_from("=II", data, 8)
+        start = 16
+    records = (len(data) - start) // 16
+    with open(csv_path, "w") as f_out:
+        f_out.write("Timestamp,Real,Imaginary\n")
+        for time_ps, word in struct.iter_unpack("=QQ", data[start:start + 16 * records]):
+            if start == 12 and width != 64:
+                bits = min(width, 32)
+                samples = [(signed(word & ((1 << bits) - 1), bits), 0)]
+            else:
+                samples = unpack(word, width, lanes)
+            for real, imag in samples:
+                f_out.write(f"{format_time(time_ps)},{real},{imag}\n")
+    return records
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert binary sample logs (core*_input.bin / core*_output.bin) to CSV")
+    parser.add_argument("paths", nargs="*", default=["out/data"],
+                        help="Log files or directories holding them (default: out/data)")
+    args = parser.parse_args()
+
+    files = []
+    for path in args.paths:
+        if os.path.isdir(path):
+            files += sorted(glob.glob(os.path.join(path, "core*_*.bin")))
+        else:
+            files.append(path)
+    if not files:
+        print("Error: no sample logs found", file=sys.stderr)
+        return 1
+    for bin_path in files:
+        csv_path = os.path.splitext(bin_path)[0] + ".csv"
+        try:
+            count = convert(bin_path, csv_path)
+        except (OSError, ValueError) as e:
+            print(f"Error: {e}", file=sys.stderr)
+            return 1
+        print(f"Wrote {csv_path} ({count} beats)")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,339 @@
+/*
+ * banked_memory.h
+ *
+ * Shared multi-bank SRAM model behind an AXI4 crossbar.
+ * NUM_MASTERS read/write slave port pairs contend for NUM_BANKS single-port banks that are
+ * interleaved at beat granularity. Every bank serves one beat per cycle and arbitrates between
+ * the requesting bursts either round-robin or QoS-weighted round-robin, counting the conflict
+ * cycles of every bank so that access schedules (e.g. the Top HOP_SIZE stagger) can be compared.
+ */
+
+#ifndef BANKED_MEMORY_H
+#define BANKED_MEMORY_H
+
+#include <systemc.h>
+#include <axi/axi4.h>
+#include <connections/connections.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "memory.h"
+
+using namespace sc_core;
+using namespace axi;
+
+// Bank arbitration policies
+enum BankArbitration {
+    ARB_ROUND_ROBIN = 0, // One beat per grant, rotating over the masters
+    ARB_QOS = 1,         // Weighted round-robin: a master keeps a bank for qos_weight beats
+};
+
+// Arbiter of one bank between NUM_REQ requesters; requester r belongs to master
+// r % NUM_MASTERS, whose qos_weight gives the beats it may hold the bank for in ARB_QOS mode
+template<int NUM_MASTERS, int NUM_REQ, int ARBITRATION>
+struct BankArbiter {
+    int rr_next;     // First requester of the next round-robin search
+    int owner;       // Requester granted last, -1 after an idle cycle
+    int owner_beats; // Consecutive beats granted to it
+
+    BankArbiter() { reset(); }
+
+    void reset() {
+        rr_next = 0;
+        owner = -1;
+        owner_beats = 0;
+    }
+
+    // Pick the winner among the requesters, -1 if there are none
+    int arbitrate(const bool* requesting, const int* qos_weight) const {
+        if (ARBITRATION == ARB_QOS && owner >= 0 && requesting[owner] &&
+            owner_beats < qos_weight[owner % NUM_MASTERS]) {
+            return owner;
+        }
+        for (int i = 0; i < NUM_REQ; ++i) {
+            int r = (rr_next + i) % NUM_REQ;
+            if (requesting[r]) {
+                return r;
+            }
+        }
+        return -1;
+    }
+
+    // The winner took a beat
+    void grant(int winner) {
+        owner_beats = (owner == winner) ? owner_beats + 1 : 1;
+        owner = winner;
+        rr_next = (winner + 1) % NUM_REQ;
+    }
+
+    // Nobody requested the bank
+    void idle() {
+        owner = -1;
+    }
+};
+
+// Address-interleaved multi-bank SRAM with per-bank arbitration
+template<unsigned DEPTH, typename AxiCfg, int NUM_MASTERS, int NUM_BANKS = 4,
+         int ARBITRATION = ARB_ROUND_ROBIN>
+SC_MODULE(BankedMemory) {
+    static_assert(DEPTH % NUM_BANKS == 0, "DEPTH must be a multiple of NUM_BANKS");
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n; // Active-low reset
+
+    // Per-master AXI slave interfaces
+    sc_vector<typename axi4<AxiCfg>::read::template slave<>> read_ports;
+    sc_vector<typename axi4<AxiCfg>::write::template slave<>> write_ports;
+
+    typedef typename axi4<AxiCfg>::AddrPayload AddrPayload;
+    typedef typename axi4<AxiCfg>::ReadPayload ReadPayload;
+    typedef typename axi4<AxiCfg>::WritePayload WritePayload;
+    typedef typename axi4<AxiCfg>::WRespPayload WRespPayload;
+
+    static const int bytesPerBeat = AxiCfg::dataWidth / 8;
+    static const int addrShift = MemWord<AxiCfg>::addrShift;
+    static const int BANK_DEPTH = DEPTH / NUM_BANKS;
+
+    typedef typename MemWord<AxiCfg>::type word_t;
+
+    word_t mem[NUM_BANKS][BANK_DEPTH];
+
+    // QoS weight of every master (beats per grant in ARB_QOS mode)
+    int qos_weight[NUM_MASTERS];
+
+    // Per-bank statistics
+    unsigned long bank_accesses[NUM_BANKS];
+    unsigned long bank_conflict_cycles[NUM_BANKS]; // Cycles with more requests than grants
+    unsigned long bank_stalled_requests[NUM_BANKS]; // Requests that lost arbitration
+    unsigned long contended_grants[NUM_MASTERS];    // Beats a master won against other requests
+
+    // Active burst of one master on one channel
+    struct Burst {
+        bool active;
+        AddrPayload req;
+        unsigned int addr;
+        int beat;
+    };
+
+    Burst rd[NUM_MASTERS];
+    Burst wr[NUM_MASTERS];
+    bool b_pending[NUM_MASTERS];
+    WRespPayload b_resp[NUM_MASTERS];
+
+    // Arbitration state per bank; requesters 0..NUM_MASTERS-1 read, NUM_MASTERS.. write
+    BankArbiter<NUM_MASTERS, 2 * NUM_MASTERS, ARBITRATION> arbiter[NUM_BANKS];
+
+    static int bank_of(unsigned int addr) {
+        return (addr >> addrShift) % NUM_BANKS;
+    }
+
+    static int row_of(unsigned int addr) {
+        return ((addr >> addrShift) / NUM_BANKS) % BANK_DEPTH;
+    }
+
+    // Backdoor access for preloading and checking
+    void write_word(unsigned int addr, word_t data) {
+        mem[bank_of(addr)][row_of(addr)] = data;
+    }
+
+    word_t read_word(unsigned int addr) const {
+        return mem[bank_of(addr)][row_of(addr)];
+    }
+
+    bool in_range(unsigned int addr) const {
+        return (addr >> addrShift) < DEPTH;
+    }
+
+    void crossbar_thread() {
+        for (int m = 0; m < NUM_MASTERS; ++m) {
+            read_ports[m].reset();
+            write_ports[m].reset();
+        }
+        reset_state();
+        wait();
+
+        while (true) {
+            for (int m = 0; m < NUM_MASTERS; ++m) {
+                // Address acceptance, one active burst per master and channel
+                if (!rd[m].active) {
+                    AddrPayload req;
+                    if (read_ports[m].ar.PopNB(req)) {
+                        rd[m].active = true;
+                        rd[m].req = req;
+                        rd[m].addr = req.addr;
+                        rd[m].beat = 0;
+                    }
+                }
+                if (!wr[m].active && !b_pending[m]) {
+                    AddrPayload req;
+                    if (write_ports[m].aw.PopNB(req)) {
+                        wr[m].active = true;
+                        wr[m].req = req;
+                        wr[m].addr = req.addr;
+                        wr[m].beat = 0;
+                    }
+                }
+
+                // Write responses
+                if (b_pending[m] && write_ports[m].b.PushNB(b_resp[m])) {
+                    b_pending[m] = false;
+                }
+            }
+
+            // Collect bank requests; a write only requests once its data beat is present
+            bool requesting[NUM_BANKS][2 * NUM_MASTERS];
+            int num_requests[NUM_BANKS];
+            for (int b = 0; b < NUM_BANKS; ++b) {
+                num_requests[b] = 0;
+                for (int r = 0; r < 2 * NUM_MASTERS; ++r) {
+                    requesting[b][r] = false;
+                }
+            }
+            for (int m = 0; m < NUM_MASTERS; ++m) {
+                if (rd[m].active) {
+                    int b = bank_of(rd[m].addr);
+                    requesting[b][m] = true;
+                    num_requests[b]++;
+                }
+                WritePayload peek;
+                if (wr[m].active && write_ports[m].w.PeekNB(peek)) {
+                    int b = bank_of(wr[m].addr);
+                    requesting[b][NUM_MASTERS + m] = true;
+                    num_requests[b]++;
+                }
+            }
+
+            // One beat per bank
+            for (int b = 0; b < NUM_BANKS; ++b) {
+                if (num_requests[b] == 0) {
+                    arbiter[b].idle();
+                    continue;
+                }
+                if (num_requests[b] > 1) {
+                    bank_conflict_cycles[b]++;
+                    bank_stalled_requests[b] += num_requests[b] - 1;
+                }
+
+                int winner = arbiter[b].arbitrate(requesting[b], qos_weight);
+                bool served = (winner < NUM_MASTERS) ? serve_read(winner) : serve_write(winner - NUM_MASTERS);
+                if (served) {
+                    bank_accesses[b]++;
+                    arbiter[b].grant(winner);
+                    if (num_requests[b] > 1) {
+                        contended_grants[winner % NUM_MASTERS]++;
+                    }
+                }
+            }
+
+            wait();
+        }
+    }
+
+    // Return one read beat of master m
+    bool serve_read(int m) {
+        Burst& burst = rd[m];
+        ReadPayload resp;
+        resp.data = in_range(burst.addr) ? (typename axi4<AxiCfg>::Data)read_word(burst.addr) : (typename axi4<AxiCfg>::Data)0;
+        resp.id = burst.req.id;
+        resp.resp = 0; // OKAY response
+        resp.last = (burst.beat == burst.req.len);
+        if (!read_ports[m].r.PushNB(resp)) {
+            return false;
+        }
+        if (burst.beat++ == burst.req.len) {
+            burst.active = false;
+        }
+        burst.addr += bytesPerBeat;
+        return true;
+    }
+
+    // Store one write beat of master m
+    bool serve_write(int m) {
+        Burst& burst = wr[m];
+        WritePayload data;
+        if (!write_ports[m].w.PopNB(data)) {
+            return false;
+        }
+        if (in_range(burst.addr)) {
+            if (AxiCfg::useWriteStrobes) {
+                word_t original = read_word(burst.addr);
+                word_t mask = 0;
+                for (int i = 0; i < bytesPerBeat; ++i) {
+                    if (data.wstrb[i]) {
+                        mask.range(8 * i + 7, 8 * i) = 0xFF;
+                    }
+                }
+                write_word(burst.addr, (original & ~mask) | ((typename axi4<AxiCfg>::Data)data.data & mask));
+            } else {
+                write_word(burst.addr, (typename axi4<AxiCfg>::Data)data.data);
+            }
+        }
+        if (burst.beat++ == burst.req.len) {
+            burst.active = false;
+            b_resp[m].id = burst.req.id;
+            b_resp[m].resp = 0; // OKAY response
+            b_pending[m] = true;
+        }
+        burst.addr += bytesPerBeat;
+        return true;
+    }
+
+    void reset_state() {
+        for (int m = 0; m < NUM_MASTERS; ++m) {
+            rd[m].active = false;
+            wr[m].active = false;
+            b_pending[m] = false;
+        }
+        for (int b = 0; b < NUM_BANKS; ++b) {
+            arbiter[b].reset();
+        }
+    }
+
+    // Print per-bank access and conflict statistics
+    void report(std::ostream& os = std::cout) const {
+        unsigned long total_conflicts = 0;
+        for (int b = 0; b < NUM_BANKS; ++b) {
+            os << "BANK_RESULT: BANK=" << b
+               << " ACCESSES=" << bank_accesses[b]
+               << " CONFLICT_CYCLES=" << bank_conflict_cycles[b]
+               << " STALLED_REQUESTS=" << bank_stalled_requests[b]
+               << std::endl;
+            total_conflicts += bank_conflict_cycles[b];
+        }
+        for (int m = 0; m < NUM_MASTERS; ++m) {
+            os << "BANK_RESULT: MASTER=" << m
+               << " CONTENDED_GRANTS=" << contended_grants[m]
+               << std::endl;
+        }
+        os << "BANK_RESULT: TOTAL_CONFLICT_CYCLES=" << total_conflicts << std::endl;
+    }
+
+    SC_HAS_PROCESS(BankedMemory);
+    BankedMemory(sc_module_name name)
+        : sc_module(name),
+          clk("clk"),
+          rst_n("rst_n"),
+          read_ports("read_ports", NUM_MASTERS),
+          write_ports("write_ports", NUM_MASTERS)
+    {
+        for (int b = 0; b < NUM_BANKS; ++b) {
+            for (int k = 0; k < BANK_DEPTH; ++k) {
+                mem[b][k] = 0;
+            }
+            bank_accesses[b] = 0;
+            bank_conflict_cycles[b] = 0;
+            bank_stalled_requests[b] = 0;
+        }
+        for (int m = 0; m < NUM_MASTERS; ++m) {
+            qos_weight[m] = 1;
+            contended_grants[m] = 0;
+        }
+        reset_state();
+
+        SC_THREAD(crossbar_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // BANKED_MEMORY_H
@@ -0,0 +1,137 @@
+/*
+ * butterfly_scheduler.h
+ *
+ * Resource-constrained schedule of the butterfly datapath of a pipeline stage.
+ * The real-valued operations of one butterfly are placed as early as their operands
+ * allow on NUM_MULT multipliers and NUM_ADD adders (list scheduling against a modulo
+ * reservation table), so a shared, time-multiplexed ALU starts a new butterfly every
+ * interval() cycles and delivers its results latency() cycles after the operands.
+ * With the full datapath (4 multipliers, 6 adders; 4 adders for the trivial radix-2^2
+ * butterfly, 8 multipliers and 8 adders for the radix-2^2 butterfly that twiddles both
+ * outputs) it is a single chained cycle, as before.
+ */
+
+#ifndef BUTTERFLY_SCHEDULER_H
+#define BUTTERFLY_SCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+
+class ButterflyScheduler {
+public:
+    // Butterfly operation lists: radix-2 (difference twiddled), BF2I of a radix-2^2 pair
+    // (the -j rotation needs no multiplier), BF2II with both outputs twiddled
+    enum Kind { RADIX2, BF2I, BF2II };
+
+    ButterflyScheduler(int n_mult = 4, int n_add = 6, Kind kind = RADIX2)
+        : ii(1), lat(1), next_issue(0)
+    {
+        if (n_mult < 1) n_mult = 1;
+        if (n_add < 1) n_add = 1;
+        std::vector<Op> ops = butterfly_ops(kind);
+        int count[2] = {0, 0};
+        for (const Op& op : ops) {
+            count[op.unit]++;
+        }
+        if (n_add >= count[ADD] && n_mult >= count[MULT]) {
+            return; // Single-cycle butterfly
+        }
+        schedule(ops, count, n_mult, n_add);
+    }
+
+    // Cycles between the starts of successive butterflies
+    int interval() const { return ii; }
+
+    // Cycles from the operands of a butterfly to its results
+    int latency() const { return lat; }
+
+    // Results in flight in the ALU plus the output register
+    int depth() const { return (lat + ii - 1) / ii + 1; }
+
+    // Whether stages need the decoupled issue/retire path (multi-cycle ALU)
+    bool pipelined() const { return lat > 1; }
+
+    void reset() { next_issue = 0; }
+
+    bool can_issue(unsigned long cycle) const { return cycle >= next_issue; }
+
+    // Continue on this schedule where prev, run on the same ALU, left off
+    void take_over(const ButterflyScheduler& prev) {
+        if (prev.next_issue > next_issue) next_issue = prev.next_issue;
+    }
+
+    // Start a butterfly in cycle; returns the cycle its results leave the ALU
+    unsigned long issue(unsigned long cycle) {
+        next_issue = cycle + ii;
+        return cycle + lat;
+    }
+
+private:
+    enum { ADD = 0, MULT = 1 };
+
+    struct Op {
+        int unit;
+        int dep0, dep1; // Operand producers (-1: stage input)
+    };
+
+    int ii;
+    int lat;
+    unsigned long next_issue;
+
+    // Operations in priority order, critical path (difference, twiddle product) first:
+    // d = a - b, p = d * w, s = a + b (BF2II: q = s * w' as well)
+    static std::vector<Op> butterfly_ops(Kind kind) {
+        std::vector<Op> ops;
+        ops.push_back({ADD, -1, -1});  // 0: d.re
+        ops.push_back({ADD, -1, -1});  // 1: d.im
+        if (kind != BF2I) {
+            ops.push_back({MULT, 0, -1}); // 2: d.re * w.re
+            ops.push_back({MULT, 1, -1}); // 3: d.im * w.im
+            ops.push_back({MULT, 0, -1}); // 4: d.re * w.im
+            ops.push_back({MULT, 1, -1}); // 5: d.im * w.re
+            ops.push_back({ADD, 2, 3});   // 6: p.re
+            ops.push_back({ADD, 4, 5});   // 7: p.im
+        }
+        int s = (int)ops.size();
+        ops.push_back({ADD, -1, -1});  // s.re
+        ops.push_back({ADD, -1, -1});  // s.im
+        if (kind == BF2II) {
+            ops.push_back({MULT, s, -1});       // s.re * w'.re
+            ops.push_back({MULT, s + 1, -1});   // s.im * w'.im
+            ops.push_back({MULT, s, -1});       // s.re * w'.im
+            ops.push_back({MULT, s + 1, -1});   // s.im * w'.re
+            ops.push_back({ADD, s + 2, s + 3}); // q.re
+            ops.push_back({ADD, s + 4, s + 5}); // q.im
+        }
+        return ops;
+    }
+
+    // Smallest interval at which every operation fits the reservation table
+    void schedule(const std::vector<Op>& ops, const int count[2], int n_mult, int n_add) {
+        int cap[2] = {n_add, n_mult};
+        ii = 1;
+        for (int u = 0; u < 2; ++u) {
+            int min_ii = (count[u] + cap[u] - 1) / cap[u];
+            if (min_ii > ii) ii = min_ii;
+        }
+
+        std::vector<int> used[2] = {std::vector<int>(ii, 0), std::vector<int>(ii, 0)};
+        std::vector<int> done(ops.size(), 0); // Cycle after each operation
+        lat = 1;
+        for (size_t i = 0; i < ops.size(); ++i) {
+            const Op& op = ops[i];
+            int t = 0;
+            if (op.dep0 >= 0 && done[op.dep0] > t) t = done[op.dep0];
+            if (op.dep1 >= 0 && done[op.dep1] > t) t = done[op.dep1];
+            // Within ii cycles a slot is free, as the interval covers every unit's load
+            while (used[op.unit][t % ii] >= cap[op.unit]) {
+                t++;
+            }
+            used[op.unit][t % ii]++;
+            done[i] = t + 1;
+            if (done[i] > lat) lat = done[i];
+        }
+    }
+};
+
+#endif // BUTTERFLY_SCHEDULER_H
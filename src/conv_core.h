@@ -0,0 +1,249 @@
+/*
+ * conv_core.h
+ *
+ * Fast-convolution variant of the processing core: FIR filtering by overlap-save with the
+ * spectrum kept on chip. One DMA controller feeds the fused chain
+ *     forward FFT -> reorder -> filter multiply -> inverse FFT -> reorder
+ * of radix-2 stage cascades, the inverse cascade running on conjugated twiddles with its
+ * 1/N scaling. Every job is an overlap-save convolution of num_samples samples with the
+ * conv_taps-tap filter (1 to N_SIZE taps) whose N_SIZE-bin spectrum, the FFT of the filter
+ * zero-padded to N_SIZE, sits in natural order at filter_addr: the DMA loads the spectrum
+ * into the filter multiply when a job names another one than the one held, frames the
+ * samples with the filter's overlap and writes y[n] = sum_m h[m] x[n - m] (scaled as the
+ * forward cascade by SCALE_MASK) back in place of the input, N_SIZE samples further on, as
+ * Core does. Only samples cross AXI.
+ */
+
+#ifndef CONV_CORE_H
+#define CONV_CORE_H
+
+#include <systemc.h>
+#include <axi/axi4.h>
+#include <connections/connections.h>
+#include "dma.h"
+#include "fft.h"
+#include "reorder.h"
+#include "spectrum_multiply.h"
+
+using namespace sc_core;
+using namespace axi;
+using namespace Connections;
+
+// Overlap-save fast-convolution core
+template<int N_SIZE, typename AxiCfg, int NUM_MULT=4, int NUM_ADD=6, typename T=complex_t,
+         unsigned SCALE_MASK=0, typename DmaCfg=dma_cfg::standard>
+SC_MODULE(ConvCore) {
+    static_assert(N_SIZE >= 2 && beat_lanes<T>::value == 1 && !bfp_traits<T>::enabled,
+                  "The fast-convolution chain runs one sample per beat at a fixed frame scale");
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n; // Active-low reset
+
+    // Control interface
+    sc_in<bool> start;
+    sc_in<bool> stream_mode;
+    sc_in<sc_uint<AxiCfg::addrWidth>> base_addr;
+    sc_in<int> num_samples;
+    sc_in<int> conv_taps; // Filter taps of the next job
+    sc_in<sc_uint<AxiCfg::addrWidth>> filter_addr; // Filter spectrum of the next job
+    sc_in<bool> prune_zeros; // Skip butterflies on zero operands in both cascades
+    sc_out<bool> busy;
+    sc_out<int> rd_outstanding; // Bus occupancy of the DMA
+    sc_out<int> wr_outstanding;
+
+    // AXI memory interface
+    typename axi4<AxiCfg>::read::template master <> mem_read_port;
+    typename axi4<AxiCfg>::write::template master <> mem_write_port;
+
+    // Internal channels of the chain
+    Combinational<T> dma_to_route_chan;
+    Combinational<T> route_to_fft_chan;
+    Combinational<T> route_to_filter_chan;
+    Combinational<T> fft_to_reorder_chan;
+    Combinational<T> reorder_to_multiply_chan;
+    Combinational<T> multiply_to_ifft_chan;
+    Combinational<T> ifft_to_reorder_chan;
+    Combinational<T> reorder_to_dma_chan;
+    sc_signal<bool> filter_load;
+
+    // DMA controls without a use here: tied off
+    sc_signal<bool> desc_mode;
+    sc_signal<int> fft_len;
+    sc_signal<int> active_len;
+    sc_signal<int> window;
+    sc_signal<int> active_window;
+    sc_signal<int> stft_hop;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> stft_dst;
+    sc_signal<int> stft_pitch;
+    sc_signal<int> bin_lo;
+    sc_signal<int> bin_hi;
+    sc_signal<int> active_bin_lo;
+    sc_signal<int> active_bin_hi;
+    sc_signal<bool> job_inverse;
+    sc_signal<bool> active_inverse;
+    sc_signal<bool> inverse_on; // Tied to 1: direction of the inverse cascade
+
+    DMA<AxiCfg, N_SIZE, NUM_MULT, NUM_ADD, 2, T, DmaCfg> dma;
+    FilterRoute<T> route;
+    FFT<N_SIZE, NUM_MULT, NUM_ADD, 2, T, SCALE_MASK> fft;
+    Reorder<N_SIZE, T> fft_reorder;
+    SpectrumMultiply<N_SIZE, NUM_MULT, NUM_ADD, T> multiply;
+    FFT<N_SIZE, NUM_MULT, NUM_ADD, 2, T> ifft;
+    Reorder<N_SIZE, T> ifft_reorder;
+
+    SC_CTOR(ConvCore)
+        : clk("clk"),
+          rst_n("rst_n"),
+          start("start"),
+          stream_mode("stream_mode"),
+          base_addr("base_addr"),
+          num_samples("num_samples"),
+          conv_taps("conv_taps"),
+          filter_addr("filter_addr"),
+          prune_zeros("prune_zeros"),
+          busy("busy"),
+          rd_outstanding("rd_outstanding"),
+          wr_outstanding("wr_outstanding"),
+          mem_read_port("mem_read_port"),
+          mem_write_port("mem_write_port"),
+          dma_to_route_chan("dma_to_route_chan"),
+          route_to_fft_chan("route_to_fft_chan"),
+          route_to_filter_chan("route_to_filter_chan"),
+          fft_to_reorder_chan("fft_to_reorder_chan"),
+          reorder_to_multiply_chan("reorder_to_multiply_chan"),
+          multiply_to_ifft_chan("multiply_to_ifft_chan"),
+          ifft_to_reorder_chan("ifft_to_reorder_chan"),
+          reorder_to_dma_chan("reorder_to_dma_chan"),
+          filter_load("filter_load"),
+          desc_mode("desc_mode"),
+          fft_len("fft_len"),
+          active_len("active_len"),
+          window("window"),
+          active_window("active_window"),
+          stft_hop("stft_hop"),
+          stft_dst("stft_dst"),
+          stft_pitch("stft_pitch"),
+          bin_lo("bin_lo"),
+          bin_hi("bin_hi"),
+          active_bin_lo("active_bin_lo"),
+          active_bin_hi("active_bin_hi"),
+          job_inverse("job_inverse"),
+          active_inverse("active_inverse"),
+          inverse_on("inverse_on", true),
+          dma("dma"),
+          route("route"),
+          fft("fft"),
+          fft_reorder("fft_reorder"),
+          multiply("multiply"),
+          ifft("ifft"),
+          ifft_reorder("ifft_reorder")
+    {
+        // DMA bindings
+        dma.clk(clk);
+        dma.rst_n(rst_n);
+        dma.start(start);
+        dma.stream_mode(stream_mode);
+        dma.desc_mode(desc_mode);
+        dma.base_addr(base_addr);
+        dma.num_samples(num_samples);
+        dma.fft_len(fft_len);
+        dma.active_len(active_len);
+        dma.window(window);
+        dma.active_window(active_window);
+        dma.stft_hop(stft_hop);
+        dma.stft_dst(stft_dst);
+        dma.stft_pitch(stft_pitch);
+        dma.bin_lo(bin_lo);
+        dma.bin_hi(bin_hi);
+        dma.active_bin_lo(active_bin_lo);
+        dma.active_bin_hi(active_bin_hi);
+        dma.inverse(job_inverse);
+        dma.active_inverse(active_inverse);
+        dma.conv_taps(conv_taps);
+        dma.filter_addr(filter_addr);
+        dma.filter_load(filter_load);
+        dma.busy(busy);
+        dma.rd_outstanding(rd_outstanding);
+        dma.wr_outstanding(wr_outstanding);
+        dma.mem_read_port(mem_read_port);
+        dma.mem_write_port(mem_write_port);
+        dma.fft_out(dma_to_route_chan);
+        dma.fft_in(reorder_to_dma_chan);
+
+        // Route bindings: filter spectra to the multiply, frames to the forward FFT
+        route.clk(clk);
+        route.rst_n(rst_n);
+        route.filter_load(filter_load);
+        route.in_data(dma_to_route_chan);
+        route.out_data(route_to_fft_chan);
+        route.filter_out(route_to_filter_chan);
+
+        // Forward FFT and natural-order bins
+        fft.clk(clk);
+        fft.rst_n(rst_n);
+        fft.in_data(route_to_fft_chan);
+        fft.out_data(fft_to_reorder_chan);
+        fft.prune_zeros(prune_zeros);
+        fft_reorder.clk(clk);
+        fft_reorder.rst_n(rst_n);
+        fft_reorder.in_data(fft_to_reorder_chan);
+        fft_reorder.out_data(reorder_to_multiply_chan);
+
+        // Filter multiply
+        multiply.clk(clk);
+        multiply.rst_n(rst_n);
+        multiply.in_data(reorder_to_multiply_chan);
+        multiply.coeff_in(route_to_filter_chan);
+        multiply.out_data(multiply_to_ifft_chan);
+
+        // Inverse FFT and natural-order samples
+        ifft.clk(clk);
+        ifft.rst_n(rst_n);
+        ifft.in_data(multiply_to_ifft_chan);
+        ifft.out_data(ifft_to_reorder_chan);
+        ifft.prune_zeros(prune_zeros);
+        ifft.inverse(inverse_on);
+        ifft_reorder.clk(clk);
+        ifft_reorder.rst_n(rst_n);
+        ifft_reorder.in_data(ifft_to_reorder_chan);
+        ifft_reorder.out_data(reorder_to_dma_chan);
+    }
+
+    // Block of the chain with the highest utilization
+    NamedCounters bottleneck() const {
+        NamedCounters b = fft.busiest_stage();
+        NamedCounters inv = ifft.busiest_stage();
+        if (inv.perf->utilization() > b.perf->utilization()) {
+            b = inv;
+        }
+        const sc_module* blocks[] = { &route, &fft_reorder, &multiply, &ifft_reorder };
+        const StreamCounters* counters[] = { &route.perf, &fft_reorder.perf, &multiply.perf, &ifft_reorder.perf };
+        for (int i = 0; i < 4; ++i) {
+            if (counters[i]->utilization() > b.perf->utilization()) {
+                b.name = blocks[i]->basename();
+                b.perf = counters[i];
+            }
+        }
+        return b;
+    }
+
+    // Counters of the DMA and of every block of the chain
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        NamedCounters b = bottleneck();
+        w.StartObject();
+        w.Key("name"); w.String(basename());
+        w.Key("utilization"); w.Double(dma.perf.utilization());
+        w.Key("bottleneck"); w.String(b.name);
+        w.Key("dma"); dma.perf.write_json(w);
+        w.Key("route"); route.perf.write_json(w, route.basename());
+        w.Key("stages"); fft.write_perf_json(w);
+        w.Key("reorder"); fft_reorder.perf.write_json(w, fft_reorder.basename());
+        w.Key("multiply"); multiply.perf.write_json(w, multiply.basename());
+        w.Key("inverse_stages"); ifft.write_perf_json(w);
+        w.Key("inverse_reorder"); ifft_reorder.perf.write_json(w, ifft_reorder.basename());
+        w.EndObject();
+    }
+};
+
+#endif // CONV_CORE_H
@@ -1,9 +1,22 @@
 /*
  * core.h
  *
- * Unified processing core wrapping one DMA controller and one FFT compute pipeline.
+ * Unified processing core wrapping one DMA controller and one FFT compute pipeline
+ * (the stage cascade, the folded FFT with FOLD_BF shared butterfly units, or for a
+ * sample_vec_t<S, P> type T the P-parallel multi-path FFT).
  * Connects external AXI memory ports and manages internal handshake signals between
- * the DMA and FFT computation pipeline.
+ * the DMA and FFT computation pipeline, optionally through a natural-order reorder buffer.
+ * With REAL_INPUT, N-sample real frames run as N/2-point complex transforms followed by the
+ * conjugate-symmetry split stage. A complex_bfp_t datapath type selects block floating
+ * point: the stages scale frame by frame and the DMA stores the exponent of every frame.
+ * On the radix-2 stage cascade, fft_len selects any shorter power-of-two length per job: the
+ * DMA bypasses the leading stages and sizes frames, flushes and the output offset to it.
+ * Every frame passes the window stage in front of the FFT, with the window of its job. A
+ * non-zero stft_hop makes a job a short-time Fourier transform of overlapping frames, each
+ * sample read from memory once (see DMA). bin_lo/bin_hi select the output bins a job writes
+ * back; on the radix-2 stage cascade the stages also prune the butterflies of the other
+ * bins, and with prune_zeros those on zero operands. On the radix-2 stage cascade (not with
+ * block floating point), inverse makes a job the inverse transform, scaled by 1/len.
  */
 
 #ifndef CORE_H
@@ -14,65 +27,265 @@
 #include <connections/connections.h>
 #include "dma.h"
 #include "fft.h"
+#include "folded_fft.h"
+#include "parallel_fft.h"
+#include "reorder.h"
+#include "real_split.h"
+#include "window.h"
+#include <type_traits>
 
 using namespace sc_core;
 using namespace axi;
 using namespace Connections;
 
 // Integrated processing core
-template<int N_SIZE, typename AxiCfg, int NUM_MULT=4, int NUM_ADD=6>
+template<int N_SIZE, typename AxiCfg, int NUM_MULT=4, int NUM_ADD=6, int RADIX=2,
+         typename T=complex_t, unsigned SCALE_MASK=0, typename DmaCfg=dma_cfg::standard,
+         bool NATURAL_ORDER=false, int FOLD_BF=0, bool REAL_INPUT=false>
 SC_MODULE(Core) {
     sc_in<bool> clk;
     sc_in<bool> rst_n; // Active-low reset
     
     // Control interface
     sc_in<bool> start;
+    sc_in<bool> stream_mode;
+    sc_in<bool> desc_mode;
     sc_in<sc_uint<AxiCfg::addrWidth>> base_addr;
     sc_in<int> num_samples;
+    sc_in<int> fft_len; // FFT length of the next job (0: N_SIZE)
+    sc_in<int> window;  // WindowRom kind of the next job
+    sc_in<int> stft_hop; // STFT of the next job: samples between frames (0: off)
+    sc_in<sc_uint<AxiCfg::addrWidth>> stft_dst; // STFT output frames
+    sc_in<int> stft_pitch; // Bytes between STFT output frames (0: one frame)
+    sc_in<bool> prune_zeros; // Skip butterflies on zero operands (radix-2 stage cascade)
+    sc_in<int> bin_lo;     // Output bins [bin_lo, bin_hi) of the next job (bin_hi <= 0: all)
+    sc_in<int> bin_hi;
+    sc_in<bool> inverse;   // Inverse transform of the next job (radix-2 stage cascade)
     sc_out<bool> busy;
+    sc_out<int> rd_outstanding; // Bus occupancy of the DMA
+    sc_out<int> wr_outstanding;
     
     // AXI memory interface
     typename axi4<AxiCfg>::read::template master <> mem_read_port;
     typename axi4<AxiCfg>::write::template master <> mem_write_port;
     
     // Internal DMA <-> FFT channels
-    Combinational<complex_t> dma_to_fft_chan;
-    Combinational<complex_t> fft_to_dma_chan;
+    Combinational<T> dma_to_fft_chan;
+    Combinational<T> window_to_fft_chan;
+    Combinational<T> fft_to_dma_chan;
+    Combinational<T> fft_to_reorder_chan;
+    Combinational<T> fft_to_split_chan;
+    sc_signal<int> stage_len; // FFT length the DMA has set the stages to
+    sc_signal<int> stage_window; // Window of the frames the DMA sends
+    sc_signal<int> stage_bin_lo; // Bin range the stages prune to
+    sc_signal<int> stage_bin_hi;
+    sc_signal<bool> stage_inverse; // Direction the stages run in
+    sc_signal<int> conv_taps;      // Tied to 0: no convolution jobs (see ConvCore)
+    sc_signal<sc_uint<AxiCfg::addrWidth>> filter_addr;
+    sc_signal<bool> filter_load;
     
-    DMA<AxiCfg, N_SIZE, NUM_MULT, NUM_ADD> dma;
-    FFT<N_SIZE, NUM_MULT, NUM_ADD> fft;
+    // FOLD_BF > 0: folded FFT on FOLD_BF shared butterfly units instead of the cascade;
+    // T = sample_vec_t<S, P>: P samples per beat through the P-parallel FFT
+    static const int LANES = beat_lanes<T>::value;
+    static_assert(LANES == 1 || (!NATURAL_ORDER && FOLD_BF == 0),
+                  "The P-parallel FFT has no natural-order or folded variant");
+    static_assert(!REAL_INPUT || (LANES == 1 && !NATURAL_ORDER && N_SIZE >= 2),
+                  "Real-input bins are in natural order, one sample per lane");
+
+    // Points of the complex transform (REAL_INPUT: two real samples per point)
+    static const int FFT_SIZE = REAL_INPUT ? N_SIZE / 2 : N_SIZE;
+
+    typedef typename beat_lanes<T>::sample_type S;
+
+    static_assert(!bfp_traits<S>::enabled || (LANES == 1 && RADIX == 2 && FOLD_BF == 0 && !REAL_INPUT),
+                  "Block floating point runs on the radix-2 stage cascade");
+
+    typedef typename std::conditional<(LANES > 1),
+        ParallelFFT<N_SIZE, LANES, NUM_MULT, NUM_ADD, S, SCALE_MASK>,
+        typename std::conditional<(FOLD_BF > 0 && FFT_SIZE > 1),
+            FoldedFFT<FFT_SIZE, FOLD_BF, NUM_MULT, NUM_ADD, T, SCALE_MASK>,
+            FFT<FFT_SIZE, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK>>::type>::type FftType;
+
+    DMA<AxiCfg, N_SIZE, NUM_MULT, NUM_ADD, RADIX, T, DmaCfg, NATURAL_ORDER, FOLD_BF, REAL_INPUT> dma;
+    Window<N_SIZE, T, REAL_INPUT> window_stage;
+    FftType fft;
+    Reorder<N_SIZE, T>* reorder; // Natural-order output stage (NATURAL_ORDER only)
+    // Real-input bins (REAL_INPUT only; any valid size names the type otherwise)
+    typedef RealSplit<(REAL_INPUT ? N_SIZE : 2), NUM_MULT, NUM_ADD, T> SplitType;
+    SplitType* split;
     
     SC_CTOR(Core)
         : clk("clk"),
           rst_n("rst_n"),
           start("start"),
+          stream_mode("stream_mode"),
+          desc_mode("desc_mode"),
           base_addr("base_addr"),
           num_samples("num_samples"),
+          fft_len("fft_len"),
+          window("window"),
+          stft_hop("stft_hop"),
+          stft_dst("stft_dst"),
+          stft_pitch("stft_pitch"),
+          prune_zeros("prune_zeros"),
+          bin_lo("bin_lo"),
+          bin_hi("bin_hi"),
+          inverse("inverse"),
           busy("busy"),
+          rd_outstanding("rd_outstanding"),
+          wr_outstanding("wr_outstanding"),
           mem_read_port("mem_read_port"),
           mem_write_port("mem_write_port"),
           dma_to_fft_chan("dma_to_fft_chan"),
+          window_to_fft_chan("window_to_fft_chan"),
           fft_to_dma_chan("fft_to_dma_chan"),
+          fft_to_reorder_chan("fft_to_reorder_chan"),
+          fft_to_split_chan("fft_to_split_chan"),
+          stage_len("stage_len"),
+          stage_window("stage_window"),
+          stage_bin_lo("stage_bin_lo"),
+          stage_bin_hi("stage_bin_hi"),
+          stage_inverse("stage_inverse"),
+          conv_taps("conv_taps"),
+          filter_addr("filter_addr"),
+          filter_load("filter_load"),
           dma("dma"),
-          fft("fft")
+          window_stage("window_stage"),
+          fft("fft"),
+          reorder(nullptr),
+          split(nullptr)
     {
         // DMA bindings
         dma.clk(clk);
         dma.rst_n(rst_n);
         dma.start(start);
+        dma.stream_mode(stream_mode);
+        dma.desc_mode(desc_mode);
         dma.base_addr(base_addr);
         dma.num_samples(num_samples);
+        dma.fft_len(fft_len);
+        dma.active_len(stage_len);
+        dma.window(window);
+        dma.active_window(stage_window);
+        dma.stft_hop(stft_hop);
+        dma.stft_dst(stft_dst);
+        dma.stft_pitch(stft_pitch);
+        dma.bin_lo(bin_lo);
+        dma.bin_hi(bin_hi);
+        dma.active_bin_lo(stage_bin_lo);
+        dma.active_bin_hi(stage_bin_hi);
+        dma.inverse(inverse);
+        dma.active_inverse(stage_inverse);
+        dma.conv_taps(conv_taps);
+        dma.filter_addr(filter_addr);
+        dma.filter_load(filter_load);
         dma.busy(busy);
+        dma.rd_outstanding(rd_outstanding);
+        dma.wr_outstanding(wr_outstanding);
         dma.mem_read_port(mem_read_port);
         dma.mem_write_port(mem_write_port);
         dma.fft_out(dma_to_fft_chan);
         dma.fft_in(fft_to_dma_chan);
         
+        // Window bindings: DMA frames -> windowed FFT input
+        window_stage.clk(clk);
+        window_stage.rst_n(rst_n);
+        window_stage.window_sel(stage_window);
+        window_stage.frame_len(stage_len);
+        window_stage.in_data(dma_to_fft_chan);
+        window_stage.out_data(window_to_fft_chan);
+
         // FFT bindings
         fft.clk(clk);
         fft.rst_n(rst_n);
-        fft.in_data(dma_to_fft_chan);
-        fft.out_data(fft_to_dma_chan);
+        fft.in_data(window_to_fft_chan);
+        if constexpr (decltype(dma)::VARIABLE_LEN) {
+            fft.fft_len(stage_len);
+        }
+        if constexpr (decltype(dma)::PRUNE_ZEROS) {
+            fft.prune_zeros(prune_zeros);
+        }
+        if constexpr (decltype(dma)::PRUNE_BINS) {
+            fft.bin_lo(stage_bin_lo);
+            fft.bin_hi(stage_bin_hi);
+        }
+        if constexpr (decltype(dma)::INVERSE) {
+            fft.inverse(stage_inverse);
+        }
+        
+        // Reorder bindings: bit-reversed FFT output -> natural order
+        if constexpr (NATURAL_ORDER) {
+            reorder = new Reorder<N_SIZE, T>("reorder");
+            reorder->clk(clk);
+            reorder->rst_n(rst_n);
+            reorder->in_data(fft_to_reorder_chan);
+            reorder->out_data(fft_to_dma_chan);
+            fft.out_data(fft_to_reorder_chan);
+        } else if constexpr (REAL_INPUT) {
+            // Split bindings: N/2-point transform -> N/2 + 1 real-input bins
+            split = new SplitType("split");
+            split->clk(clk);
+            split->rst_n(rst_n);
+            split->in_data(fft_to_split_chan);
+            split->out_data(fft_to_dma_chan);
+            fft.out_data(fft_to_split_chan);
+        } else {
+            fft.out_data(fft_to_dma_chan);
+        }
+    }
+    
+    // Block of the core with the highest utilization (FFT stage, reorder buffer, split or
+    // window stage)
+    NamedCounters bottleneck() const {
+        NamedCounters b = fft.busiest_stage();
+        if (reorder != nullptr && reorder->perf.utilization() > b.perf->utilization()) {
+            b.name = reorder->basename();
+            b.perf = &reorder->perf;
+        }
+        if (split != nullptr && split->perf.utilization() > b.perf->utilization()) {
+            b.name = split->basename();
+            b.perf = &split->perf;
+        }
+        if (window_stage.perf.utilization() > b.perf->utilization()) {
+            b.name = window_stage.basename();
+            b.perf = &window_stage.perf;
+        }
+        return b;
+    }
+
+    // Butterflies the FFT stages pruned (only the radix-2 stage cascade prunes)
+    unsigned long pruned_butterflies() const {
+        if constexpr (decltype(dma)::PRUNE_ZEROS) {
+            return fft.pruned_butterflies();
+        } else {
+            return 0;
+        }
+    }
+
+    // Counters of the DMA, the window stage, the FFT stages, the reorder buffer and the
+    // real-input split
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        NamedCounters b = bottleneck();
+        w.StartObject();
+        w.Key("name"); w.String(basename());
+        w.Key("utilization"); w.Double(dma.perf.utilization());
+        w.Key("bottleneck"); w.String(b.name);
+        w.Key("dma"); dma.perf.write_json(w);
+        w.Key("window"); window_stage.perf.write_json(w, window_stage.basename());
+        w.Key("stages"); fft.write_perf_json(w);
+        if (reorder != nullptr) {
+            w.Key("reorder"); reorder->perf.write_json(w, reorder->basename());
+        }
+        if (split != nullptr) {
+            w.Key("split"); split->perf.write_json(w, split->basename());
+        }
+        w.EndObject();
+    }
+    
+    ~Core() {
+        delete reorder;
+        delete split;
     }
 };
 
@@ -2,8 +2,35 @@
  * dma.h
  *
  * Direct Memory Access (DMA) controller for AXI4 interface transactions.
- * Manages independent concurrent threads for address generation, read streaming,
- * and write-back streaming to move complex values between shared memory and the FFT core.
+ * Manages a read engine with multiple ID-tagged outstanding bursts feeding a prefetch FIFO,
+ * and a write-back streamer, to move complex values between shared memory and the FFT core.
+ * In stream mode, jobs are queued and their frames enter the pipeline back to back, so only
+ * an idle queue costs a zero flush frame. In descriptor mode, a job is a linked list of
+ * scatter-gather descriptors fetched over the same AXI read port. With a sample_vec_t
+ * datapath type, every beat carries one group of samples for a P-parallel FFT. In real-input
+ * mode a beat holds two real samples, and the N/2 + 1 unique bins of a frame return packed
+ * in N/2 beats. With a block-floating-point datapath, every output frame is followed by its
+ * shared exponent, written to the frame's entry of the exponent table at DmaCfg::expBase.
+ * Every job runs at the FFT length given on fft_len when it was started or queued (radix-2
+ * stage cascade only); before the stages switch to another length, the frames of the
+ * previous one are drained out of the pipeline. A job started or queued with a non-zero
+ * stft_hop is a short-time Fourier transform: its frames start every stft_hop samples and
+ * overlap, the shared samples are replayed from an on-chip overlap buffer so that every
+ * sample is read over AXI once, and the output frames go to stft_dst, stft_pitch bytes
+ * apart. The window selected on window is latched with every job for the window stage.
+ * The bin range [bin_lo, bin_hi) of a job selects the output bins written back: the other
+ * output beats are taken from the pipeline and dropped, the kept ones go to their usual
+ * slots. On the radix-2 stage cascade the range is also handed to the stages, which then
+ * prune the butterflies feeding unselected bins; like the FFT length, it changes only
+ * between drained pipelines. So does the direction: a job queued or started with inverse
+ * set runs the inverse transform on the radix-2 stage cascade.
+ * A job with non-zero conv_taps is an overlap-save convolution for the fast-convolution
+ * chain of ConvCore: N_SIZE-sample frames start every N_SIZE - conv_taps + 1 samples, the
+ * first one behind conv_taps - 1 zeros of history, overlapping samples are replayed from the
+ * overlap buffer as for an STFT, and of every output frame the conv_taps - 1 wrapped-around
+ * samples are dropped and the others written back to back in place of the input. Before the
+ * first job on the filter spectrum at filter_addr, that frame is read once and sent down
+ * the pipeline with filter_load set, for the filter multiply to keep.
  */
 
 #ifndef DMA_H
@@ -14,34 +41,80 @@
 #include <connections/connections.h>
 #include "fft_types.h"
 #include "stage.h"
+#include "stage_r22.h"
+#include "folded_fft.h"
+#include "real_split.h"
+#include "window.h"
+#include "perf_counters.h"
 #include <cmath>
+#include <deque>
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 
 using namespace sc_core;
 using namespace axi;
 using namespace Connections;
 
+// DMA read engine configurations
+namespace dma_cfg {
+    struct standard {
+        enum {
+            maxOutstanding = 4,  // AXI read bursts in flight (one ID each)
+            prefetchDepth = 256, // Read data prefetch FIFO entries
+            maxBurstLen = 64,    // Beats per read burst
+            jobQueueDepth = 4,   // Queued stream mode jobs
+            expBase = 0x40000000, // Frame exponent table (block-floating-point datapath)
+        };
+    };
+}
+
 // AXI4 DMA controller
-template<typename AxiCfg, int N_SIZE = 4, int NUM_MULT = 4, int NUM_ADD = 6>
+template<typename AxiCfg, int N_SIZE = 4, int NUM_MULT = 4, int NUM_ADD = 6, int RADIX = 2,
+         typename T = complex_t, typename DmaCfg = dma_cfg::standard, bool NATURAL_ORDER = false,
+         int FOLD_BF = 0, bool REAL_INPUT = false>
 SC_MODULE(DMA) {
+    static_assert(DmaCfg::maxBurstLen <= DmaCfg::prefetchDepth, "A read burst must fit in the prefetch FIFO");
+    static_assert(DmaCfg::maxBurstLen <= 256, "AXI4 bursts are limited to 256 beats");
+    static_assert(DmaCfg::maxOutstanding < (1 << AxiCfg::idWidth), "Not enough AXI IDs for the outstanding reads and descriptor fetches");
+
     sc_in<bool> clk;
     sc_in<bool> rst_n; // Active-low reset
 
     // Control interface
     sc_in<bool> start;
+    sc_in<bool> stream_mode; // Queue jobs and stream them back to back (change only while idle)
+    sc_in<bool> desc_mode;   // Start walks the descriptor chain at base_addr (implies streaming)
     sc_in<sc_uint<AxiCfg::addrWidth>> base_addr;
     sc_in<int> num_samples;
+    sc_in<int> fft_len;      // FFT length of the jobs started or queued (0: N_SIZE)
+    sc_out<int> active_len;  // FFT length the stages are set to
+    sc_in<int> window;       // WindowRom kind of the jobs started or queued
+    sc_out<int> active_window; // Window of the frames entering the pipeline
+    sc_in<int> stft_hop;     // Samples between the frames of an STFT job (0: consecutive frames)
+    sc_in<sc_uint<AxiCfg::addrWidth>> stft_dst; // First output frame of an STFT job
+    sc_in<int> stft_pitch;   // Bytes between the output frames of an STFT job (0: one frame)
+    sc_in<int> bin_lo;       // First output bin written back of the jobs started or queued
+    sc_in<int> bin_hi;       // End of their bin range (<= 0: up to the last bin)
+    sc_out<int> active_bin_lo; // Bin range the stages prune to
+    sc_out<int> active_bin_hi;
+    sc_in<bool> inverse;     // Inverse transform for the jobs started or queued
+    sc_out<bool> active_inverse; // Direction the stages are set to
+    sc_in<int> conv_taps;    // Filter taps of the convolution jobs started or queued (0: FFT jobs)
+    sc_in<sc_uint<AxiCfg::addrWidth>> filter_addr; // Their filter spectrum (one frame, natural order)
+    sc_out<bool> filter_load; // The beats entering the pipeline are a filter spectrum
     sc_out<bool> busy;
+    sc_out<int> rd_outstanding; // AR bursts in flight (bus occupancy for the Top scheduler)
+    sc_out<int> wr_outstanding; // AW bursts awaiting their write response
 
     // AXI Master interfaces (default port types)
     typename axi4<AxiCfg>::read::template master<> mem_read_port;
     typename axi4<AxiCfg>::write::template master<> mem_write_port;
 
     // Connections interfaces to the FFT core
-    Out<complex_t> fft_out;
-    In<complex_t> fft_in;
+    Out<T> fft_out;
+    In<T> fft_in;
 
     typedef typename axi4<AxiCfg>::AddrPayload AddrPayload;
     typedef typename axi4<AxiCfg>::ReadPayload ReadPayload;
@@ -50,13 +123,160 @@ SC_MODULE(DMA) {
 
     static const int bytesPerBeat = AxiCfg::dataWidth / 8;
 
+    // A beat and an FFT transfer carry LANES samples (P-parallel FFT), or two real samples
+    // packed as one complex value (REAL_INPUT); the engines count beats, job and descriptor
+    // lengths are given in samples
+    static const int LANES = beat_lanes<T>::value;
+    static const int SAMPLES_PER_BEAT = REAL_INPUT ? 2 : LANES;
+    static const int FRAME_BEATS = N_SIZE / SAMPLES_PER_BEAT;
+    static const int FFT_SIZE = REAL_INPUT ? N_SIZE / 2 : N_SIZE; // Points of the complex FFT
+
+    static int to_beats(int samples) {
+        return (samples + SAMPLES_PER_BEAT - 1) / SAMPLES_PER_BEAT;
+    }
+
+    // Run-time FFT lengths: any power of two from 2 to N_SIZE on the radix-2 stage cascade,
+    // whose leading stages are bypassed for shorter ones; N_SIZE on the other pipelines
+    static const bool VARIABLE_LEN = RADIX == 2 && LANES == 1 && FOLD_BF == 0 && !REAL_INPUT &&
+                                     !NATURAL_ORDER && N_SIZE >= 2;
+
+    // Pruning in the stages: zero operands on the radix-2 stage cascade, unselected bins
+    // where its outputs are the bins themselves (not on the real-input split)
+    static const bool PRUNE_ZEROS = RADIX == 2 && LANES == 1 && FOLD_BF == 0 && FFT_SIZE >= 2;
+    static const bool PRUNE_BINS = PRUNE_ZEROS && !REAL_INPUT;
+
+    // Inverse transforms on the same stages (conjugated twiddles need a fixed frame scale,
+    // not block floating point); convolution jobs on one complex sample per beat
+    static const bool INVERSE = PRUNE_BINS && !bfp_traits<T>::enabled;
+    static const bool CONV_JOBS = LANES == 1 && !REAL_INPUT && N_SIZE >= 2;
+
+    // Output bins [lo, hi) of a job (hi <= 0: up to the last bin)
+    struct BinRange {
+        int lo;
+        int hi;
+
+        bool operator==(const BinRange& b) const { return lo == b.lo && hi == b.hi; }
+    };
+
+    static int reverse_bits(int index, int n) {
+        int rev = 0;
+        for (int b = 1; b < n; b <<= 1) {
+            rev = (rev << 1) | ((index & b) ? 1 : 0);
+        }
+        return rev;
+    }
+
+    // Whether output beat b of a frame of len samples carries a bin of the range. Natural
+    // order (reorder buffer, or the real-input split, whose beat 0 also carries bin len/2)
+    // has bin b at beat b; otherwise lane l holds bit-reversed position b * LANES + l.
+    static bool beat_selected(int b, int len, const BinRange& bins) {
+        int num_bins = REAL_INPUT ? len / 2 + 1 : len;
+        int lo = (bins.lo > 0) ? bins.lo : 0;
+        int hi = (bins.hi <= 0 || bins.hi > num_bins) ? num_bins : bins.hi;
+        if (lo == 0 && hi == num_bins) {
+            return true;
+        }
+        if (NATURAL_ORDER || REAL_INPUT) {
+            return (b >= lo && b < hi) || (REAL_INPUT && b == 0 && len / 2 >= lo && len / 2 < hi);
+        }
+        for (int l = 0; l < LANES; ++l) {
+            int k = reverse_bits(b * LANES + l, len);
+            if (k >= lo && k < hi) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool valid_len(int len) {
+        if (len == 0 || len == N_SIZE) {
+            return true;
+        }
+        return VARIABLE_LEN && len >= 2 && len < N_SIZE && (len & (len - 1)) == 0;
+    }
+
+    // FFT length of a job requested with fft_len = requested (unsupported: N_SIZE)
+    static int job_len(int requested) {
+        return (requested != 0 && valid_len(requested)) ? requested : (int)N_SIZE;
+    }
+
+    static int frame_beats(int len) {
+        return len / SAMPLES_PER_BEAT;
+    }
+
+    // FFT length of a job, reporting unsupported requests
+    int checked_len(int requested) {
+        if (!valid_len(requested)) {
+            SC_REPORT_WARNING(name(), "Unsupported fft_len, the job runs at the full length");
+        }
+        return job_len(requested);
+    }
+
+    // Hop of an STFT job in beats (0: no STFT job); hops that do not fall on a beat boundary
+    // run without overlap
+    static int hop_beats(int hop, int len) {
+        if (hop <= 0) {
+            return 0;
+        }
+        return (hop % SAMPLES_PER_BEAT == 0) ? hop / SAMPLES_PER_BEAT : frame_beats(len);
+    }
+
+    // Hop of an STFT job, reporting unsupported requests
+    int checked_hop(int hop, int len) {
+        if (hop > 0 && hop % SAMPLES_PER_BEAT != 0) {
+            SC_REPORT_WARNING(name(), "Unsupported stft_hop, the frames do not overlap");
+        }
+        return hop_beats(hop, len);
+    }
+
+    // Frames of an STFT over total beats: every frame that fits, or one zero-padded frame
+    static int stft_frames(int total, int hop, int frame) {
+        if (total <= 0) {
+            return 0;
+        }
+        return (total < frame) ? 1 : 1 + (total - frame) / hop;
+    }
+
+    // Direction of a job requested with inverse set, reporting unsupported requests
+    bool checked_inverse(bool requested) {
+        if (requested && !INVERSE) {
+            SC_REPORT_WARNING(name(), "Unsupported inverse, the job runs the forward transform");
+        }
+        return requested && INVERSE;
+    }
+
+    // Overlap-save hop in beats of a convolution with taps filter taps (0: no convolution):
+    // every frame repeats the last taps - 1 samples of the previous one. Longer filters than
+    // a frame are cut to one frame.
+    static int conv_hop(int taps) {
+        if (taps <= 0 || !CONV_JOBS) {
+            return 0;
+        }
+        return FRAME_BEATS - ((taps < FRAME_BEATS) ? taps : (int)FRAME_BEATS) + 1;
+    }
+
+    // Overlap-save hop of a job, reporting unsupported requests
+    int checked_conv_hop(int taps) {
+        if (taps > 0 && !CONV_JOBS) {
+            SC_REPORT_WARNING(name(), "Unsupported conv_taps, the job runs an FFT");
+        } else if (taps > FRAME_BEATS) {
+            SC_REPORT_WARNING(name(), "Filter longer than a frame, its taps are cut to N_SIZE");
+        }
+        return conv_hop(taps);
+    }
+
+    // Frames of a convolution over total beats: every output sample is kept from one frame
+    static int conv_frames(int total, int hop) {
+        return (total > 0) ? (total + hop - 1) / hop : 0;
+    }
+
     // Helper to build AXI address requests
     AddrPayload create_addr_req(typename axi4<AxiCfg>::Addr addr, int len) {
         AddrPayload req;
         req.addr = addr;
         req.id = 0;
         req.len = len;
-        req.size = AxiCfg::dataWidth == 64 ? 3 : 2;
+        req.size = (int)std::log2(bytesPerBeat);
         req.burst = 1; // INCR burst
         return req;
     }
@@ -70,137 +290,746 @@ SC_MODULE(DMA) {
         return w_pay;
     }
 
-    // Compute pipeline latency under resource limits
-    static int calc_pipeline_latency() {
-        int num_stages = (int)std::log2(N_SIZE);
+    // Compute pipeline latency (in beats) under resource limits: every stage holds back half
+    // a block plus the extra cycles its scheduled butterfly spends in the ALU; a folded FFT
+    // (FOLD_BF shared butterfly units) holds back one frame. The paths of a P-parallel FFT
+    // delay by 1/LANES of the span, its last log2(LANES) stages take one merge step.
+    // The real-input split stage holds back one more frame. At a run-time length len, the
+    // bypassed stages hold back nothing.
+    static int calc_pipeline_latency(int len = N_SIZE) {
         int total_latency = 0;
-        int alu_cycles = Stage<2>::calc_latency(NUM_MULT, NUM_ADD);
-        
-        for (int i = 0; i < num_stages; i++) {
-            int current_N = N_SIZE >> i;
-            int stage_latency = (current_N / 2);
-            total_latency += stage_latency + (alu_cycles - 1);
+        if constexpr (FOLD_BF > 0 && FFT_SIZE > 1) {
+            total_latency = FoldedFFT<FFT_SIZE, FOLD_BF>::calc_latency();
+        } else {
+            int num_stages = (int)std::log2(FFT_SIZE);
+            int alu_cycles = Stage<2>::calc_latency(NUM_MULT, NUM_ADD);
+            int trivial_alu_cycles = StageR22I<4>::calc_latency(NUM_MULT, NUM_ADD);
+            int twiddled_alu_cycles = StageR22II<4>::calc_latency(NUM_MULT, NUM_ADD);
+
+            for (int i = 0; i < num_stages; i++) {
+                int current_N = FFT_SIZE >> i;
+                if (current_N < 2 * LANES) {
+                    break;
+                }
+                if (current_N > len) {
+                    continue;
+                }
+                int stage_latency = (current_N / 2) / LANES;
+                // Even stages of a radix-2^2 cascade are multiplier-less BF2I butterflies, odd
+                // ones BF2II butterflies with both outputs twiddled
+                bool trivial = (RADIX == 4) && (LANES == 1) && (i % 2 == 0) && (current_N >= 4);
+                bool twiddled = (RADIX == 4) && (LANES == 1) && (i % 2 == 1);
+                int stage_alu_cycles = trivial ? trivial_alu_cycles : (twiddled ? twiddled_alu_cycles : alu_cycles);
+                total_latency += stage_latency + (stage_alu_cycles - 1);
+            }
+            if (LANES > 1) {
+                total_latency += alu_cycles - 1;
+            }
+        }
+        // The natural-order reorder buffer holds back one more frame
+        if (NATURAL_ORDER) {
+            total_latency += frame_beats(len);
+        }
+        if constexpr (REAL_INPUT) {
+            total_latency += RealSplit<N_SIZE>::calc_latency();
         }
         return total_latency;
     }
 
-    // AXI read address generator
-    void read_addr_thread() {
-        mem_read_port.ar.Reset();
+    // Pipeline latency (in beats) of the fast-convolution chain: the forward and the inverse
+    // FFT, each followed by a reorder buffer; the filter multiply holds back no beats
+    static int calc_conv_latency() {
+        return 2 * (calc_pipeline_latency() + (NATURAL_ORDER ? 0 : (int)FRAME_BEATS));
+    }
+
+    // Outstanding read burst tracker entry (one per AXI ID)
+    struct ReadBurst {
+        bool busy;
+        int beats;       // Beats requested by the burst
+        int delivered;   // Beats already forwarded to the FFT
+        bool first_beat; // First R beat received (latency recorded)
+        sc_time issued;  // AR handshake
+        std::deque<T> data;
+    };
+
+    ReadBurst read_bursts[DmaCfg::maxOutstanding];
+    std::deque<int> read_order; // Outstanding IDs in issue order
+    int prefetch_reserved;      // Prefetch FIFO entries reserved by issued bursts
+    int read_next_id;
+
+    DmaCounters perf; // AXI bursts, latencies and stall attribution
+
+    // Streaming job submitted through a start pulse
+    struct DmaJob {
+        typename axi4<AxiCfg>::Addr addr; // Source, or head descriptor address for a chain
+        int samples;
+        bool chain;                       // Descriptor chain (desc_mode)
+        int len;                          // FFT length
+        int window;                       // WindowRom kind
+        int hop;                          // STFT hop in beats (0: consecutive frames)
+        typename axi4<AxiCfg>::Addr dst;  // STFT output frames
+        int pitch;                        // Bytes between STFT output frames
+        BinRange bins;                    // Output bins written back
+        bool inverse;                     // Inverse transform
+        int conv_hop;                     // Overlap-save hop in beats (0: no convolution)
+        typename axi4<AxiCfg>::Addr filter; // Filter spectrum of a convolution
+    };
+
+    // Frame tag passed from the read engine to the writer, in FFT stream order
+    struct FrameTag {
+        typename axi4<AxiCfg>::Addr dst;
+        int samples; // Output beats to write
+        int discard; // Padding/flush beats to drop
+        bool flush;  // Zero frame inserted by the read engine
+        bool last;   // Last frame of its job
+        int frame;   // Beats per frame
+        int pitch;   // Bytes between output frames (0: contiguous)
+        BinRange bins; // Output bins written back
+        int keep;    // Overlap-save: beats kept at the end of every frame (0: all)
+    };
+
+    std::deque<DmaJob> jobs;           // Job queue (stream mode)
+    std::deque<FrameTag> frame_tags;   // Tag FIFO (stream mode)
+    int stream_jobs;                   // Jobs submitted but not yet written back
+    bool stream_flushed;               // Pipeline holds no frame that still has to drain
+    int pipe_len;                      // FFT length of the frames in the pipeline
+    BinRange pipe_bins;                // Bin range the stages prune to
+    bool pipe_inverse;                 // Direction of the stages
+    bool pipe_conv;                    // The pipeline holds frames of a convolution
+    typename axi4<AxiCfg>::Addr pipe_filter; // Filter spectrum held by the filter multiply
+    bool filter_loaded;                // pipe_filter is valid
+    bool write_active;                 // Writer busy with a tag it took off the FIFO
+    std::vector<T> overlap;            // Last frame of sample beats fetched (STFT overlap buffer)
+    bool start_prev;
+
+    // Scatter-gather descriptor: four beats {src, dst, len | stride, next}, with the
+    // length in the upper and the source stride (bytes, 0 = contiguous) in the lower
+    // half of the third beat. A next address of 0 ends the chain.
+    enum {
+        descBeats = 4,
+        descReadId = (1 << AxiCfg::idWidth) - 1, // Reserved for descriptor fetches
+    };
+
+    struct Descriptor {
+        typename axi4<AxiCfg>::Addr src;
+        typename axi4<AxiCfg>::Addr dst;
+        int samples;
+        int stride;
+        typename axi4<AxiCfg>::Addr next;
+    };
+
+    sc_uint<AxiCfg::dataWidth> desc_words[descBeats];
+    typename axi4<AxiCfg>::Addr desc_fetch_addr;
+    bool desc_fetch_pending; // Descriptor AR not yet issued
+    int desc_beats;          // Descriptor beats received
+
+    // Queue the fetch of the descriptor at addr; it is issued alongside data bursts
+    void request_descriptor(typename axi4<AxiCfg>::Addr addr) {
+        desc_fetch_addr = addr;
+        desc_fetch_pending = true;
+        desc_beats = 0;
+    }
+
+    // Complete the outstanding descriptor fetch and decode it
+    Descriptor wait_descriptor() {
+        while (desc_beats < descBeats) {
+            if (desc_fetch_pending) {
+                AddrPayload req = create_addr_req(desc_fetch_addr, descBeats - 1);
+                req.id = descReadId;
+                if (mem_read_port.ar.PushNB(req)) {
+                    desc_fetch_pending = false;
+                    perf.desc_fetches++;
+                }
+            }
+            ReadPayload resp;
+            if (mem_read_port.r.PopNB(resp) && resp.id == descReadId) {
+                desc_words[desc_beats++] = resp.data;
+            }
+            wait();
+        }
+        static const int HALF_WIDTH = AxiCfg::dataWidth / 2;
+        Descriptor d;
+        d.src = desc_words[0].to_uint64();
+        d.dst = desc_words[1].to_uint64();
+        d.samples = desc_words[2].range(AxiCfg::dataWidth - 1, HALF_WIDTH).to_int();
+        d.stride = desc_words[2].range(HALF_WIDTH - 1, 0).to_int();
+        d.next = desc_words[3].to_uint64();
+        return d;
+    }
+
+    static const int flush_frames = NATURAL_ORDER ? 2 : 1;
+
+    // Zero beats that push the last frame of FFT length len (or of a convolution) out of the
+    // pipeline: whole frames covering the pipeline latency, at least flush_frames of them
+    static int flush_beats(int len, bool conv = false) {
+        int frame = frame_beats(len);
+        int latency = conv ? calc_conv_latency() : calc_pipeline_latency(len);
+        int frames = (latency + frame - 1) / frame;
+        return ((frames > flush_frames) ? frames : (int)flush_frames) * frame;
+    }
+
+    // Cycles after its last input until a pipeline whose outputs are consumed every cycle
+    // has emitted all it will emit without further inputs: every stage, bypassed or not,
+    // retires the butterflies still in its ALU and output queue (the fast-convolution chain:
+    // both cascades and the filter multiply; a radix-2^2 cascade counts every stage at the
+    // longer BF2II schedule)
+    static int calc_settle_cycles(bool conv = false) {
+        ButterflyScheduler s(NUM_MULT, NUM_ADD, (RADIX == 4) ? ButterflyScheduler::BF2II : ButterflyScheduler::RADIX2);
+        int num_stages = (FFT_SIZE > 1) ? (int)std::log2(FFT_SIZE) : 0;
+        if (conv) {
+            num_stages = 2 * num_stages + 1;
+        }
+        return num_stages * (s.latency() + s.depth() + 1) + 1;
+    }
+
+    // Set the stages to FFT length len, bin range bins and direction inverse for the next
+    // job, a convolution (conv) on the filter spectrum at filter. If frames of another
+    // setting are in the pipeline, zero frames first push them out until they are written
+    // and the pipeline has settled. After a length change the remaining flush outputs are
+    // dropped with their tags, as the stages start the new length from empty delay lines;
+    // at the same length the next job pushes them out as usual. A filter spectrum other than
+    // the one held is then loaded into the filter multiply.
+    void set_pipeline(int len, BinRange bins, bool inverse = false, bool conv = false,
+                      typename axi4<AxiCfg>::Addr filter = 0) {
+        if (!PRUNE_BINS) {
+            bins = BinRange{ 0, 0 }; // The stages compute every bin
+        }
+        bool load = conv && (!filter_loaded || filter != pipe_filter);
+        if (len == pipe_len && bins == pipe_bins && inverse == pipe_inverse && conv == pipe_conv && !load) {
+            return;
+        }
+        if (!stream_flushed) {
+            FrameTag tag = { 0, 0, flush_beats(pipe_len, pipe_conv), true, false, frame_beats(pipe_len), 0,
+                             { 0, 0 }, 0 };
+            frame_tags.push_back(tag);
+            read_samples(0, 0, flush_beats(pipe_len, pipe_conv));
+            stream_flushed = true;
+        }
+        bool drained = false;
+        while (!drained) {
+            drained = !write_active;
+            for (const FrameTag& tag : frame_tags) {
+                drained = drained && tag.flush;
+            }
+            wait();
+        }
+        wait(calc_settle_cycles(pipe_conv));
+        if (len != pipe_len) {
+            frame_tags.clear();
+        }
+        pipe_len = len;
+        pipe_bins = bins;
+        pipe_inverse = inverse;
+        pipe_conv = conv;
+        active_len.write(len);
+        active_bin_lo.write(bins.lo);
+        active_bin_hi.write(bins.hi);
+        active_inverse.write(inverse);
+        if (load) {
+            load_filter(filter);
+        }
+    }
+
+    // Send the filter spectrum at addr down the drained pipeline with filter_load set; the
+    // flag settles a cycle before the first beat and is cleared a cycle after the last one
+    void load_filter(typename axi4<AxiCfg>::Addr addr) {
+        filter_load.write(true);
+        wait();
+        read_samples(addr, FRAME_BEATS, FRAME_BEATS);
+        wait();
+        filter_load.write(false);
         wait();
+        pipe_filter = addr;
+        filter_loaded = true;
+    }
+
+    bool queued_mode() {
+        return stream_mode.read() || desc_mode.read();
+    }
+
+    // Stream total beats from addr to the FFT, then zero beats up to padded_total beats.
+    // Up to maxOutstanding ID-tagged bursts run ahead of consumption and their (possibly
+    // interleaved) R beats collect in the prefetch FIFO before being forwarded in order.
+    // A source stride other than one beat gathers the samples with single-beat bursts.
+    // With a hop of hop beats (STFT), the FFT instead receives the frames of frame beats
+    // starting every hop beats: beats shared with the previous frame are replayed from the
+    // overlap buffer, beats between frames further apart than a frame are not fetched, and
+    // a partial last frame is left out. An overlap-save convolution passes its frame count,
+    // which zero-pads the last frame, and lead zero beats of history ahead of the samples.
+    void read_samples(typename axi4<AxiCfg>::Addr addr, int total, int padded_total,
+                      int stride = bytesPerBeat, int hop = 0, int frame = FRAME_BEATS,
+                      int frames = 0, int lead = 0) {
+        bool contiguous = (stride == 0) || (stride == bytesPerBeat);
+        int step = contiguous ? (int)bytesPerBeat : stride;
+        if (hop > 0 && frames == 0) {
+            frames = stft_frames(total, hop, frame);
+        }
+        int data_total = (hop > 0) ? frames * frame : total; // FFT beats carrying samples
+        int fetch_total = total;                              // Sample beats to fetch
+        if (hop > 0 && (frames - 1) * hop + frame - lead < total) {
+            fetch_total = (frames - 1) * hop + frame - lead;
+        }
+        int fetch = 0;                                        // Next sample beat to request
+        int fetch_end = (hop > frame) ? frame : fetch_total;  // End of the run being fetched
+        int next_in = 0;                                      // Sample beats forwarded so far
+        int pushed = 0;
         
-        while (true) {
-            while (!start.read()) {
-                wait();
+        while (pushed < padded_total) {
+            // Issue the next burst when an ID and FIFO space for all its beats are free;
+            // a pending descriptor prefetch takes precedence on AR
+            int avail = ((fetch_end < fetch_total) ? fetch_end : fetch_total) - fetch;
+            int len = (avail > DmaCfg::maxBurstLen) ? (int)DmaCfg::maxBurstLen : avail;
+            if (!contiguous) {
+                len = 1;
             }
-            
-            int total = num_samples.read();
-            typename axi4<AxiCfg>::Addr addr = base_addr.read();
-            while (total > 0) {
-                int len = (total > 256) ? 256 : total;
-                AddrPayload req = create_addr_req(addr, len - 1);
-                mem_read_port.ar.Push(req);
-                addr += len * bytesPerBeat;
-                total -= len;
+            if (desc_fetch_pending) {
+                AddrPayload req = create_addr_req(desc_fetch_addr, descBeats - 1);
+                req.id = descReadId;
+                if (mem_read_port.ar.PushNB(req)) {
+                    desc_fetch_pending = false;
+                    perf.desc_fetches++;
+                }
+            } else if (avail > 0 && !read_bursts[read_next_id].busy &&
+                prefetch_reserved + len <= DmaCfg::prefetchDepth) {
+                AddrPayload req = create_addr_req(addr + fetch * step, len - 1);
+                req.id = read_next_id;
+                if (mem_read_port.ar.PushNB(req)) {
+                    read_bursts[read_next_id].busy = true;
+                    read_bursts[read_next_id].beats = len;
+                    read_bursts[read_next_id].delivered = 0;
+                    read_bursts[read_next_id].first_beat = false;
+                    read_bursts[read_next_id].issued = sc_time_stamp();
+                    perf.read.bursts++;
+                    read_order.push_back(read_next_id);
+                    prefetch_reserved += len;
+                    read_next_id = (read_next_id + 1) % DmaCfg::maxOutstanding;
+                    fetch += len;
+                    if (hop > frame && fetch == fetch_end) {
+                        fetch += hop - frame;
+                        fetch_end = fetch + frame;
+                    }
+                }
             }
             
-            while (busy.read()) {
-                wait();
+            // Accept read data; space was reserved at issue so R is never stalled
+            ReadPayload resp;
+            if (mem_read_port.r.PopNB(resp)) {
+                if (resp.id == descReadId) {
+                    desc_words[desc_beats++] = resp.data;
+                } else {
+                    int id = resp.id.to_int() % DmaCfg::maxOutstanding;
+                    T beat;
+                    unpack_beat<AxiCfg>(resp.data, beat);
+                    read_bursts[id].data.push_back(beat);
+                    perf.read.beats++;
+                    if (!read_bursts[id].first_beat) {
+                        read_bursts[id].first_beat = true;
+                        perf.read.latency.add(cycles_since(read_bursts[id].issued, perf.period));
+                    }
+                }
             }
-            while (start.read()) {
-                wait();
+            
+            // Forward the oldest burst's data or the overlap, then the zero padding
+            if (pushed < data_total) {
+                int i = (hop > 0) ? (pushed / frame) * hop + pushed % frame - lead : pushed; // Sample beat
+                int head = read_order.empty() ? -1 : read_order.front();
+                if (i >= 0 && i < next_in) {
+                    if (fft_out.PushNB(overlap[i % frame])) {
+                        pushed++;
+                    } else {
+                        perf.read.stall_cycles++;
+                    }
+                } else if (i < 0 || i >= fetch_total) {
+                    // Zero history, or zero padding of a last frame past the samples
+                    if (fft_out.PushNB(T())) {
+                        pushed++;
+                    } else {
+                        perf.read.stall_cycles++;
+                    }
+                } else if (head < 0 || read_bursts[head].data.empty()) {
+                    perf.read_wait_cycles++;
+                } else if (fft_out.PushNB(read_bursts[head].data.front())) {
+                    if (hop > 0) {
+                        overlap[i % frame] = read_bursts[head].data.front();
+                    }
+                    read_bursts[head].data.pop_front();
+                    prefetch_reserved--;
+                    pushed++;
+                    next_in = i + 1;
+                    if (++read_bursts[head].delivered == read_bursts[head].beats) {
+                        read_bursts[head].busy = false;
+                        read_order.pop_front();
+                    }
+                } else {
+                    perf.read.stall_cycles++;
+                }
+            } else if (fft_out.PushNB(T())) {
+                pushed++;
+            } else {
+                perf.read.stall_cycles++;
             }
+            
+            rd_outstanding.write((int)read_order.size());
+            wait();
         }
+        rd_outstanding.write(0);
     }
 
-    // AXI read data stream reader
-    void read_data_thread() {
+    // AXI read engine
+    void read_thread() {
+        mem_read_port.ar.Reset();
         mem_read_port.r.Reset();
         fft_out.Reset();
+        rd_outstanding.write(0);
+        perf.start(bound_clock_period(clk));
+        for (int id = 0; id < DmaCfg::maxOutstanding; ++id) {
+            read_bursts[id].busy = false;
+            read_bursts[id].data.clear();
+        }
+        read_order.clear();
+        prefetch_reserved = 0;
+        read_next_id = 0;
+        frame_tags.clear();
+        stream_flushed = true;
+        pipe_len = N_SIZE;
+        pipe_bins = BinRange{ 0, 0 };
+        pipe_inverse = false;
+        pipe_conv = false;
+        filter_loaded = false;
+        active_len.write(N_SIZE);
+        active_bin_lo.write(0);
+        active_bin_hi.write(0);
+        active_inverse.write(false);
+        filter_load.write(false);
+        active_window.write(WindowRom::rectangular);
+        desc_fetch_pending = false;
+        desc_beats = descBeats;
         wait();
         
         while (true) {
-            while (!start.read()) {
+            if (queued_mode()) {
+                // Continuous streaming: frames of consecutive jobs follow each other
+                // through the pipeline, each one flushing the previous one
+                if (!jobs.empty() && jobs.front().chain) {
+                    // Walk the descriptor chain, prefetching each next descriptor
+                    // while the current frame streams
+                    DmaJob job = jobs.front();
+                    jobs.pop_front();
+                    set_pipeline(job.len, job.bins, job.inverse);
+                    active_window.write(job.window);
+                    int frame = frame_beats(job.len);
+                    request_descriptor(job.addr);
+                    bool last = false;
+                    while (!last) {
+                        Descriptor d = wait_descriptor();
+                        last = (d.next == 0);
+                        if (!last) {
+                            request_descriptor(d.next);
+                        }
+                        int beats = to_beats(d.samples);
+                        int aligned = ((beats + frame - 1) / frame) * frame;
+                        FrameTag tag = { d.dst, beats, aligned - beats, false, last, frame, 0, job.bins, 0 };
+                        frame_tags.push_back(tag);
+                        read_samples(d.src, beats, aligned, d.stride);
+                        stream_flushed = false;
+                    }
+                } else if (!jobs.empty()) {
+                    DmaJob job = jobs.front();
+                    jobs.pop_front();
+                    set_pipeline(job.len, job.bins, job.inverse, job.conv_hop > 0, job.filter);
+                    active_window.write(job.window);
+                    int frame = frame_beats(job.len);
+                    int beats = to_beats(job.samples);
+                    if (job.conv_hop > 0) {
+                        // Overlap-save: frames every conv_hop beats behind the zero history
+                        int frames = conv_frames(beats, job.conv_hop);
+                        FrameTag tag = { job.addr + frame * bytesPerBeat, beats, 0, false, true, frame, 0,
+                                         job.bins, job.conv_hop };
+                        frame_tags.push_back(tag);
+                        read_samples(job.addr, beats, frames * frame, bytesPerBeat, job.conv_hop, frame, frames,
+                                     frame - job.conv_hop);
+                    } else if (job.hop > 0) {
+                        // STFT: overlapping frames from one pass over the samples
+                        int out = stft_frames(beats, job.hop, frame) * frame;
+                        FrameTag tag = { job.dst, out, 0, false, true, frame, job.pitch, job.bins, 0 };
+                        frame_tags.push_back(tag);
+                        read_samples(job.addr, beats, out, bytesPerBeat, job.hop, frame);
+                    } else {
+                        int aligned = ((beats + frame - 1) / frame) * frame;
+                        FrameTag tag = { job.addr + frame * bytesPerBeat, beats, aligned - beats, false, true, frame, 0,
+                                         job.bins, 0 };
+                        frame_tags.push_back(tag);
+                        read_samples(job.addr, beats, aligned);
+                    }
+                    stream_flushed = false;
+                } else if (!stream_flushed) {
+                    // Queue ran dry: zero frames drain the last job out of the pipeline
+                    // (one more frame for the natural-order reorder buffer)
+                    FrameTag tag = { 0, 0, flush_beats(pipe_len, pipe_conv), true, false, frame_beats(pipe_len), 0,
+                                     { 0, 0 }, 0 };
+                    frame_tags.push_back(tag);
+                    read_samples(0, 0, flush_beats(pipe_len, pipe_conv));
+                    stream_flushed = true;
+                } else {
+                    wait();
+                }
+                continue;
+            }
+            
+            if (!start.read()) {
                 wait();
+                continue;
             }
             
-            int total = num_samples.read();
-            if (total > 0) {
-                int latency = calc_pipeline_latency();
-                int total_inputs = ((total + latency + N_SIZE - 1) / N_SIZE) * N_SIZE;
-                int flush_inputs_to_push = total_inputs - total;
-                
-                // Read and unpack samples from AXI R
-                for (int i = 0; i < total; ++i) {
-                    ReadPayload resp = mem_read_port.r.Pop();
-                    complex_t sample = unpack_complex<AxiCfg>(resp.data);
-                    fft_out.Push(sample);
-                }
-                
-                // Flush pipeline with zeros
-                for (int i = 0; i < flush_inputs_to_push; ++i) {
-                    fft_out.Push(complex_t(0.0, 0.0));
-                }
+            int total = to_beats(num_samples.read());
+            int chop = checked_conv_hop(conv_taps.read());
+            int len = (chop > 0) ? (int)N_SIZE : checked_len(fft_len.read());
+            set_pipeline(len, BinRange{ bin_lo.read(), bin_hi.read() }, checked_inverse(inverse.read()), chop > 0,
+                         filter_addr.read());
+            active_window.write(window.read());
+            if (total > 0 && chop > 0) {
+                int frame = frame_beats(len);
+                int frames = conv_frames(total, chop);
+                int total_inputs = ((frames * frame + calc_conv_latency() + frame - 1) / frame) * frame;
+                read_samples(base_addr.read(), total, total_inputs, bytesPerBeat, chop, frame, frames, frame - chop);
+            } else if (total > 0) {
+                int frame = frame_beats(len);
+                int hop = checked_hop(stft_hop.read(), len);
+                int beats = (hop > 0) ? stft_frames(total, hop, frame) * frame : total;
+                int latency = calc_pipeline_latency(len);
+                int total_inputs = ((beats + latency + frame - 1) / frame) * frame;
+                read_samples(base_addr.read(), total, total_inputs, bytesPerBeat, hop, frame);
             }
             
+            while (busy.read()) {
+                wait();
+            }
             while (start.read()) {
                 wait();
             }
         }
     }
 
+    // Exponent table entry of the output frame of frame beats starting at frame_addr: one
+    // beat per frame slot of the address space, so every frame written has an entry of its own
+    static typename axi4<AxiCfg>::Addr exponent_addr(typename axi4<AxiCfg>::Addr frame_addr,
+                                                     int frame = FRAME_BEATS) {
+        return DmaCfg::expBase + (frame_addr / (frame * bytesPerBeat)) * bytesPerBeat;
+    }
+
+    // Single-beat write burst
+    void write_word(typename axi4<AxiCfg>::Addr addr, typename axi4<AxiCfg>::Data data) {
+        sc_time t0 = sc_time_stamp();
+        mem_write_port.aw.Push(create_addr_req(addr, 0));
+        perf.write.stall_cycles += cycles_since(t0, perf.period) - 1;
+        perf.write.bursts++;
+        sc_time aw_done = sc_time_stamp();
+        wr_outstanding.write(1);
+        t0 = sc_time_stamp();
+        mem_write_port.w.Push(create_write_payload(data, true));
+        perf.write.stall_cycles += cycles_since(t0, perf.period) - 1;
+        perf.write.beats++;
+        mem_write_port.b.Pop();
+        perf.write.latency.add(cycles_since(aw_done, perf.period));
+        wr_outstanding.write(0);
+    }
+
+    // Write total FFT output beats to addr in bursts, then drop discard beats. Beats outside
+    // the bin range of the frames of frame beats are taken and dropped, so bursts cover the
+    // runs of selected beats at their usual addresses. On a block-floating-point datapath
+    // bursts end at the frame boundaries and every frame (or the job's partial last frame)
+    // with beats written is followed by its exponent and saturation flag.
+    void write_samples(typename axi4<AxiCfg>::Addr addr, int total, int discard,
+                       int frame = FRAME_BEATS, BinRange bins = BinRange{ 0, 0 }) {
+        int len_samples = frame * SAMPLES_PER_BEAT;
+        int written = 0; // Output beats taken from the FFT
+        int frame_exp = 0;
+        bool frame_sat = false;
+        bool frame_written = false;
+        auto take = [&](int index) {
+            sc_time t0 = sc_time_stamp();
+            T out_val = fft_in.Pop();
+            perf.fft_wait_cycles += cycles_since(t0, perf.period) - 1;
+            if constexpr (bfp_traits<T>::enabled) {
+                if (index % frame == 0) {
+                    frame_exp = out_val.exp.to_uint();
+                    frame_sat = false;
+                    frame_written = false;
+                }
+                frame_sat = frame_sat || out_val.sat;
+            }
+            return out_val;
+        };
+        while (written < total) {
+            int len = 0;
+            while (written + len < total && len < 256 &&
+                   beat_selected((written + len) % frame, len_samples, bins)) {
+                len++;
+                if (bfp_traits<T>::enabled && (written + len) % frame == 0) {
+                    break;
+                }
+            }
+
+            if (len == 0) {
+                // Unselected bin
+                take(written);
+                written++;
+            } else {
+                // Address handshake for write burst
+                AddrPayload aw_pay = create_addr_req(addr + written * bytesPerBeat, len - 1);
+                sc_time t0 = sc_time_stamp();
+                mem_write_port.aw.Push(aw_pay);
+                perf.write.stall_cycles += cycles_since(t0, perf.period) - 1;
+                perf.write.bursts++;
+                sc_time aw_done = sc_time_stamp();
+                wr_outstanding.write(1);
+
+                // Write active samples back to memory
+                for (int i = 0; i < len; ++i) {
+                    T out_val = take(written + i);
+                    // A part clamped to the beat component range saturates the frame too
+                    bool beat_sat;
+                    typename axi4<AxiCfg>::Data packed = pack_beat<AxiCfg>(out_val, beat_sat);
+                    frame_sat = frame_sat || beat_sat;
+                    WritePayload w_pay = create_write_payload(packed, i == len - 1);
+                    t0 = sc_time_stamp();
+                    mem_write_port.w.Push(w_pay);
+                    perf.write.stall_cycles += cycles_since(t0, perf.period) - 1;
+                    perf.write.beats++;
+                }
+
+                // Receive write response
+                mem_write_port.b.Pop();
+                perf.write.latency.add(cycles_since(aw_done, perf.period));
+                wr_outstanding.write(0);
+
+                written += len;
+                frame_written = true;
+            }
+
+            if constexpr (bfp_traits<T>::enabled) {
+                if ((written % frame == 0 || written == total) && frame_written) {
+                    typename axi4<AxiCfg>::Addr frame_addr = addr + ((written - 1) / frame) * frame * bytesPerBeat;
+                    write_word(exponent_addr(frame_addr, frame), pack_exponent<AxiCfg>(frame_exp, frame_sat));
+                    frame_written = false;
+                }
+            }
+        }
+        
+        // Discard trailing flush outputs
+        drop_outputs(discard);
+    }
+
+    // Take count FFT output beats and drop them
+    void drop_outputs(int count) {
+        for (int i = 0; i < count; ++i) {
+            fft_in.Pop();
+        }
+    }
+
+    // Write the total output beats of an overlap-save convolution to addr: every frame of
+    // frame beats starts with frame - keep wrapped-around beats, which are dropped, and the
+    // keep beats after them continue the output. The rest of the last frame and discard
+    // flush beats are dropped.
+    void write_overlap_save(typename axi4<AxiCfg>::Addr addr, int total, int discard, int frame, int keep) {
+        for (int done = 0; done < total; done += keep) {
+            int beats = (total - done < keep) ? total - done : keep;
+            drop_outputs(frame - keep);
+            write_samples(addr + done * bytesPerBeat, beats, keep - beats, frame);
+        }
+        drop_outputs(discard);
+    }
+
+    // Write total beats as write_samples does, the frames of frame beats pitch bytes apart
+    // (0: contiguous)
+    void write_frames(typename axi4<AxiCfg>::Addr addr, int total, int discard, int frame, int pitch,
+                      BinRange bins = BinRange{ 0, 0 }) {
+        if (pitch == 0 || pitch == frame * bytesPerBeat || total == 0) {
+            write_samples(addr, total, discard, frame, bins);
+            return;
+        }
+        for (int done = 0; done < total; done += frame) {
+            int beats = (total - done < frame) ? total - done : frame;
+            write_samples(addr, beats, (done + beats == total) ? discard : 0, frame, bins);
+            addr += pitch;
+        }
+    }
+
+    // Drive busy and account its cycles for the core utilization
+    void set_busy(bool b) {
+        busy.write(b);
+        perf.set_busy(b);
+    }
+
     // AXI write data streamer
     void write_thread() {
         mem_write_port.aw.Reset();
         mem_write_port.w.Reset();
         mem_write_port.b.Reset();
         fft_in.Reset();
-        busy.write(false);
+        write_active = false;
+        set_busy(false);
+        wr_outstanding.write(0);
         wait();
         
         while (true) {
-            while (!start.read()) {
+            if (queued_mode()) {
+                set_busy(stream_jobs > 0);
+                if (frame_tags.empty()) {
+                    wait();
+                } else if (!frame_tags.front().flush) {
+                    FrameTag tag = frame_tags.front();
+                    frame_tags.pop_front();
+                    write_active = true;
+                    if (tag.keep > 0) {
+                        write_overlap_save(tag.dst, tag.samples, tag.discard, tag.frame, tag.keep);
+                    } else {
+                        write_frames(tag.dst, tag.samples, tag.discard, tag.frame, tag.pitch, tag.bins);
+                    }
+                    write_active = false;
+                    if (tag.last) {
+                        stream_jobs--;
+                    }
+                } else {
+                    // Flush frame outputs only appear once the next job pushes them out
+                    T dropped;
+                    if (fft_in.PopNB(dropped) && --frame_tags.front().discard <= 0) {
+                        frame_tags.pop_front();
+                    }
+                    wait();
+                }
+                continue;
+            }
+            
+            if (!start.read()) {
                 wait();
+                continue;
             }
-            busy.write(true);
+            set_busy(true);
             
-            int total = num_samples.read();
-            if (total > 0) {
-                int latency = calc_pipeline_latency();
-                int total_inputs = ((total + latency + N_SIZE - 1) / N_SIZE) * N_SIZE;
-                int flush_outputs_to_discard = total_inputs - total;
-                typename axi4<AxiCfg>::Addr addr = base_addr.read() + N_SIZE * bytesPerBeat;
-                
-                int remaining = total;
-                while (remaining > 0) {
-                    int len = (remaining > 256) ? 256 : remaining;
-                    
-                    // Address handshake for write burst
-                    AddrPayload aw_pay = create_addr_req(addr, len - 1);
-                    mem_write_port.aw.Push(aw_pay);
-                    
-                    // Write active samples back to memory
-                    for (int i = 0; i < len; ++i) {
-                        complex_t out_val = fft_in.Pop();
-                        typename axi4<AxiCfg>::Data packed = pack_complex<AxiCfg>(out_val);
-                        WritePayload w_pay = create_write_payload(packed, i == len - 1);
-                        mem_write_port.w.Push(w_pay);
-                    }
-                    
-                    // Receive write response
-                    mem_write_port.b.Pop();
-                    
-                    addr += len * bytesPerBeat;
-                    remaining -= len;
-                }
-                
-                // Discard trailing flush outputs
-                for (int i = 0; i < flush_outputs_to_discard; ++i) {
-                    fft_in.Pop();
+            int total = to_beats(num_samples.read());
+            int chop = conv_hop(conv_taps.read());
+            if (total > 0 && chop > 0) {
+                int frame = FRAME_BEATS;
+                int beats = conv_frames(total, chop) * frame;
+                int total_inputs = ((beats + calc_conv_latency() + frame - 1) / frame) * frame;
+                write_overlap_save(base_addr.read() + frame * bytesPerBeat, total, total_inputs - beats, frame, chop);
+            } else if (total > 0) {
+                int len = job_len(fft_len.read());
+                int frame = frame_beats(len);
+                int hop = hop_beats(stft_hop.read(), len);
+                int beats = (hop > 0) ? stft_frames(total, hop, frame) * frame : total;
+                int latency = calc_pipeline_latency(len);
+                int total_inputs = ((beats + latency + frame - 1) / frame) * frame;
+                BinRange bins = { bin_lo.read(), bin_hi.read() };
+                if (hop > 0) {
+                    write_frames(stft_dst.read(), beats, total_inputs - beats, frame, stft_pitch.read(), bins);
+                } else {
+                    write_samples(base_addr.read() + frame * bytesPerBeat, total, total_inputs - total, frame, bins);
                 }
             }
             
-            busy.write(false);
+            set_busy(false);
             
             while (start.read()) {
                 wait();
@@ -208,31 +1037,91 @@ SC_MODULE(DMA) {
         }
     }
 
+    // Stream/descriptor mode job submission: every rising edge of start queues one job
+    void job_submit_method() {
+        if (!rst_n.read()) {
+            jobs.clear();
+            stream_jobs = 0;
+            start_prev = false;
+            return;
+        }
+        bool start_now = start.read();
+        if (queued_mode() && start_now && !start_prev) {
+            if ((int)jobs.size() < DmaCfg::jobQueueDepth) {
+                int chop = desc_mode.read() ? 0 : checked_conv_hop(conv_taps.read());
+                int len = (chop > 0) ? (int)N_SIZE : checked_len(fft_len.read());
+                DmaJob job = { base_addr.read(), num_samples.read(), desc_mode.read(), len,
+                               window.read(), checked_hop(stft_hop.read(), len), stft_dst.read(),
+                               stft_pitch.read(), BinRange{ bin_lo.read(), bin_hi.read() },
+                               checked_inverse(inverse.read()), chop, filter_addr.read() };
+                jobs.push_back(job);
+                stream_jobs++;
+            } else {
+                SC_REPORT_WARNING(name(), "Stream job queue full, submission dropped");
+            }
+        }
+        start_prev = start_now;
+    }
+
     SC_HAS_PROCESS(DMA);
     DMA(sc_module_name name) 
         : sc_module(name),
           clk("clk"),
           rst_n("rst_n"),
           start("start"),
+          stream_mode("stream_mode"),
+          desc_mode("desc_mode"),
           base_addr("base_addr"),
           num_samples("num_samples"),
+          fft_len("fft_len"),
+          active_len("active_len"),
+          window("window"),
+          active_window("active_window"),
+          stft_hop("stft_hop"),
+          stft_dst("stft_dst"),
+          stft_pitch("stft_pitch"),
+          bin_lo("bin_lo"),
+          bin_hi("bin_hi"),
+          active_bin_lo("active_bin_lo"),
+          active_bin_hi("active_bin_hi"),
+          inverse("inverse"),
+          active_inverse("active_inverse"),
+          conv_taps("conv_taps"),
+          filter_addr("filter_addr"),
+          filter_load("filter_load"),
           busy("busy"),
+          rd_outstanding("rd_outstanding"),
+          wr_outstanding("wr_outstanding"),
           mem_read_port("mem_read_port"),
           mem_write_port("mem_write_port"),
           fft_out("fft_out"),
-          fft_in("fft_in") 
+          fft_in("fft_in"),
+          prefetch_reserved(0),
+          read_next_id(0),
+          stream_jobs(0),
+          stream_flushed(true),
+          pipe_len(N_SIZE),
+          pipe_bins(BinRange{ 0, 0 }),
+          pipe_inverse(false),
+          pipe_conv(false),
+          pipe_filter(0),
+          filter_loaded(false),
+          write_active(false),
+          overlap(FRAME_BEATS, T()),
+          start_prev(false),
+          desc_fetch_pending(false),
+          desc_beats(descBeats)
     {
-        SC_THREAD(read_addr_thread);
-        sensitive << clk.pos();
-        async_reset_signal_is(rst_n, false);
-
-        SC_THREAD(read_data_thread);
+        SC_THREAD(read_thread);
         sensitive << clk.pos();
         async_reset_signal_is(rst_n, false);
 
         SC_THREAD(write_thread);
         sensitive << clk.pos();
         async_reset_signal_is(rst_n, false);
+
+        SC_METHOD(job_submit_method);
+        sensitive << clk.pos() << rst_n.neg();
     }
 };
 
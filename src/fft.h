@@ -1,9 +1,16 @@
 /*
  * fft.h
  *
- * Implementation of the N-point radix-2 DIF FFT cascade.
- * Uses a recursive template mechanism to instantiate log2(N) connected stages in series,
- * with a specialization for N=1 to bypass computation.
+ * Implementation of the N-point DIF FFT cascade.
+ * A recursive template holds the log2(N) connected stages in series by value, either as
+ * radix-2 stages or as radix-2^2 stage pairs (RADIX=4), with a specialization for N=1 to
+ * bypass computation. The stages, their channels and their fixed-size delay lines are
+ * built as one object at elaboration. Twiddles come from the shared TwiddleRom of size N.
+ * The optional fft_len input selects a shorter power-of-two length at run time on the
+ * radix-2 cascade: the stages larger than it are bypassed. The optional pruning inputs
+ * (radix-2 as well) let the stages skip butterflies on zero operands or feeding no bin of
+ * [bin_lo, bin_hi). The optional inverse input (radix-2) turns the cascade into the inverse
+ * transform, scaled by 1/N.
  */
 
 #ifndef FFT_H
@@ -11,77 +18,160 @@
 
 #include "fft_types.h"
 #include "stage.h"
+#include "stage_r22.h"
 #include <connections/connections.h>
 #include <vector>
 #include <string>
 
 using namespace Connections;
 
-// Recursive template to instantiate FFT stages
-template<int STAGE_SIZE, int NUM_MULT, int NUM_ADD>
-struct StageInstantiator {
-    static void instantiate(std::vector<StageBase*>& stages,
-                            std::vector<Combinational<complex_t>*>& stage_signals,
-                            int index,
-                            sc_in<bool>& clk,
-                            sc_in<bool>& rst_n) {
-        std::string s_name = "stage_" + std::to_string(index);
-        auto* stage = new Stage<STAGE_SIZE>(s_name.c_str(), NUM_MULT, NUM_ADD);
-        stage->clk(clk);
-        stage->rst_n(rst_n);
-        stages.push_back(stage);
-        
-        if (STAGE_SIZE > 2) {
-            std::string sig_name = "sig_stage_" + std::to_string(index);
-            auto* chan = new Combinational<complex_t>(sig_name.c_str());
-            stage_signals.push_back(chan);
-            
-            stage->out_data(*chan);
-            
-            // Instantiate the next stage recursively
-            StageInstantiator<STAGE_SIZE / 2, NUM_MULT, NUM_ADD>::instantiate(
-                stages, stage_signals, index + 1, clk, rst_n
-            );
-        }
+// Name of element index of the cascade (short enough to stay in the small-string buffer)
+inline std::string cascade_name(const char* prefix, int index) {
+    return prefix + std::to_string(index);
+}
+
+// Stages and inter-stage channels of the cascade from stage size STAGE_SIZE on, held by
+// value in pipeline order: the cascade is one object with every delay line inside it.
+// Bit i of SCALE_MASK enables divide-by-2 scaling in stage i. A radix-2 stage and the
+// stages after it:
+template<int STAGE_SIZE, int NUM_MULT, int NUM_ADD, int RADIX = 2, typename T = complex_t,
+         unsigned SCALE_MASK = 0, int INDEX = 0, bool PAIR = (RADIX == 4 && STAGE_SIZE >= 4)>
+struct StageChain {
+    Stage<STAGE_SIZE, T> stage;
+    Combinational<T> chan;
+    StageChain<STAGE_SIZE / 2, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, INDEX + 1> next;
+
+    StageChain(sc_in<bool>& clk, sc_in<bool>& rst_n, int rom_n) :
+        stage(cascade_name("stage_", INDEX).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> INDEX) & 1u, rom_n),
+        chan(cascade_name("sig_stage_", INDEX).c_str()),
+        next(clk, rst_n, rom_n)
+    {
+        stage.clk(clk);
+        stage.rst_n(rst_n);
+        stage.out_data(chan);
+    }
+
+    void collect(std::vector<StageBase<T>*>& stages, std::vector<Combinational<T>*>& chans) {
+        stages.push_back(&stage);
+        chans.push_back(&chan);
+        next.collect(stages, chans);
+    }
+};
+
+// The last radix-2 stage (size 2)
+template<int NUM_MULT, int NUM_ADD, int RADIX, typename T, unsigned SCALE_MASK, int INDEX>
+struct StageChain<2, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, INDEX, false> {
+    Stage<2, T> stage;
+
+    StageChain(sc_in<bool>& clk, sc_in<bool>& rst_n, int rom_n) :
+        stage(cascade_name("stage_", INDEX).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> INDEX) & 1u, rom_n)
+    {
+        stage.clk(clk);
+        stage.rst_n(rst_n);
+    }
+
+    void collect(std::vector<StageBase<T>*>& stages, std::vector<Combinational<T>*>&) {
+        stages.push_back(&stage);
     }
 };
 
-// Recursion base case (FFT stage of size 2)
-template<int NUM_MULT, int NUM_ADD>
-struct StageInstantiator<2, NUM_MULT, NUM_ADD> {
-    static void instantiate(std::vector<StageBase*>& stages,
-                            std::vector<Combinational<complex_t>*>& stage_signals,
-                            int index,
-                            sc_in<bool>& clk,
-                            sc_in<bool>& rst_n) {
-        std::string s_name = "stage_" + std::to_string(index);
-        auto* stage = new Stage<2>(s_name.c_str(), NUM_MULT, NUM_ADD);
-        stage->clk(clk);
-        stage->rst_n(rst_n);
-        stages.push_back(stage);
+// A radix-2^2 pair covering stage sizes STAGE_SIZE and STAGE_SIZE/2, and the stages after it
+template<int STAGE_SIZE, int NUM_MULT, int NUM_ADD, int RADIX, typename T, unsigned SCALE_MASK, int INDEX>
+struct StageChain<STAGE_SIZE, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, INDEX, true> {
+    StageR22I<STAGE_SIZE, T> stage1;
+    Combinational<T> pair_chan;
+    StageR22II<STAGE_SIZE, T> stage2;
+    Combinational<T> chan;
+    StageChain<STAGE_SIZE / 4, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, INDEX + 2> next;
+
+    StageChain(sc_in<bool>& clk, sc_in<bool>& rst_n, int rom_n) :
+        stage1(cascade_name("stage_", INDEX).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> INDEX) & 1u),
+        pair_chan(cascade_name("sig_stage_", INDEX).c_str()),
+        stage2(cascade_name("stage_", INDEX + 1).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> (INDEX + 1)) & 1u, rom_n),
+        chan(cascade_name("sig_stage_", INDEX + 1).c_str()),
+        next(clk, rst_n, rom_n)
+    {
+        stage1.clk(clk);
+        stage1.rst_n(rst_n);
+        stage1.out_data(pair_chan);
+        stage2.clk(clk);
+        stage2.rst_n(rst_n);
+        stage2.out_data(chan);
+    }
+
+    void collect(std::vector<StageBase<T>*>& stages, std::vector<Combinational<T>*>& chans) {
+        stages.push_back(&stage1);
+        chans.push_back(&pair_chan);
+        stages.push_back(&stage2);
+        chans.push_back(&chan);
+        next.collect(stages, chans);
+    }
+};
+
+// The last radix-2^2 pair (size 4)
+template<int NUM_MULT, int NUM_ADD, int RADIX, typename T, unsigned SCALE_MASK, int INDEX>
+struct StageChain<4, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, INDEX, true> {
+    StageR22I<4, T> stage1;
+    Combinational<T> pair_chan;
+    StageR22II<4, T> stage2;
+
+    StageChain(sc_in<bool>& clk, sc_in<bool>& rst_n, int rom_n) :
+        stage1(cascade_name("stage_", INDEX).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> INDEX) & 1u),
+        pair_chan(cascade_name("sig_stage_", INDEX).c_str()),
+        stage2(cascade_name("stage_", INDEX + 1).c_str(), NUM_MULT, NUM_ADD, (SCALE_MASK >> (INDEX + 1)) & 1u, rom_n)
+    {
+        stage1.clk(clk);
+        stage1.rst_n(rst_n);
+        stage1.out_data(pair_chan);
+        stage2.clk(clk);
+        stage2.rst_n(rst_n);
+    }
+
+    void collect(std::vector<StageBase<T>*>& stages, std::vector<Combinational<T>*>& chans) {
+        stages.push_back(&stage1);
+        chans.push_back(&pair_chan);
+        stages.push_back(&stage2);
     }
 };
 
-// N-point FFT processor
-template<int N, int NUM_MULT=4, int NUM_ADD=6>
+// N-point FFT processor (RADIX=2: radix-2 SDF, RADIX=4: radix-2^2 SDF)
+// operating on samples of type T, with per-stage scaling selected by SCALE_MASK
+template<int N, int NUM_MULT=4, int NUM_ADD=6, int RADIX=2, typename T=complex_t, unsigned SCALE_MASK=0>
 SC_MODULE(FFT) {
     sc_in<bool> clk;
     sc_in<bool> rst_n;
     
-    In<complex_t> in_data;
-    Out<complex_t> out_data;
+    In<T> in_data;
+    Out<T> out_data;
+
+    // Run-time FFT length (radix-2 only; unbound: N)
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> fft_len;
+
+    // Pruning of the stages (radix-2 only; unbound: off)
+    sc_port<sc_signal_in_if<bool>, 1, SC_ZERO_OR_MORE_BOUND> prune_zeros;
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> bin_lo;
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> bin_hi;
+
+    // Inverse transform (radix-2 only; unbound: forward)
+    sc_port<sc_signal_in_if<bool>, 1, SC_ZERO_OR_MORE_BOUND> inverse;
     
-    std::vector<StageBase*> stages;
-    std::vector<Combinational<complex_t>*> stage_signals;
+    StageChain<N, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK> chain;
+    std::vector<StageBase<T>*> stages;         // Stages of the chain in pipeline order
+    std::vector<Combinational<T>*> stage_signals; // Channel after each stage but the last
     
     SC_CTOR(FFT)
         : clk("clk"),
           rst_n("rst_n"),
           in_data("in_data"),
-          out_data("out_data")
+          out_data("out_data"),
+          fft_len("fft_len"),
+          prune_zeros("prune_zeros"),
+          bin_lo("bin_lo"),
+          bin_hi("bin_hi"),
+          inverse("inverse"),
+          chain(clk, rst_n, N) // All stages index the shared N-point twiddle ROM
     {
-        // Instantiate stages
-        StageInstantiator<N, NUM_MULT, NUM_ADD>::instantiate(stages, stage_signals, 0, clk, rst_n);
+        chain.collect(stages, stage_signals);
         
         // Connect stages in series
         for (size_t i = 0; i < stages.size(); ++i) {
@@ -90,29 +180,60 @@ SC_MODULE(FFT) {
             } else {
                 stages[i]->get_in_port()(*stage_signals[i-1]);
             }
+            if (RADIX == 2) {
+                stages[i]->fft_len(fft_len);
+                stages[i]->prune_zeros(prune_zeros);
+                stages[i]->bin_lo(bin_lo);
+                stages[i]->bin_hi(bin_hi);
+                stages[i]->inverse(inverse);
+            }
         }
         stages.back()->get_out_port()(out_data);
     }
     
-    ~FFT() {
+    // Counters of every stage in pipeline order
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        w.StartArray();
+        for (auto* stage : stages) {
+            stage->perf.write_json(w, stage->basename());
+        }
+        w.EndArray();
+    }
+
+    // Stage with the highest utilization: it sets the pace of the pipeline
+    NamedCounters busiest_stage() const {
+        const StageBase<T>* busiest = stages.front();
         for (auto* stage : stages) {
-            delete stage;
+            if (stage->perf.utilization() > busiest->perf.utilization()) {
+                busiest = stage;
+            }
         }
-        for (auto* sig : stage_signals) {
-            delete sig;
+        NamedCounters b = {busiest->basename(), &busiest->perf};
+        return b;
+    }
+
+    // Butterflies the stages pruned (zero operands or unselected bins)
+    unsigned long pruned_butterflies() const {
+        unsigned long pruned = 0;
+        for (auto* stage : stages) {
+            pruned += stage->perf.pruned_butterflies;
         }
+        return pruned;
     }
 };
 
 // Specialization for N=1 bypass
-template<int NUM_MULT, int NUM_ADD>
-class FFT<1, NUM_MULT, NUM_ADD> : public sc_module {
+template<int NUM_MULT, int NUM_ADD, int RADIX, typename T, unsigned SCALE_MASK>
+class FFT<1, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK> : public sc_module {
 public:
     sc_in<bool> clk;
     sc_in<bool> rst_n;
     
-    In<complex_t> in_data;
-    Out<complex_t> out_data;
+    In<T> in_data;
+    Out<T> out_data;
+
+    StreamCounters perf;
     
     SC_HAS_PROCESS(FFT);
     FFT(sc_module_name name) : 
@@ -130,13 +251,30 @@ public:
     void bypass_thread() {
         in_data.Reset();
         out_data.Reset();
+        perf.start(bound_clock_period(clk));
         wait();
         
         while (true) {
-            complex_t val = in_data.Pop();
-            out_data.Push(val);
+            T val = perf.pop(in_data);
+            perf.push(out_data, val);
         }
     }
+
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        w.StartArray();
+        perf.write_json(w, "bypass");
+        w.EndArray();
+    }
+
+    NamedCounters busiest_stage() const {
+        NamedCounters b = {"bypass", &perf};
+        return b;
+    }
+
+    unsigned long pruned_butterflies() const {
+        return 0;
+    }
 };
 
 #endif  // FFT_H
@@ -0,0 +1,232 @@
+/*
+ * fft_ref.h
+ *
+ * Host-side O(N log N) reference FFT for verification and fast models.
+ * Works in place on split real/imaginary (SoA) arrays with radix-2^2 DIF passes (a trailing
+ * radix-2 pass when log2(N) is odd), so the output is in the bit-reversed order of the
+ * hardware pipeline. Twiddles are read once from the shared TwiddleRom into contiguous
+ * per-pass tables, and the butterflies run on AVX2 (4 doubles) or NEON (2 doubles) vectors
+ * when the compiler targets them (SIMD=1 builds), with a scalar fallback.
+ */
+
+#ifndef FFT_REF_H
+#define FFT_REF_H
+
+#include "fft_types.h"
+#include "twiddle_rom.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace fft_ref {
+
+// Scalar lane (fallback and loop tails)
+struct ScalarVec {
+    enum { width = 1 };
+    double v;
+    static ScalarVec load(const double* p) { return { *p }; }
+    void store(double* p) const { *p = v; }
+    friend ScalarVec operator+(ScalarVec a, ScalarVec b) { return { a.v + b.v }; }
+    friend ScalarVec operator-(ScalarVec a, ScalarVec b) { return { a.v - b.v }; }
+    friend ScalarVec operator*(ScalarVec a, ScalarVec b) { return { a.v * b.v }; }
+};
+
+#if defined(__AVX2__)
+struct SimdVec {
+    enum { width = 4 };
+    __m256d v;
+    static SimdVec load(const double* p) { return { _mm256_loadu_pd(p) }; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    friend SimdVec operator+(SimdVec a, SimdVec b) { return { _mm256_add_pd(a.v, b.v) }; }
+    friend SimdVec operator-(SimdVec a, SimdVec b) { return { _mm256_sub_pd(a.v, b.v) }; }
+    friend SimdVec operator*(SimdVec a, SimdVec b) { return { _mm256_mul_pd(a.v, b.v) }; }
+};
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+struct SimdVec {
+    enum { width = 2 };
+    float64x2_t v;
+    static SimdVec load(const double* p) { return { vld1q_f64(p) }; }
+    void store(double* p) const { vst1q_f64(p, v); }
+    friend SimdVec operator+(SimdVec a, SimdVec b) { return { vaddq_f64(a.v, b.v) }; }
+    friend SimdVec operator-(SimdVec a, SimdVec b) { return { vsubq_f64(a.v, b.v) }; }
+    friend SimdVec operator*(SimdVec a, SimdVec b) { return { vmulq_f64(a.v, b.v) }; }
+};
+#else
+typedef ScalarVec SimdVec;
+#endif
+
+// (ar + j*ai) * (br + j*bi) stored back into ar/ai
+template<typename V>
+inline void complex_mul(V& ar, V& ai, V br, V bi) {
+    V r = ar * br - ai * bi;
+    ai = ar * bi + ai * br;
+    ar = r;
+}
+
+}  // namespace fft_ref
+
+// Reference transform of one size, reusable across any number of frames, with the butterflies
+// on Vec (fft_ref::SimdVec, or fft_ref::ScalarVec to check the vector code against)
+template<typename Vec = fft_ref::SimdVec>
+class BasicFftReference {
+public:
+    explicit BasicFftReference(int n) : n(n) {
+        const TwiddleRom& rom = TwiddleRom::instance(n);
+        for (int m = n; m >= 2; m /= 4) {
+            Pass pass;
+            pass.m = m;
+            pass.radix4 = (m >= 4);
+            pass.offset = (int)tw_re.size();
+            // W_m^(e*k) for e = 1..3 (radix-2^2) or e = 1 (radix-2), k < m/4 (m/2)
+            int count = pass.radix4 ? m / 4 : m / 2;
+            int stride = rom.size() / m;
+            for (int e = 1; e <= (pass.radix4 ? 3 : 1); ++e) {
+                for (int k = 0; k < count; ++k) {
+                    complex_t w = rom.lookup<complex_t>(e * k * stride);
+                    tw_re.push_back(w.real);
+                    tw_im.push_back(w.imag);
+                }
+            }
+            passes.push_back(pass);
+            if (!pass.radix4) {
+                break;
+            }
+        }
+    }
+
+    int size() const { return n; }
+
+    // In-place transform of one frame; the output is bit-reversed
+    void transform(double* re, double* im) const {
+        for (const Pass& pass : passes) {
+            for (int b = 0; b < n; b += pass.m) {
+                if (pass.radix4) {
+                    radix4_block(pass, re + b, im + b);
+                } else {
+                    radix2_block(pass, re + b, im + b);
+                }
+            }
+        }
+    }
+
+    // Spectra of consecutive frames (input zero padded to whole frames) in the output order
+    // of the pipeline, bit-reversed or natural, multiplied by scale (SCALE_MASK growth control).
+    // The inverse transform runs as the conjugate of the transform of the conjugated input;
+    // its 1/N is left to scale.
+    std::vector<complex_t> frames(const std::vector<complex_t>& input, bool natural_order = false,
+                                  double scale = 1.0, bool inverse = false) const {
+        int total = (((int)input.size() + n - 1) / n) * n;
+        double sign = inverse ? -1.0 : 1.0;
+        std::vector<double> re(total, 0.0);
+        std::vector<double> im(total, 0.0);
+        for (size_t i = 0; i < input.size(); ++i) {
+            re[i] = input[i].real;
+            im[i] = sign * input[i].imag;
+        }
+
+        std::vector<complex_t> output(total);
+        for (int f = 0; f < total; f += n) {
+            transform(&re[f], &im[f]);
+            for (int i = 0; i < n; ++i) {
+                int src = natural_order ? reverse_bits(i) : i;
+                output[f + i] = complex_t(re[f + src] * scale, sign * im[f + src] * scale);
+            }
+        }
+        return output;
+    }
+
+    int reverse_bits(int index) const {
+        int rev = 0;
+        for (int b = 1; b < n; b <<= 1) {
+            rev = (rev << 1) | ((index & b) ? 1 : 0);
+        }
+        return rev;
+    }
+
+private:
+    struct Pass {
+        int m;       // Block size
+        bool radix4; // Radix-2^2 pass (two stages), otherwise a single radix-2 stage
+        int offset;  // First twiddle of the pass
+    };
+
+    int n;
+    std::vector<Pass> passes;
+    std::vector<double> tw_re;
+    std::vector<double> tw_im;
+
+    // Radix-2^2 butterflies on lanes [k, k + V::width) of one block of m samples:
+    // x0 = a+b+c+d, x1 = (a-b+c-d) W^2k, x2 = (a-c - j(b-d)) W^k, x3 = (a-c + j(b-d)) W^3k
+    template<typename V>
+    void radix4_lanes(const Pass& pass, double* re, double* im, int k) const {
+        int q = pass.m / 4;
+        const double* w_re = &tw_re[pass.offset];
+        const double* w_im = &tw_im[pass.offset];
+        V ar = V::load(re + k), ai = V::load(im + k);
+        V br = V::load(re + k + q), bi = V::load(im + k + q);
+        V cr = V::load(re + k + 2 * q), ci = V::load(im + k + 2 * q);
+        V dr = V::load(re + k + 3 * q), di = V::load(im + k + 3 * q);
+
+        V s0r = ar + cr, s0i = ai + ci;
+        V d0r = ar - cr, d0i = ai - ci;
+        V s1r = br + dr, s1i = bi + di;
+        V d1r = br - dr, d1i = bi - di;
+
+        V x0r = s0r + s1r, x0i = s0i + s1i;
+        V x1r = s0r - s1r, x1i = s0i - s1i;
+        V x2r = d0r + d1i, x2i = d0i - d1r; // (a-c) - j(b-d)
+        V x3r = d0r - d1i, x3i = d0i + d1r; // (a-c) + j(b-d)
+
+        complex_mul(x1r, x1i, V::load(w_re + q + k), V::load(w_im + q + k));
+        complex_mul(x2r, x2i, V::load(w_re + k), V::load(w_im + k));
+        complex_mul(x3r, x3i, V::load(w_re + 2 * q + k), V::load(w_im + 2 * q + k));
+
+        x0r.store(re + k);         x0i.store(im + k);
+        x1r.store(re + k + q);     x1i.store(im + k + q);
+        x2r.store(re + k + 2 * q); x2i.store(im + k + 2 * q);
+        x3r.store(re + k + 3 * q); x3i.store(im + k + 3 * q);
+    }
+
+    template<typename V>
+    void radix2_lanes(const Pass& pass, double* re, double* im, int k) const {
+        int h = pass.m / 2;
+        V ar = V::load(re + k), ai = V::load(im + k);
+        V br = V::load(re + k + h), bi = V::load(im + k + h);
+        V sr = ar + br, si = ai + bi;
+        V dr = ar - br, di = ai - bi;
+        complex_mul(dr, di, V::load(&tw_re[pass.offset + k]), V::load(&tw_im[pass.offset + k]));
+        sr.store(re + k);     si.store(im + k);
+        dr.store(re + k + h); di.store(im + k + h);
+    }
+
+    void radix4_block(const Pass& pass, double* re, double* im) const {
+        int q = pass.m / 4;
+        int k = 0;
+        for (; k + Vec::width <= q; k += Vec::width) {
+            radix4_lanes<Vec>(pass, re, im, k);
+        }
+        for (; k < q; ++k) {
+            radix4_lanes<fft_ref::ScalarVec>(pass, re, im, k);
+        }
+    }
+
+    void radix2_block(const Pass& pass, double* re, double* im) const {
+        int h = pass.m / 2;
+        int k = 0;
+        for (; k + Vec::width <= h; k += Vec::width) {
+            radix2_lanes<Vec>(pass, re, im, k);
+        }
+        for (; k < h; ++k) {
+            radix2_lanes<fft_ref::ScalarVec>(pass, re, im, k);
+        }
+    }
+};
+
+typedef BasicFftReference<> FftReference;
+
+#endif  // FFT_REF_H
@@ -4,15 +4,24 @@
  * Complex number type definitions, math operators, and AXI4 stream packing/unpacking helpers.
  *
  * Defines the complex_t structure with basic arithmetic operators for complex math,
- * and provides template helpers to serialize/deserialize complex data over AXI4 channels.
+ * the complex_fixed_t<W, I> fixed-point alternative for bit-accurate datapaths, the
+ * complex_bfp_t<W, I> block-floating-point mantissa type with its per-frame exponent,
+ * the sample_vec_t<T, LANES> group of a P-parallel datapath, and provides template helpers
+ * to serialize/deserialize complex data over AXI4 channels, one or several samples per beat.
  */
 
 #ifndef FFT_TYPES_H
 #define FFT_TYPES_H
 
 #include <systemc.h>
+#include <cmath>
 #include <complex>
+#include <ac_fixed.h>
 #include <auto_gen_fields.h>
+#include <nvhls_marshaller.h>
+#include <cstdint>
+#include <string>
+#include <type_traits>
 
 using namespace sc_core;
 
@@ -43,49 +52,475 @@ struct complex_t {
         return std::sqrt(real * real + imag * imag);
     }
 
+    // Multiplication by -j (real/imag swap)
+    complex_t mul_neg_j() const {
+        return complex_t(imag, -real);
+    }
+
+    complex_t conj() const {
+        return complex_t(real, -imag);
+    }
+
+    complex_t to_complex() const {
+        return *this;
+    }
+
     // Auto-generation macro for tracing fields (double fields are marked V2)
     AUTO_GEN_FIELD_METHODS_V2(complex_t, (real, imag))
 };
 
+// Fixed-point complex number with W total bits and I integer bits (including sign).
+// Results are rounded and saturated back to <W, I> after every operation.
+template<int W, int I>
+struct complex_fixed_t {
+    typedef ac_fixed<W, I, true, AC_RND, AC_SAT> value_t;
+
+    static const int word_width = W;
+    static const int int_width = I;
+
+    value_t real;
+    value_t imag;
+
+    complex_fixed_t(double x = 0.0, double y = 0.0) : real(x), imag(y) {}
+    explicit complex_fixed_t(const complex_t& c) : real(c.real), imag(c.imag) {}
+
+    complex_fixed_t operator + (const complex_fixed_t& b) const {
+        complex_fixed_t res;
+        res.real = real + b.real;
+        res.imag = imag + b.imag;
+        return res;
+    }
+
+    complex_fixed_t operator - (const complex_fixed_t& b) const {
+        complex_fixed_t res;
+        res.real = real - b.real;
+        res.imag = imag - b.imag;
+        return res;
+    }
+
+    complex_fixed_t operator * (const complex_fixed_t& b) const {
+        complex_fixed_t res;
+        res.real = real * b.real - imag * b.imag;
+        res.imag = real * b.imag + imag * b.real;
+        return res;
+    }
+
+    double magnitude() const {
+        return to_complex().magnitude();
+    }
+
+    // Multiplication by -j (real/imag swap)
+    complex_fixed_t mul_neg_j() const {
+        complex_fixed_t res;
+        res.real = imag;
+        res.imag = -real;
+        return res;
+    }
+
+    complex_fixed_t conj() const {
+        complex_fixed_t res;
+        res.real = real;
+        res.imag = -imag;
+        return res;
+    }
+
+    complex_t to_complex() const {
+        return complex_t(real.to_double(), imag.to_double());
+    }
+
+    AUTO_GEN_FIELD_METHODS(complex_fixed_t, (real, imag))
+};
+
+// Block-floating-point complex sample: a <W, I> fixed-point mantissa pair tagged with the
+// exponent of its frame (divide-by-2 steps applied so far, X = M * 2^exp) and a sticky flag
+// set once a result saturated. Memory integers of up to W bits load exactly, with the
+// mantissa LSB at integer 1 (a shift by W - I); the W - I fraction bits serve the twiddles.
+template<int W, int I>
+struct complex_bfp_t {
+    typedef ac_fixed<W, I, true, AC_RND, AC_SAT> value_t;
+
+    static const int word_width = W;
+    static const int int_width = I;
+    static const int exp_width = 6;
+
+    value_t real;
+    value_t imag;
+    sc_uint<exp_width> exp;
+    bool sat;
+
+    complex_bfp_t(double x = 0.0, double y = 0.0) : real(x), imag(y), exp(0), sat(false) {}
+    explicit complex_bfp_t(const complex_t& c) :
+        real(std::ldexp(c.real, I - W)), imag(std::ldexp(c.imag, I - W)), exp(0), sat(false) {}
+
+    // Round and saturate a full-precision result, flagging saturation
+    template<typename Wide>
+    static value_t fit(const Wide& v, bool& saturated) {
+        value_t hi, lo;
+        hi.template set_val<AC_VAL_MAX>();
+        lo.template set_val<AC_VAL_MIN>();
+        saturated = saturated || v > hi || v < lo;
+        return value_t(v);
+    }
+
+    // Sums of two samples of one frame keep its exponent
+    complex_bfp_t operator + (const complex_bfp_t& b) const {
+        complex_bfp_t res = *this;
+        res.sat = sat || b.sat;
+        res.real = fit(real + b.real, res.sat);
+        res.imag = fit(imag + b.imag, res.sat);
+        return res;
+    }
+
+    complex_bfp_t operator - (const complex_bfp_t& b) const {
+        complex_bfp_t res = *this;
+        res.sat = sat || b.sat;
+        res.real = fit(real - b.real, res.sat);
+        res.imag = fit(imag - b.imag, res.sat);
+        return res;
+    }
+
+    complex_bfp_t operator * (const complex_bfp_t& b) const {
+        complex_bfp_t res = *this;
+        res.exp = exp + b.exp;
+        res.sat = sat || b.sat;
+        res.real = fit(real * b.real - imag * b.imag, res.sat);
+        res.imag = fit(real * b.imag + imag * b.real, res.sat);
+        return res;
+    }
+
+    // Redundant sign bits of the larger component: doublings that fit without saturating
+    int headroom_bits() const {
+        int h = 0;
+        value_t lim = std::ldexp(1.0, I - 2);
+        while (h < W - 1 && real < lim && !(real < -lim) && imag < lim && !(imag < -lim)) {
+            h++;
+            lim = std::ldexp(1.0, I - 2 - h);
+        }
+        return h;
+    }
+
+    double magnitude() const {
+        return to_complex().magnitude();
+    }
+
+    // Mantissas in the memory integer scale (the frame exponent is not applied)
+    complex_t to_complex() const {
+        return complex_t(std::ldexp(real.to_double(), W - I), std::ldexp(imag.to_double(), W - I));
+    }
+
+    AUTO_GEN_FIELD_METHODS(complex_bfp_t, (real, imag, exp, sat))
+};
+
+// Block-floating-point capabilities of a datapath type
+template<typename T>
+struct bfp_traits {
+    static const bool enabled = false;
+};
+
+template<int W, int I>
+struct bfp_traits<complex_bfp_t<W, I>> {
+    static const bool enabled = true;
+};
+
+// Radix-2 butterfly with optional divide-by-2 growth control
+inline void butterfly(const complex_t& a, const complex_t& b, bool scale,
+                      complex_t& sum, complex_t& diff) {
+    sum = a + b;
+    diff = a - b;
+    if (scale) {
+        sum = complex_t(sum.real * 0.5, sum.imag * 0.5);
+        diff = complex_t(diff.real * 0.5, diff.imag * 0.5);
+    }
+}
+
+// Fixed-point butterfly: additions keep one guard bit so that scaling never overflows
+template<int W, int I>
+inline void butterfly(const complex_fixed_t<W, I>& a, const complex_fixed_t<W, I>& b, bool scale,
+                      complex_fixed_t<W, I>& sum, complex_fixed_t<W, I>& diff) {
+    ac_fixed<W + 1, I + 1, true> sr = a.real + b.real;
+    ac_fixed<W + 1, I + 1, true> si = a.imag + b.imag;
+    ac_fixed<W + 1, I + 1, true> dr = a.real - b.real;
+    ac_fixed<W + 1, I + 1, true> di = a.imag - b.imag;
+    if (scale) {
+        sr >>= 1;
+        si >>= 1;
+        dr >>= 1;
+        di >>= 1;
+    }
+    sum.real = sr;
+    sum.imag = si;
+    diff.real = dr;
+    diff.imag = di;
+}
+
+// Block-floating-point butterfly: scaling adds one to the frame exponent, unscaled results
+// that leave the mantissa range saturate and set the flag
+template<int W, int I>
+inline void butterfly(const complex_bfp_t<W, I>& a, const complex_bfp_t<W, I>& b, bool scale,
+                      complex_bfp_t<W, I>& sum, complex_bfp_t<W, I>& diff) {
+    typedef complex_bfp_t<W, I> bfp_t;
+    ac_fixed<W + 1, I + 1, true> sr = a.real + b.real;
+    ac_fixed<W + 1, I + 1, true> si = a.imag + b.imag;
+    ac_fixed<W + 1, I + 1, true> dr = a.real - b.real;
+    ac_fixed<W + 1, I + 1, true> di = a.imag - b.imag;
+    if (scale) {
+        sr >>= 1;
+        si >>= 1;
+        dr >>= 1;
+        di >>= 1;
+    }
+    bool sat = a.sat || b.sat;
+    sum.real = bfp_t::fit(sr, sat);
+    sum.imag = bfp_t::fit(si, sat);
+    diff.real = bfp_t::fit(dr, sat);
+    diff.imag = bfp_t::fit(di, sat);
+    sum.exp = a.exp + (scale ? 1 : 0);
+    diff.exp = sum.exp;
+    sum.sat = sat;
+    diff.sat = sat;
+}
+
+// Real and imaginary parts scaled by separate real coefficients (window multiply)
+inline complex_t scale_parts(const complex_t& a, double cr, double ci) {
+    return complex_t(a.real * cr, a.imag * ci);
+}
+
+// Fixed-point coefficients are quantized to the sample format
+template<int W, int I>
+inline complex_fixed_t<W, I> scale_parts(const complex_fixed_t<W, I>& a, double cr, double ci) {
+    typedef typename complex_fixed_t<W, I>::value_t value_t;
+    complex_fixed_t<W, I> res;
+    res.real = a.real * value_t(cr);
+    res.imag = a.imag * value_t(ci);
+    return res;
+}
+
+// Block-floating-point mantissas are scaled within the frame exponent
+template<int W, int I>
+inline complex_bfp_t<W, I> scale_parts(const complex_bfp_t<W, I>& a, double cr, double ci) {
+    typedef complex_bfp_t<W, I> bfp_t;
+    typedef typename bfp_t::value_t value_t;
+    bfp_t res = a;
+    res.real = bfp_t::fit(a.real * value_t(cr), res.sat);
+    res.imag = bfp_t::fit(a.imag * value_t(ci), res.sat);
+    return res;
+}
+
+// Both parts exactly zero (butterflies on zero operands are pruned)
+template<typename T>
+inline bool is_zero(const T& a) {
+    return a.real == 0 && a.imag == 0;
+}
+
 // Stream input helper
 inline std::istream& operator>>(std::istream& is, complex_t& c) {
     is >> c.real >> c.imag;
     return is;
 }
 
+// LANES samples carried side by side by one AXI beat or one datapath transfer
+// (P-parallel FFT). Lane l holds sample l of the group.
+template<typename T, int LANES>
+struct sample_vec_t {
+    T lane[LANES];
+
+    sample_vec_t() {
+        for (int l = 0; l < LANES; ++l) {
+            lane[l] = T(0.0, 0.0);
+        }
+    }
+
+    static const unsigned int width = LANES * Wrapped<T>::width;
+
+    template<unsigned int Size>
+    void Marshall(Marshaller<Size>& m) {
+        for (int l = 0; l < LANES; ++l) {
+            m & lane[l];
+        }
+    }
+
+    bool operator==(const sample_vec_t& b) const {
+        for (int l = 0; l < LANES; ++l) {
+            if (!(lane[l] == b.lane[l])) return false;
+        }
+        return true;
+    }
+
+    inline friend std::ostream& operator<<(std::ostream& os, const sample_vec_t& v) {
+        os << "{";
+        for (int l = 0; l < LANES; ++l) {
+            os << (l ? ", " : "") << v.lane[l];
+        }
+        return os << "}";
+    }
+
+    inline friend void sc_trace(sc_trace_file* tf, const sample_vec_t& v, const std::string& name) {
+        for (int l = 0; l < LANES; ++l) {
+            sc_trace(tf, v.lane[l], name + ".lane" + std::to_string(l));
+        }
+    }
+};
+
+// Samples per transfer of a datapath type and their type
+template<typename T>
+struct beat_lanes {
+    enum { value = 1 };
+    typedef T sample_type;
+};
+
+template<typename T, int LANES>
+struct beat_lanes<sample_vec_t<T, LANES>> {
+    enum { value = LANES };
+    typedef T sample_type;
+};
+
+// AXI beat layout: LANES samples per beat, lane l in bits [2*C*(l+1)-1, 2*C*l] with the real
+// part in the upper and the imaginary part in the lower half, each a rounded C-bit two's
+// complement integer, C = dataWidth / (2 * LANES). One lane on a 64-bit bus is the
+// original {real[63:32], imag[31:0]} word; 128/256/512-bit buses carry 2..16 samples.
+// Parts outside the C-bit range are clamped to it and reported as saturated.
+template<typename AxiCfg, int LANES = 1>
+struct BeatPacking {
+    static const int comp_width = AxiCfg::dataWidth / (2 * LANES);
+    static_assert(comp_width >= 8 && comp_width <= 64, "AXI beat components must be 8 to 64 bits wide");
+
+    // sc_uint holds up to 64 bits, wider buses use sc_biguint
+    typedef typename std::conditional<(AxiCfg::dataWidth <= 64), sc_uint<AxiCfg::dataWidth>,
+                                      sc_biguint<AxiCfg::dataWidth>>::type word_t;
+
+    static const int64_t comp_max = (int64_t)(~0ull >> (65 - comp_width));
+    static const int64_t comp_min = -comp_max - 1;
+
+    // Returns true if a part had to be clamped
+    template<typename Word>
+    static bool pack_lane(Word& w, int l, double r, double i) {
+        int lo = 2 * comp_width * l;
+        bool sat = false;
+        w.range(lo + 2 * comp_width - 1, lo + comp_width) = (uint64_t)clamp(r, sat);
+        w.range(lo + comp_width - 1, lo) = (uint64_t)clamp(i, sat);
+        return sat;
+    }
+
+    static int64_t clamp(double v, bool& sat) {
+        double rounded = std::round(v);
+        if (rounded > (double)comp_max) {
+            sat = true;
+            return comp_max;
+        }
+        if (rounded < (double)comp_min) {
+            sat = true;
+            return comp_min;
+        }
+        return std::llround(v);
+    }
+
+    // Part value of a raw C-bit pattern, for stimulus drawn as unsigned bits
+    static int64_t wrap(uint64_t v) {
+        return sign_extend(comp_width < 64 ? (v & (~0ull >> (64 - comp_width))) : v);
+    }
+
+    template<typename Word>
+    static complex_t unpack_lane(const Word& w, int l) {
+        int lo = 2 * comp_width * l;
+        return complex_t((double)sign_extend(w.range(lo + 2 * comp_width - 1, lo + comp_width).to_uint64()),
+                         (double)sign_extend(w.range(lo + comp_width - 1, lo).to_uint64()));
+    }
+
+    static int64_t sign_extend(uint64_t v) {
+        if (comp_width < 64 && ((v >> (comp_width - 1)) & 1)) {
+            v |= ~0ull << (comp_width % 64);
+        }
+        return (int64_t)v;
+    }
+};
+
 // Pack complex value into AXI data word
 template<typename AxiCfg>
-inline sc_uint<AxiCfg::dataWidth> pack_complex(double r, double i) {
-    sc_uint<AxiCfg::dataWidth> res = 0;
-    if (AxiCfg::dataWidth == 64) {
-        static const int HALF_WIDTH = AxiCfg::dataWidth / 2;
-        int r_int = (int)std::round(r);
-        int i_int = (int)std::round(i);
-        res.range(AxiCfg::dataWidth - 1, HALF_WIDTH) = r_int;
-        res.range(HALF_WIDTH - 1, 0) = i_int;
-    } else {
-        int r_int = (int)std::round(r);
-        res.range(AxiCfg::dataWidth - 1, 0) = r_int;
-    }
+inline typename BeatPacking<AxiCfg>::word_t pack_complex(double r, double i) {
+    typename BeatPacking<AxiCfg>::word_t res = 0;
+    BeatPacking<AxiCfg>::pack_lane(res, 0, r, i);
     return res;
 }
 
 template<typename AxiCfg>
-inline sc_uint<AxiCfg::dataWidth> pack_complex(const complex_t& val) {
+inline typename BeatPacking<AxiCfg>::word_t pack_complex(const complex_t& val) {
     return pack_complex<AxiCfg>(val.real, val.imag);
 }
 
-// Unpack AXI data word into complex number
+template<typename AxiCfg, int W, int I>
+inline typename BeatPacking<AxiCfg>::word_t pack_complex(const complex_fixed_t<W, I>& val) {
+    return pack_complex<AxiCfg>(val.real.to_double(), val.imag.to_double());
+}
+
+template<typename AxiCfg, int W, int I>
+inline typename BeatPacking<AxiCfg>::word_t pack_complex(const complex_bfp_t<W, I>& val) {
+    complex_t c = val.to_complex();
+    return pack_complex<AxiCfg>(c.real, c.imag);
+}
+
+// Memory word of a frame exponent (block floating point): the exponent in bits [15:0], the
+// saturation flag of the frame in bit 16
 template<typename AxiCfg>
-inline complex_t unpack_complex(sc_uint<AxiCfg::dataWidth> raw) {
-    static const int HALF_WIDTH = AxiCfg::dataWidth / 2;
-    if (AxiCfg::dataWidth == 64) {
-        int r_int = raw.range(AxiCfg::dataWidth - 1, HALF_WIDTH).to_int();
-        int i_int = raw.range(HALF_WIDTH - 1, 0).to_int();
-        return complex_t((double)r_int, (double)i_int);
-    } else {
-        int r_int = raw.range(AxiCfg::dataWidth - 1, 0).to_int();
-        return complex_t((double)r_int, 0.0);
+inline typename BeatPacking<AxiCfg>::word_t pack_exponent(int exp, bool sat) {
+    typename BeatPacking<AxiCfg>::word_t res = 0;
+    res.range(15, 0) = (uint64_t)exp;
+    res[16] = sat;
+    return res;
+}
+
+template<typename Word>
+inline int unpack_exponent(const Word& raw, bool& sat) {
+    sat = raw[16];
+    return (int)raw.range(15, 0).to_uint64();
+}
+
+// Unpack AXI data word into complex number
+template<typename AxiCfg, typename Word>
+inline complex_t unpack_complex(const Word& raw) {
+    return BeatPacking<AxiCfg>::unpack_lane(raw, 0);
+}
+
+// Beat of a datapath transfer: one sample, or a sample_vec_t filling the bus
+template<typename AxiCfg, typename T>
+inline typename BeatPacking<AxiCfg, beat_lanes<T>::value>::word_t pack_beat(const T& val) {
+    return pack_complex<AxiCfg>(val);
+}
+
+template<typename AxiCfg, typename T, int LANES>
+inline typename BeatPacking<AxiCfg, LANES>::word_t pack_beat(const sample_vec_t<T, LANES>& val) {
+    bool sat;
+    return pack_beat<AxiCfg>(val, sat);
+}
+
+// Same, sat tells whether a part was clamped to the beat component range
+template<typename AxiCfg, typename T>
+inline typename BeatPacking<AxiCfg, beat_lanes<T>::value>::word_t pack_beat(const T& val, bool& sat) {
+    typename BeatPacking<AxiCfg>::word_t res = 0;
+    complex_t c = val.to_complex();
+    sat = BeatPacking<AxiCfg>::pack_lane(res, 0, c.real, c.imag);
+    return res;
+}
+
+template<typename AxiCfg, typename T, int LANES>
+inline typename BeatPacking<AxiCfg, LANES>::word_t pack_beat(const sample_vec_t<T, LANES>& val, bool& sat) {
+    typename BeatPacking<AxiCfg, LANES>::word_t res = 0;
+    sat = false;
+    for (int l = 0; l < LANES; ++l) {
+        complex_t c = val.lane[l].to_complex();
+        sat = BeatPacking<AxiCfg, LANES>::pack_lane(res, l, c.real, c.imag) || sat;
+    }
+    return res;
+}
+
+template<typename AxiCfg, typename T, typename Word>
+inline void unpack_beat(const Word& raw, T& val) {
+    val = T(unpack_complex<AxiCfg>(raw));
+}
+
+template<typename AxiCfg, typename T, int LANES, typename Word>
+inline void unpack_beat(const Word& raw, sample_vec_t<T, LANES>& val) {
+    for (int l = 0; l < LANES; ++l) {
+        val.lane[l] = T(BeatPacking<AxiCfg, LANES>::unpack_lane(raw, l));
     }
 }
 
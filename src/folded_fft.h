@@ -0,0 +1,277 @@
+/*
+ * folded_fft.h
+ *
+ * Folded (memory-based) N-point radix-2 DIF FFT: the log2(N) passes of the transform
+ * share NUM_BF butterfly units and one ping-pong sample RAM instead of unrolling one
+ * stage per pass. While one buffer is transformed in place, the other drains the
+ * previous frame (natural memory order = bit-reversed sample order, as the pipeline) and
+ * is refilled read-before-write with the next one. The RAM is split into 2*NUM_BF banks,
+ * bank(a) = XOR of the log2(2*NUM_BF)-bit digits of a; the butterflies issued together
+ * vary over address bits of distinct digit positions, so every cycle's 2*NUM_BF operands
+ * sit in distinct banks (checked at elaboration).
+ * Each unit is a ButterflyScheduler datapath, a pass takes (N/(2*NUM_BF) - 1) * interval
+ * + latency cycles, and a frame leaves the core one frame after it was loaded. Arithmetic
+ * and twiddle indexing match the radix-2 Stage, so the outputs are bit-exact.
+ */
+
+#ifndef FOLDED_FFT_H
+#define FOLDED_FFT_H
+
+#include "fft_types.h"
+#include "twiddle_rom.h"
+#include "perf_counters.h"
+#include "butterfly_scheduler.h"
+#include <connections/connections.h>
+#include <vector>
+
+using namespace Connections;
+
+// N-point FFT on NUM_BF shared butterfly units of NUM_MULT multipliers and NUM_ADD adders
+// each (folding factor log2(N) / NUM_BF), with per-pass scaling selected by SCALE_MASK
+template<int N, int NUM_BF = 1, int NUM_MULT = 4, int NUM_ADD = 6, typename T = complex_t,
+         unsigned SCALE_MASK = 0>
+SC_MODULE(FoldedFFT) {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "FoldedFFT size must be a power of two >= 2");
+    static_assert(NUM_BF >= 1 && (NUM_BF & (NUM_BF - 1)) == 0, "NUM_BF must be a power of two");
+
+    // Butterfly units actually used (a pass has N/2 butterflies)
+    static const int UNITS = (NUM_BF > N / 2) ? N / 2 : NUM_BF;
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    StreamCounters perf; // Busy: transfers or butterfly issue
+
+    int passes;
+    int bank_bits;                      // log2(2 * UNITS)
+    std::vector<std::vector<int>> addr; // addr[pass][g * UNITS + u]: upper operand address
+    ButterflyScheduler sched;
+    const TwiddleRom& rom;
+
+    std::vector<T> ram[2];
+    int io;           // Buffer draining results and loading the next frame
+    bool io_results;  // io holds a transformed frame
+    int filled;       // Samples loaded into io
+    int drained;      // Results read from io
+    bool cmp_valid;   // The other buffer holds a frame to transform
+    int pass;         // Pass in progress on the compute buffer
+    int group;        // Next butterfly group of the pass
+    unsigned long pass_ready; // First cycle the results of the previous pass are in the RAM
+    unsigned long cycle;
+
+    static int log2i(int n) {
+        int b = 0;
+        while ((1 << b) < n) {
+            b++;
+        }
+        return b;
+    }
+
+    int bank(int a) const {
+        int b = 0;
+        for (; a != 0; a >>= bank_bits) {
+            b ^= a & ((1 << bank_bits) - 1);
+        }
+        return b;
+    }
+
+    // Pass p pairs a0 and a0 + h, h = N >> (p + 1). A group varies the butterflies over
+    // the bits 0..bank_bits-1 except the digit position of h, every other bit selects it.
+    void build_addresses() {
+        for (int p = 0; p < passes; ++p) {
+            int t = passes - 1 - p;
+            std::vector<int> unit_bits, group_bits;
+            for (int b = 0; b < passes; ++b) {
+                if (b == t) continue;
+                bool unit_bit = b < bank_bits && b != t % bank_bits && (int)unit_bits.size() < bank_bits - 1;
+                (unit_bit ? unit_bits : group_bits).push_back(b);
+            }
+            addr[p].resize(N / 2);
+            for (int j = 0; j < N / 2; ++j) {
+                int u = j % UNITS;
+                int g = j / UNITS;
+                int a = 0;
+                for (size_t i = 0; i < unit_bits.size(); ++i) {
+                    a |= ((u >> i) & 1) << unit_bits[i];
+                }
+                for (size_t i = 0; i < group_bits.size(); ++i) {
+                    a |= ((g >> i) & 1) << group_bits[i];
+                }
+                addr[p][j] = a;
+            }
+        }
+    }
+
+    bool conflict_free() const {
+        for (int p = 0; p < passes; ++p) {
+            int h = N >> (p + 1);
+            for (int g = 0; g < N / (2 * UNITS); ++g) {
+                std::vector<bool> used(2 * UNITS, false);
+                for (int u = 0; u < UNITS; ++u) {
+                    int a0 = addr[p][g * UNITS + u];
+                    int banks[2] = {bank(a0), bank(a0 + h)};
+                    for (int b : banks) {
+                        if (used[b]) return false;
+                        used[b] = true;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Radix-2 DIF butterfly of pass p on (a0, a0 + h), as Stage<2h>
+    void compute(int p, int a0) {
+        std::vector<T>& buf = ram[1 - io];
+        int h = N >> (p + 1);
+        int k = a0 & (h - 1);
+        T w = rom.template lookup<T>(k * (rom.size() / (2 * h)));
+        T sum, diff;
+        butterfly(buf[a0], buf[a0 + h], (SCALE_MASK >> p) & 1u, sum, diff);
+        buf[a0] = sum;
+        buf[a0 + h] = diff * w;
+    }
+
+    // Issue one group of the current pass if the units and its operands are ready
+    bool compute_step() {
+        if (!cmp_valid || pass == passes || cycle < pass_ready || !sched.can_issue(cycle)) {
+            return false;
+        }
+        for (int u = 0; u < UNITS; ++u) {
+            compute(pass, addr[pass][group * UNITS + u]);
+        }
+        unsigned long ready = sched.issue(cycle);
+        if (++group == N / (2 * UNITS)) {
+            group = 0;
+            pass++;
+            pass_ready = ready;
+        }
+        return true;
+    }
+
+    bool compute_done() const {
+        return !cmp_valid || (pass == passes && cycle >= pass_ready);
+    }
+
+    void fft_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        perf.start(bound_clock_period(clk));
+        sched.reset();
+
+        io = 0;
+        io_results = false;
+        filled = 0;
+        drained = 0;
+        cmp_valid = false;
+        pass = passes;
+        group = 0;
+        pass_ready = 0;
+        cycle = 0;
+
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+            std::vector<T>& buf = ram[io];
+
+            if (io_results && drained < N) {
+                if (out_data.PushNB(buf[drained])) {
+                    drained++;
+                    perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            // Read-before-write: a slot is free once its result has left
+            if (filled < N && (!io_results || filled < drained)) {
+                T input;
+                if (in_data.PopNB(input)) {
+                    buf[filled++] = input;
+                    perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+
+            if (compute_step()) {
+                transfer = true;
+            }
+
+            // Swap once the frame is loaded, the results are out and the transform is done
+            if (filled == N && (!io_results || drained == N) && compute_done()) {
+                io_results = cmp_valid;
+                cmp_valid = true;
+                io = 1 - io;
+                filled = 0;
+                drained = 0;
+                pass = 0;
+                group = 0;
+                pass_ready = cycle + 1;
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            wait();
+            cycle++;
+        }
+    }
+
+    // Latency in samples: a frame is transformed while the next one is loaded
+    static int calc_latency() {
+        return N;
+    }
+
+    // Cycles to transform one frame in place
+    static int calc_frame_cycles(int n_mult, int n_add) {
+        ButterflyScheduler s(n_mult, n_add);
+        int groups = N / (2 * UNITS);
+        return log2i(N) * ((groups - 1) * s.interval() + s.latency());
+    }
+
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        w.StartArray();
+        perf.write_json(w, basename());
+        w.EndArray();
+    }
+
+    NamedCounters busiest_stage() const {
+        NamedCounters b = {basename(), &perf};
+        return b;
+    }
+
+    SC_HAS_PROCESS(FoldedFFT);
+    FoldedFFT(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        out_data("out_data"),
+        passes(log2i(N)),
+        bank_bits(log2i(2 * UNITS)),
+        addr(log2i(N)),
+        sched(NUM_MULT, NUM_ADD),
+        rom(TwiddleRom::instance(N))
+    {
+        ram[0].assign(N, T(0.0, 0.0));
+        ram[1].assign(N, T(0.0, 0.0));
+        build_addresses();
+        if (!conflict_free()) {
+            SC_REPORT_ERROR(this->name(), "butterfly operands share a RAM bank");
+        }
+
+        SC_THREAD(fft_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // FOLDED_FFT_H
@@ -0,0 +1,87 @@
+/*
+ * mapped_file.h
+ *
+ * Read-only memory mapping of a binary file (POSIX mmap), used by the memory models and
+ * testbenches to backdoor-load stimulus without parsing text or spending simulated cycles.
+ * Binary stimulus is a flat array of little-endian AXI data words, word i at byte address
+ * i * (dataWidth / 8) of the region it is loaded to.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+public:
+    MappedFile() : ptr(nullptr), len(0) {}
+
+    explicit MappedFile(const std::string& path) : ptr(nullptr), len(0) {
+        open(path);
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ptr = static_cast<const unsigned char*>(p);
+                len = (size_t)st.st_size;
+                madvise(p, len, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        return ptr != nullptr;
+    }
+
+    void close() {
+        if (ptr != nullptr) {
+            munmap(const_cast<unsigned char*>(ptr), len);
+            ptr = nullptr;
+            len = 0;
+        }
+    }
+
+    bool is_open() const { return ptr != nullptr; }
+    const unsigned char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+    // Number of whole words of the given width
+    size_t words(int bytes_per_word) const {
+        return len / bytes_per_word;
+    }
+
+    // Little-endian word i of bytes_per_word (<= 8) bytes
+    uint64_t word(size_t i, int bytes_per_word) const {
+        uint64_t w = 0;
+        const unsigned char* p = ptr + i * bytes_per_word;
+        for (int b = bytes_per_word - 1; b >= 0; --b) {
+            w = (w << 8) | p[b];
+        }
+        return w;
+    }
+
+private:
+    const unsigned char* ptr;
+    size_t len;
+};
+
+#endif // MAPPED_FILE_H
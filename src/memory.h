@@ -3,7 +3,10 @@
  *
  * Two-port SRAM simulation model supporting AXI4 read and write slave interfaces.
  * Simulates concurrent multi-port access by spawning separate SystemC processes for
- * independent read and write ports.
+ * independent read and write ports. The read port pipelines multiple outstanding bursts
+ * with a configurable access latency and can interleave their data beats.
+ * Backdoor word access and binary load/dump initialise and inspect the array without
+ * simulated cycles.
  */
 
 #ifndef MEMORY_H
@@ -12,13 +15,30 @@
 #include <systemc.h>
 #include <axi/axi4.h>
 #include <connections/connections.h>
+#include <deque>
+#include <fstream>
 #include <string>
+#include <type_traits>
+#include "mapped_file.h"
+#include "perf_counters.h"
 
 using namespace sc_core;
 using namespace axi;
 
+// Storage word of a dataWidth-bit AXI memory (sc_uint holds up to 64 bits, wider buses use
+// sc_biguint) and the byte address shift of one word, log2(dataWidth / 8)
+template<typename AxiCfg>
+struct MemWord {
+    typedef typename std::conditional<(AxiCfg::dataWidth <= 64), sc_uint<AxiCfg::dataWidth>,
+                                      sc_biguint<AxiCfg::dataWidth>>::type type;
+
+    static constexpr int log2(int n) { return (n > 1) ? 1 + log2(n / 2) : 0; }
+    static const int addrShift = log2(AxiCfg::dataWidth / 8);
+};
+
 // Single-port SRAM with AXI4 slave interfaces
-template<unsigned DEPTH=1024, typename AxiCfg=void>
+template<unsigned DEPTH=1024, typename AxiCfg=void, unsigned READ_LATENCY=0,
+         unsigned MAX_OUTSTANDING=4, bool INTERLEAVE=false>
 SC_MODULE(Memory) {
     sc_in<bool> clk;
     sc_in<bool> rst_n; // Active-low reset
@@ -27,46 +47,116 @@ SC_MODULE(Memory) {
     typename axi4<AxiCfg>::read::template slave<> read_port;
     typename axi4<AxiCfg>::write::template slave<> write_port;
 
-    sc_uint<AxiCfg::dataWidth> mem[DEPTH];
+    typedef typename MemWord<AxiCfg>::type word_t;
+
+    word_t mem[DEPTH];
 
     static const int bytesPerBeat = AxiCfg::dataWidth / 8;
-    static const int addrShift = (AxiCfg::dataWidth == 64) ? 3 : 2;
+    static const int addrShift = MemWord<AxiCfg>::addrShift;
+
+    // Accepted read burst waiting for (or in the middle of) its data phase
+    struct ReadBurst {
+        typename axi4<AxiCfg>::AddrPayload req;
+        unsigned int addr;
+        int beat;
+        unsigned long accept_cycle;
+        unsigned long ready_cycle;
+    };
+
+    std::deque<ReadBurst> read_queue;
 
-    // Read port thread
+    MemoryCounters perf; // Port bursts, beats, stalls and latencies
+
+    // Read port thread: accepts up to MAX_OUTSTANDING bursts, each ready READ_LATENCY
+    // cycles after acceptance, and returns one beat per cycle (round-robin across
+    // ready bursts when INTERLEAVE is set, otherwise in acceptance order)
     void read_port_process() {
         read_port.reset();
+        read_queue.clear();
+        perf.read.reset();
+        unsigned long cycle = 0;
+        unsigned int rr_next = 0;
         wait();
         
         while (true) {
             if (!rst_n.read()) {
                 read_port.reset();
+                read_queue.clear();
                 wait();
                 continue;
             }
             
-            typename axi4<AxiCfg>::AddrPayload req;
-            if (read_port.ar.PopNB(req)) {
-                unsigned int addr = req.addr;
-                int len = req.len;
-                for (int beat = 0; beat <= len; ++beat) {
-                    typename axi4<AxiCfg>::ReadPayload resp;
-                    resp.data = ((addr >> addrShift) < DEPTH) ? (typename axi4<AxiCfg>::Data)mem[addr >> addrShift] : (typename axi4<AxiCfg>::Data)0;
-                    resp.id = req.id;
-                    resp.resp = 0; // OKAY response
-                    resp.last = (beat == len);
-                    
-                    read_port.rwrite(resp);
-                    addr = addr + bytesPerBeat;
+            // Address acceptance
+            if (read_queue.size() < MAX_OUTSTANDING) {
+                typename axi4<AxiCfg>::AddrPayload req;
+                if (read_port.ar.PopNB(req)) {
+                    ReadBurst burst;
+                    burst.req = req;
+                    burst.addr = req.addr;
+                    burst.beat = 0;
+                    burst.accept_cycle = cycle;
+                    burst.ready_cycle = cycle + READ_LATENCY;
+                    read_queue.push_back(burst);
+                    perf.read.bursts++;
                 }
-            } else {
-                wait();
             }
+            
+            // Select the burst that owns the data beat of this cycle
+            int sel = -1;
+            if (INTERLEAVE) {
+                for (unsigned int i = 0; i < read_queue.size() && sel < 0; ++i) {
+                    unsigned int idx = (rr_next + i) % read_queue.size();
+                    // Bursts sharing an ID must complete in order
+                    bool blocked = false;
+                    for (unsigned int j = 0; j < idx; ++j) {
+                        if (read_queue[j].req.id == read_queue[idx].req.id) {
+                            blocked = true;
+                        }
+                    }
+                    if (!blocked && read_queue[idx].ready_cycle <= cycle) {
+                        sel = idx;
+                    }
+                }
+            } else if (!read_queue.empty() && read_queue.front().ready_cycle <= cycle) {
+                sel = 0;
+            }
+            
+            if (sel >= 0) {
+                ReadBurst& burst = read_queue[sel];
+                unsigned int addr = burst.addr;
+                typename axi4<AxiCfg>::ReadPayload resp;
+                resp.data = ((addr >> addrShift) < DEPTH) ? (typename axi4<AxiCfg>::Data)mem[addr >> addrShift] : (typename axi4<AxiCfg>::Data)0;
+                resp.id = burst.req.id;
+                resp.resp = 0; // OKAY response
+                resp.last = (burst.beat == burst.req.len);
+                
+                if (read_port.r.PushNB(resp)) {
+                    perf.read.beats++;
+                    if (burst.beat == 0) {
+                        perf.read.latency.add(cycle - burst.accept_cycle);
+                    }
+                    burst.addr = addr + bytesPerBeat;
+                    if (burst.beat++ == burst.req.len) {
+                        read_queue.erase(read_queue.begin() + sel);
+                    } else {
+                        sel++;
+                    }
+                    rr_next = read_queue.empty() ? 0 : sel % read_queue.size();
+                } else {
+                    perf.read.stall_cycles++;
+                }
+            }
+            
+            wait();
+            cycle++;
         }
     }
 
     // Write port thread
     void write_port_process() {
         write_port.reset();
+        perf.write.reset();
+        sc_time period = bound_clock_period(clk);
         wait();
         
         while (true) {
@@ -78,14 +168,17 @@ SC_MODULE(Memory) {
             
             typename axi4<AxiCfg>::AddrPayload req;
             if (write_port.aw.PopNB(req)) {
+                sc_time accepted = sc_time_stamp();
+                perf.write.bursts++;
                 unsigned int addr = req.addr;
                 int len = req.len;
                 for (int beat = 0; beat <= len; ++beat) {
                     typename axi4<AxiCfg>::WritePayload data = write_port.w.Pop();
+                    perf.write.beats++;
                     if ((addr >> addrShift) < DEPTH) {
                         if (AxiCfg::useWriteStrobes) {
-                            sc_uint<AxiCfg::dataWidth> original = mem[addr >> addrShift];
-                            sc_uint<AxiCfg::dataWidth> mask = 0;
+                            word_t original = mem[addr >> addrShift];
+                            word_t mask = 0;
                             for (int i = 0; i < bytesPerBeat; ++i) {
                                 if (data.wstrb[i]) {
                                     mask.range(8 * i + 7, 8 * i) = 0xFF;
@@ -103,13 +196,63 @@ SC_MODULE(Memory) {
                 resp.id = req.id;
                 resp.resp = 0; // OKAY response
                 
+                sc_time t0 = sc_time_stamp();
                 write_port.bwrite(resp);
+                perf.write.stall_cycles += cycles_since(t0, period) - 1;
+                perf.write.latency.add(cycles_since(accepted, period));
             } else {
                 wait();
             }
         }
     }
 
+    // Backdoor access for preloading and checking
+    void write_word(unsigned int addr, word_t data) {
+        mem[addr >> addrShift] = data;
+    }
+
+    word_t read_word(unsigned int addr) const {
+        return mem[addr >> addrShift];
+    }
+
+    // Load a binary file of little-endian words (mmap'ed) to byte address addr; words past
+    // the end of the array are dropped. Returns the number of words loaded, -1 on error.
+    int load(const std::string& path, unsigned int addr = 0) {
+        MappedFile file(path);
+        if (!file.is_open()) {
+            return -1;
+        }
+        unsigned int first = addr >> addrShift;
+        size_t count = file.words(bytesPerBeat);
+        if (first >= DEPTH) {
+            return 0;
+        }
+        if (count > DEPTH - first) {
+            count = DEPTH - first;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const unsigned char* p = file.data() + i * bytesPerBeat;
+            word_t w = 0;
+            for (int b = 0; b < bytesPerBeat; ++b) {
+                w.range(8 * b + 7, 8 * b) = p[b];
+            }
+            mem[first + i] = w;
+        }
+        return (int)count;
+    }
+
+    // Write words [addr, addr + words * bytesPerBeat) in the load() format
+    bool dump(const std::string& path, unsigned int addr, unsigned int words) const {
+        std::ofstream os(path, std::ios::binary);
+        for (unsigned int i = 0; i < words && (addr >> addrShift) + i < DEPTH && os.good(); ++i) {
+            const word_t& w = mem[(addr >> addrShift) + i];
+            for (int b = 0; b < bytesPerBeat; ++b) {
+                os.put((char)w.range(8 * b + 7, 8 * b).to_uint());
+            }
+        }
+        return os.good();
+    }
+
     SC_CTOR(Memory)
         : clk("clk"),
           rst_n("rst_n"),
@@ -1,9 +1,13 @@
 /*
  * monitor.h
  *
- * AXI4 trace monitor to display bus transaction details.
- * Listens to top-level memory channels to log memory access addresses and print out
- * completed FFT calculation outputs.
+ * AXI4 transaction recorder of the top-level memory channels.
+ * Every AR/R/AW/W/B handshake that passes the core, channel and address filters is
+ * counted and, in record mode, stored as a fixed-size TxnRecord in a preallocated
+ * single-producer ring buffer. A background thread prints the records in batches, so the
+ * simulation thread neither formats nor flushes. Summary mode keeps only the counters and
+ * is cheap enough for benchmark runs. Building with -DFFT_MONITOR=0 removes the monitor
+ * process altogether.
  */
 
 #ifndef MONITOR_H
@@ -13,108 +17,392 @@
 #include <axi/axi4.h>
 #include <connections/connections.h>
 #include "fft_types.h"
-#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
-#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef FFT_MONITOR
+#define FFT_MONITOR 1
+#endif
 
 using namespace sc_core;
 using namespace axi;
 using namespace Connections;
 
-// AXI4 trace monitor
-template<int NUM_CORES, int N, typename AxiCfg>
+// Recorded AXI channels (bit positions of MonitorOptions::channel_mask)
+enum MonChannel { MON_AR = 0, MON_R, MON_AW, MON_W, MON_B, MON_NUM_CHANNELS };
+
+enum MonMode {
+    MON_OFF,     // No process
+    MON_SUMMARY, // Handshake counters only
+    MON_RECORD   // Counters and printed transaction records
+};
+
+inline const char* mon_channel_name(int ch) {
+    static const char* names[MON_NUM_CHANNELS] = {"AR", "R", "AW", "W", "B"};
+    return (ch >= 0 && ch < MON_NUM_CHANNELS) ? names[ch] : "?";
+}
+
+struct MonitorOptions {
+    MonMode mode = MON_OFF;
+    uint32_t core_mask = ~0u;                            // Bit c selects core c
+    uint32_t channel_mask = (1u << MON_NUM_CHANNELS) - 1; // Bit ch selects MonChannel ch
+    uint64_t addr_lo = 0;                                // Beat and burst addresses in
+    uint64_t addr_hi = ~0ull;                            // [addr_lo, addr_hi); B is not filtered
+};
+
+// One handshake, 32 bytes
+struct TxnRecord {
+    uint64_t time_ps;
+    uint64_t addr;    // Burst (AR/AW) or beat (R/W) byte address, 0 for B
+    uint64_t data;    // Beat data, burst length - 1 (AR/AW) or response (B)
+    uint16_t core;
+    uint8_t channel;  // MonChannel
+    uint8_t last;     // Last beat of its burst
+    uint32_t id;      // AXI ID (0 for W)
+};
+
+// Single-producer ring of TxnRecords drained by a printer thread
+class TxnRecorder {
+public:
+    // capacity: records buffered, rounded up to a power of two
+    explicit TxnRecorder(size_t capacity = 1 << 16)
+        : capacity(4), head(0), tail(0), os(nullptr), data_width(64), stop(false) {
+        while (this->capacity < capacity) {
+            this->capacity <<= 1;
+        }
+        buf.resize(this->capacity);
+    }
+
+    ~TxnRecorder() {
+        close();
+    }
+
+    TxnRecorder(const TxnRecorder&) = delete;
+    TxnRecorder& operator=(const TxnRecorder&) = delete;
+
+    // Start printing to out (which must outlive close()); beats are decoded as complex
+    // samples packed in data_width-bit words
+    void start(std::ostream& out, int width) {
+        os = &out;
+        data_width = width;
+        printer = std::thread(&TxnRecorder::printer_loop, this);
+    }
+
+    bool started() const {
+        return os != nullptr;
+    }
+
+    // Simulation thread: blocks only while the printer is a full buffer behind
+    void push(const TxnRecord& r) {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (h - tail.load(std::memory_order_acquire) >= capacity) {
+            cv.notify_one();
+            std::this_thread::yield();
+        }
+        buf[h & (capacity - 1)] = r;
+        head.store(h + 1, std::memory_order_release);
+        // Hand over a quarter buffer at a time
+        if (((h + 1) & (capacity / 4 - 1)) == 0) {
+            cv.notify_one();
+        }
+    }
+
+    unsigned long recorded() const {
+        return (unsigned long)head.load(std::memory_order_relaxed);
+    }
+
+    // Print the remaining records and stop the printer
+    void close() {
+        if (printer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            cv.notify_one();
+            printer.join();
+            drain();
+            os->flush();
+        }
+    }
+
+private:
+    std::vector<TxnRecord> buf;
+    size_t capacity;
+    std::atomic<size_t> head; // Next record written by the simulation thread
+    std::atomic<size_t> tail; // Next record printed
+    std::ostream* os;
+    int data_width;
+    std::thread printer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop;
+
+    static long long sign_extend(uint64_t v, int bits) {
+        uint64_t m = (bits >= 64) ? ~0ull : ((1ull << bits) - 1);
+        v &= m;
+        return (long long)((v & (1ull << (bits - 1))) ? v | ~m : v);
+    }
+
+    void format(const TxnRecord& r, std::string& out) const {
+        char line[160];
+        int n = std::snprintf(line, sizeof(line), "@%14.3f ns [Core %u] %-2s id=%u addr=0x%08llx",
+                              r.time_ps / 1000.0, (unsigned)r.core, mon_channel_name(r.channel),
+                              (unsigned)r.id, (unsigned long long)r.addr);
+        if (r.channel == MON_AR || r.channel == MON_AW) {
+            n += std::snprintf(line + n, sizeof(line) - n, " len=%llu", (unsigned long long)r.data + 1);
+        } else if (r.channel == MON_B) {
+            n += std::snprintf(line + n, sizeof(line) - n, " resp=%llu", (unsigned long long)r.data);
+        } else {
+            // Same packing as unpack_complex(): real upper, imaginary lower half of the word
+            int half = std::min(data_width, 64) / 2;
+            long long re = sign_extend(r.data >> half, half);
+            long long im = sign_extend(r.data, half);
+            n += std::snprintf(line + n, sizeof(line) - n, " data=(%lld, %lld)%s", re, im, r.last ? " last" : "");
+        }
+        out.append(line, std::min(n, (int)sizeof(line) - 1));
+        out.push_back('\n');
+    }
+
+    // Format everything buffered and write it in one go
+    void drain() {
+        std::string text;
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        while (t != h) {
+            format(buf[t & (capacity - 1)], text);
+            t++;
+            if (text.size() >= (1 << 16)) {
+                tail.store(t, std::memory_order_release);
+                os->write(text.data(), text.size());
+                text.clear();
+            }
+        }
+        tail.store(t, std::memory_order_release);
+        os->write(text.data(), text.size());
+    }
+
+    void printer_loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stop) {
+            lock.unlock();
+            drain();
+            lock.lock();
+            cv.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+};
+
+// AXI4 transaction monitor
+template<int NUM_CORES, typename AxiCfg, bool ENABLE = (FFT_MONITOR != 0)>
 SC_MODULE(Monitor) {
     sc_in<bool> clk;
     sc_in<bool> rst_n; // Active-low reset
-    
+
     // Monitored channels
     const sc_vector<typename axi4<AxiCfg>::read::template chan<>>& mem_read_chans;
     const sc_vector<typename axi4<AxiCfg>::write::template chan<>>& mem_write_chans;
-    const sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>>& base_addrs;
 
-    sc_uint<AxiCfg::addrWidth> last_addr[NUM_CORES];
-    std::queue<unsigned int> aw_addr_queue[NUM_CORES];
-    unsigned int current_write_addr[NUM_CORES];
-    unsigned int write_beat_count[NUM_CORES];
+    const MonitorOptions opts;
+    TxnRecorder recorder;
+
+    unsigned long counts[NUM_CORES][MON_NUM_CHANNELS];
+    bool seen[NUM_CORES];
+    uint64_t first_ps[NUM_CORES]; // First and last counted handshake
+    uint64_t last_ps[NUM_CORES];
 
     static const int bytesPerBeat = AxiCfg::dataWidth / 8;
+    static const int numIds = 1 << AxiCfg::idWidth;
+    static const int addrFifoDepth = 4; // Bursts in flight tracked per AXI ID (AW: per core)
+
+    // Next beat address of the bursts in flight, oldest first
+    struct AddrFifo {
+        uint64_t addr[addrFifoDepth];
+        unsigned head;
+        unsigned size;
+
+        void clear() { head = 0; size = 0; }
+
+        // A full FIFO drops its oldest entry (its remaining beats get the next address)
+        void push(uint64_t a) {
+            if (size == addrFifoDepth) {
+                head = (head + 1) % addrFifoDepth;
+                size--;
+            }
+            addr[(head + size) % addrFifoDepth] = a;
+            size++;
+        }
+
+        // Address of the current beat; last retires the burst
+        uint64_t next(bool last) {
+            if (size == 0) {
+                return 0;
+            }
+            uint64_t a = addr[head];
+            addr[head] = a + bytesPerBeat;
+            if (last) {
+                head = (head + 1) % addrFifoDepth;
+                size--;
+            }
+            return a;
+        }
+    };
+
+    AddrFifo rd_addr[NUM_CORES][numIds];
+    AddrFifo wr_addr[NUM_CORES];
 
     SC_HAS_PROCESS(Monitor);
 
     Monitor(sc_module_name name,
             const sc_vector<typename axi4<AxiCfg>::read::template chan<>>& r_chans,
             const sc_vector<typename axi4<AxiCfg>::write::template chan<>>& w_chans,
-            const sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>>& b_addrs)
+            const MonitorOptions& options,
+            size_t record_capacity = 1 << 16)
         : sc_module(name),
           clk("clk"),
           rst_n("rst_n"),
           mem_read_chans(r_chans),
           mem_write_chans(w_chans),
-          base_addrs(b_addrs)
+          opts(options),
+          recorder(record_capacity)
     {
-        SC_METHOD(monitor_process);
-        sensitive << clk.pos();
-        
         for (int i = 0; i < NUM_CORES; ++i) {
-            last_addr[i] = 0xFFF;
-            current_write_addr[i] = 0;
-            write_beat_count[i] = 0;
+            for (int ch = 0; ch < MON_NUM_CHANNELS; ++ch) {
+                counts[i][ch] = 0;
+            }
+            seen[i] = false;
+            first_ps[i] = 0;
+            last_ps[i] = 0;
+            wr_addr[i].clear();
+            for (int id = 0; id < numIds; ++id) {
+                rd_addr[i][id].clear();
+            }
+        }
+
+        if (ENABLE && opts.mode != MON_OFF) {
+            SC_METHOD(monitor_process);
+            sensitive << clk.pos();
+        }
+    }
+
+    // Print records to os from now on (record mode); os must outlive close()
+    void start(std::ostream& os) {
+        if (ENABLE && opts.mode == MON_RECORD) {
+            recorder.start(os, AxiCfg::dataWidth);
+        }
+    }
+
+    // Print the buffered records
+    void close() {
+        recorder.close();
+    }
+
+    // Per-core handshake counts
+    void report(std::ostream& os = std::cout) const {
+        if (!ENABLE || opts.mode == MON_OFF) {
+            return;
+        }
+        for (int i = 0; i < NUM_CORES; ++i) {
+            if (!((opts.core_mask >> i) & 1u)) {
+                continue;
+            }
+            os << "MONITOR_RESULT: CORE=" << i;
+            for (int ch = 0; ch < MON_NUM_CHANNELS; ++ch) {
+                os << " " << mon_channel_name(ch) << "=" << counts[i][ch];
+            }
+            os << " FIRST_NS=" << first_ps[i] / 1000.0
+               << " LAST_NS=" << last_ps[i] / 1000.0
+               << std::endl;
+        }
+        if (opts.mode == MON_RECORD) {
+            os << "MONITOR_RESULT: RECORDS=" << recorder.recorded() << std::endl;
         }
     }
 
     void monitor_process() {
-        // Trace read address requests
-        for (int i = 0; i < NUM_CORES; i++) {
-            if (mem_read_chans[i].ar.val.read() && mem_read_chans[i].ar.rdy.read()) {
-                auto ar_pay = BitsToType<typename axi4<AxiCfg>::AddrPayload>(mem_read_chans[i].ar.msg.read());
-                sc_uint<AxiCfg::addrWidth> addr = ar_pay.addr;
-                if (addr != last_addr[i]) {
-                    std::cout << "DEBUG DMA[" << i << "] Read Addr: " << addr << " @ " << sc_time_stamp() << std::endl;
-                    last_addr[i] = addr;
+        if (!rst_n.read()) {
+            for (int i = 0; i < NUM_CORES; ++i) {
+                wr_addr[i].clear();
+                for (int id = 0; id < numIds; ++id) {
+                    rd_addr[i][id].clear();
                 }
             }
+            return;
         }
-        
-        // Trace write address requests
+        uint64_t now_ps = (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS));
+
         for (int i = 0; i < NUM_CORES; i++) {
-            if (mem_write_chans[i].aw.val.read() && mem_write_chans[i].aw.rdy.read()) {
-                auto aw_pay = BitsToType<typename axi4<AxiCfg>::AddrPayload>(mem_write_chans[i].aw.msg.read());
-                aw_addr_queue[i].push(aw_pay.addr.to_uint());
+            if (!((opts.core_mask >> i) & 1u)) {
+                continue;
             }
-        }
-        
-        // Log outputs on AXI W handshakes
-        for (int i = 0; i < NUM_CORES; i++) {
-            if (mem_write_chans[i].w.val.read() && mem_write_chans[i].w.rdy.read()) {
-                auto w_pay = BitsToType<typename axi4<AxiCfg>::WritePayload>(mem_write_chans[i].w.msg.read());
-                
-                unsigned int addr = 0;
-                if (write_beat_count[i] == 0) {
-                    if (!aw_addr_queue[i].empty()) {
-                        addr = aw_addr_queue[i].front();
-                        aw_addr_queue[i].pop();
-                    } else {
-                        addr = base_addrs[i].read() + N * bytesPerBeat;
-                    }
-                    current_write_addr[i] = addr;
-                } else {
-                    current_write_addr[i] += bytesPerBeat;
-                    addr = current_write_addr[i];
-                }
-                
-                int index = (addr - (base_addrs[i].read() + N * bytesPerBeat)) / bytesPerBeat;
-                complex_t out_val = unpack_complex<AxiCfg>(w_pay.data);
-                
-                std::cout << "@" << std::setw(5) << sc_time_stamp() 
-                          << " [Core " << i << "] Out[" << std::setw(2) << index << "] = " 
-                          << out_val << std::endl;
-                          
-                 if (w_pay.last) {
-                    write_beat_count[i] = 0;
-                } else {
-                    write_beat_count[i] += 1;
-                }
+
+            // Read address and data
+            if (mem_read_chans[i].ar.in_val.read() && mem_read_chans[i].ar.in_rdy.read()) {
+                auto ar_pay = mem_read_chans[i].ar.in_msg.read();
+                uint32_t id = ar_pay.id.to_uint();
+                rd_addr[i][id % numIds].push(ar_pay.addr.to_uint64());
+                record(now_ps, i, MON_AR, id, ar_pay.addr.to_uint64(), ar_pay.len.to_uint64(), false);
+            }
+            if (mem_read_chans[i].r.in_val.read() && mem_read_chans[i].r.in_rdy.read()) {
+                auto r_pay = mem_read_chans[i].r.in_msg.read();
+                uint32_t id = r_pay.id.to_uint();
+                bool last = r_pay.last;
+                uint64_t addr = rd_addr[i][id % numIds].next(last);
+                record(now_ps, i, MON_R, id, addr, r_pay.data.to_uint64(), last);
             }
+
+            // Write address, data and response
+            if (mem_write_chans[i].aw.in_val.read() && mem_write_chans[i].aw.in_rdy.read()) {
+                auto aw_pay = mem_write_chans[i].aw.in_msg.read();
+                wr_addr[i].push(aw_pay.addr.to_uint64());
+                record(now_ps, i, MON_AW, aw_pay.id.to_uint(), aw_pay.addr.to_uint64(), aw_pay.len.to_uint64(), false);
+            }
+            if (mem_write_chans[i].w.in_val.read() && mem_write_chans[i].w.in_rdy.read()) {
+                auto w_pay = mem_write_chans[i].w.in_msg.read();
+                bool last = w_pay.last;
+                uint64_t addr = wr_addr[i].next(last);
+                record(now_ps, i, MON_W, 0, addr, w_pay.data.to_uint64(), last);
+            }
+            if (mem_write_chans[i].b.in_val.read() && mem_write_chans[i].b.in_rdy.read()) {
+                auto b_pay = mem_write_chans[i].b.in_msg.read();
+                record(now_ps, i, MON_B, b_pay.id.to_uint(), 0, b_pay.resp.to_uint64(), true);
+            }
+        }
+    }
+
+private:
+    void record(uint64_t time_ps, int core, int ch, uint32_t id, uint64_t addr, uint64_t data, bool last) {
+        if (!((opts.channel_mask >> ch) & 1u)) {
+            return;
+        }
+        if (ch != MON_B && (addr < opts.addr_lo || addr >= opts.addr_hi)) {
+            return;
+        }
+        if (!seen[core]) {
+            seen[core] = true;
+            first_ps[core] = time_ps;
+        }
+        last_ps[core] = time_ps;
+        counts[core][ch]++;
+
+        if (opts.mode == MON_RECORD && recorder.started()) {
+            TxnRecord r;
+            r.time_ps = time_ps;
+            r.addr = addr;
+            r.data = data;
+            r.core = (uint16_t)core;
+            r.channel = (uint8_t)ch;
+            r.last = last ? 1 : 0;
+            r.id = id;
+            recorder.push(r);
         }
     }
 };
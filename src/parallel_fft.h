@@ -0,0 +1,286 @@
+/*
+ * parallel_fft.h
+ *
+ * P-parallel multi-path N-point radix-2 DIF FFT consuming one sample_vec_t of LANES
+ * samples per cycle. Sample l of every beat travels down its own path: the first
+ * log2(N/LANES) stages pair samples LANES or more apart, which always sit in the same lane,
+ * so each path is a chain of radix-2 Stages with delay lines of 1/LANES the length and
+ * lane-interleaved twiddles. The last log2(LANES) stages pair samples of the same beat and
+ * run as spatial butterflies when the paths are merged back into a beat. Lane l of output
+ * beat b is output b * LANES + l of the sequential pipeline (bit-reversed order), so
+ * unpacking the beats lane by lane gives the same stream, LANES times faster.
+ */
+
+#ifndef PARALLEL_FFT_H
+#define PARALLEL_FFT_H
+
+#include "fft_types.h"
+#include "stage.h"
+#include <connections/connections.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace Connections;
+
+// Recursive template instantiating the stages of one path (stage sizes N down to 2*LANES)
+template<int STAGE_SIZE, int LANES, typename T, unsigned SCALE_MASK>
+struct LaneStageInstantiator {
+    static void instantiate(std::vector<StageBase<T>*>& stages, int lane, int index,
+                            int n_mult, int n_add, sc_in<bool>& clk, sc_in<bool>& rst_n, int rom_n) {
+        if constexpr (STAGE_SIZE >= 2 * LANES) {
+            std::string s_name = "lane" + std::to_string(lane) + "_stage_" + std::to_string(index);
+            auto* stage = new Stage<STAGE_SIZE, T, LANES>(s_name.c_str(), n_mult, n_add,
+                                                          (SCALE_MASK >> index) & 1u, rom_n, lane);
+            stage->clk(clk);
+            stage->rst_n(rst_n);
+            stages.push_back(stage);
+            LaneStageInstantiator<STAGE_SIZE / 2, LANES, T, SCALE_MASK>::instantiate(
+                stages, lane, index + 1, n_mult, n_add, clk, rst_n, rom_n);
+        }
+    }
+};
+
+// N-point FFT on LANES parallel paths, with per-stage scaling selected by SCALE_MASK
+template<int N, int LANES, int NUM_MULT = 4, int NUM_ADD = 6, typename T = complex_t,
+         unsigned SCALE_MASK = 0>
+SC_MODULE(ParallelFFT) {
+    static_assert(LANES >= 2 && (LANES & (LANES - 1)) == 0, "LANES must be a power of two >= 2");
+    static_assert(N >= LANES && (N & (N - 1)) == 0, "N must be a power of two of at least LANES samples");
+
+    typedef sample_vec_t<T, LANES> beat_t;
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<beat_t> in_data;
+    Out<beat_t> out_data;
+
+    std::vector<StageBase<T>*> stages; // Path stages, lane by lane
+    std::vector<Combinational<T>*> lane_signals;
+    std::vector<Out<T>*> split_ports;  // Beat lanes into the paths
+    std::vector<In<T>*> merge_ports;   // Path outputs
+    int path_stages;
+
+    StreamCounters split_perf;
+    StreamCounters merge_perf; // Spatial butterflies included
+    ButterflyScheduler sched;  // Spatial butterflies run on the ALU configuration of a stage
+    const TwiddleRom& rom;
+
+    struct PendingBeat {
+        beat_t value;
+        unsigned long ready;
+    };
+
+    // Deal each beat out to the paths; a path that is not ready holds back the next beat
+    void split_thread() {
+        in_data.Reset();
+        for (auto* p : split_ports) {
+            p->Reset();
+        }
+        split_perf.start(bound_clock_period(clk));
+        beat_t beat;
+        bool have = false;
+        bool sent[LANES];
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool blocked = false;
+            if (have) {
+                bool all = true;
+                for (int l = 0; l < LANES; ++l) {
+                    if (!sent[l]) {
+                        sent[l] = split_ports[l]->PushNB(beat.lane[l]);
+                        all = all && sent[l];
+                    }
+                }
+                if (all) {
+                    have = false;
+                    split_perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+            bool starved = false;
+            if (!have) {
+                if (in_data.PopNB(beat)) {
+                    have = true;
+                    for (int l = 0; l < LANES; ++l) {
+                        sent[l] = false;
+                    }
+                    split_perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+            split_perf.book_cycle(transfer, starved, blocked);
+            wait();
+        }
+    }
+
+    // Last log2(LANES) stages: radix-2 butterflies between lanes of one beat
+    void spatial_butterflies(beat_t& v) const {
+        for (int s = path_stages; (N >> (s + 1)) >= 1; ++s) {
+            int h = N >> (s + 1);
+            int rom_stride = rom.size() / (2 * h);
+            for (int a = 0; a < LANES; ++a) {
+                if (a & h) continue;
+                T w = rom.template lookup<T>((a & (h - 1)) * rom_stride);
+                T sum, diff;
+                butterfly(v.lane[a], v.lane[a + h], (SCALE_MASK >> s) & 1u, sum, diff);
+                v.lane[a] = sum;
+                v.lane[a + h] = diff * w;
+            }
+        }
+    }
+
+    // Collect one sample per path, apply the spatial stages and emit the beat
+    void merge_thread() {
+        out_data.Reset();
+        for (auto* p : merge_ports) {
+            p->Reset();
+        }
+        merge_perf.start(bound_clock_period(clk));
+        sched.reset();
+        std::deque<PendingBeat> pending;
+        unsigned long cycle = 0;
+        beat_t beat;
+        bool got[LANES];
+        for (int l = 0; l < LANES; ++l) {
+            got[l] = false;
+        }
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool blocked = false;
+            bool starved = false;
+            if (!pending.empty() && pending.front().ready <= cycle) {
+                if (out_data.PushNB(pending.front().value)) {
+                    pending.pop_front();
+                    merge_perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            bool all = true;
+            for (int l = 0; l < LANES; ++l) {
+                if (!got[l]) {
+                    got[l] = merge_ports[l]->PopNB(beat.lane[l]);
+                    transfer = transfer || got[l];
+                    all = all && got[l];
+                }
+            }
+            if (!all) {
+                starved = true;
+            } else if ((int)pending.size() < sched.depth() && sched.can_issue(cycle)) {
+                spatial_butterflies(beat);
+                pending.push_back({beat, sched.issue(cycle)});
+                merge_perf.samples_in++;
+                for (int l = 0; l < LANES; ++l) {
+                    got[l] = false;
+                }
+            }
+
+            merge_perf.book_cycle(transfer, starved, blocked);
+            wait();
+            cycle++;
+        }
+    }
+
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        w.StartArray();
+        split_perf.write_json(w, "split");
+        for (auto* stage : stages) {
+            stage->perf.write_json(w, stage->basename());
+        }
+        merge_perf.write_json(w, "merge");
+        w.EndArray();
+    }
+
+    NamedCounters busiest_stage() const {
+        NamedCounters b = {"split", &split_perf};
+        for (auto* stage : stages) {
+            if (stage->perf.utilization() > b.perf->utilization()) {
+                b.name = stage->basename();
+                b.perf = &stage->perf;
+            }
+        }
+        if (merge_perf.utilization() > b.perf->utilization()) {
+            b.name = "merge";
+            b.perf = &merge_perf;
+        }
+        return b;
+    }
+
+    SC_HAS_PROCESS(ParallelFFT);
+    ParallelFFT(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        out_data("out_data"),
+        path_stages(0),
+        sched(NUM_MULT, NUM_ADD),
+        rom(TwiddleRom::instance(N))
+    {
+        for (int l = 0; l < LANES; ++l) {
+            std::string lane = "lane" + std::to_string(l);
+            split_ports.push_back(new Out<T>((lane + "_split").c_str()));
+            merge_ports.push_back(new In<T>((lane + "_merge").c_str()));
+
+            size_t first = stages.size();
+            LaneStageInstantiator<N, LANES, T, SCALE_MASK>::instantiate(
+                stages, l, 0, NUM_MULT, NUM_ADD, clk, rst_n, N);
+            path_stages = (int)(stages.size() - first);
+
+            // Split -> stage chain -> merge (directly connected without path stages)
+            for (int i = 0; i <= path_stages; ++i) {
+                std::string sig_name = "sig_" + lane + "_" + std::to_string(i);
+                auto* chan = new Combinational<T>(sig_name.c_str());
+                lane_signals.push_back(chan);
+                if (i == 0) {
+                    (*split_ports[l])(*chan);
+                } else {
+                    stages[first + i - 1]->get_out_port()(*chan);
+                }
+                if (i == path_stages) {
+                    (*merge_ports[l])(*chan);
+                } else {
+                    stages[first + i]->get_in_port()(*chan);
+                }
+            }
+        }
+
+        SC_THREAD(split_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+
+        SC_THREAD(merge_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+
+    ~ParallelFFT() {
+        for (auto* stage : stages) {
+            delete stage;
+        }
+        for (auto* sig : lane_signals) {
+            delete sig;
+        }
+        for (auto* p : split_ports) {
+            delete p;
+        }
+        for (auto* p : merge_ports) {
+            delete p;
+        }
+    }
+};
+
+#endif // PARALLEL_FFT_H
@@ -0,0 +1,310 @@
+/*
+ * perf_counters.h
+ *
+ * Built-in performance counters of the datapath blocks.
+ * Streaming blocks (pipeline stages, reorder buffer) split the cycles of their thread into
+ * busy (transfers and butterfly ALU cycles), starved (waiting for input, idle time included)
+ * and back-pressured (output not accepted) cycles by timing their blocking Pop/Push calls,
+ * so the cycle behaviour of the blocks is unchanged. AXI ports count bursts and beats and
+ * keep power-of-two latency histograms. Counter sets write themselves through a SAX-style
+ * writer with the rapidjson::Writer interface, so the datapath needs no JSON library.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <systemc.h>
+#include <connections/connections.h>
+#include <cstdint>
+
+using namespace sc_core;
+using namespace Connections;
+
+// Period of the sc_clock bound to a clock input (1 ns if it is not driven by a clock)
+inline sc_time bound_clock_period(sc_in<bool>& clk) {
+    sc_clock* c = dynamic_cast<sc_clock*>(clk.get_interface());
+    return (c != nullptr) ? c->period() : sc_time(1.0, SC_NS);
+}
+
+// Whole clock cycles elapsed since t0
+inline unsigned long cycles_since(const sc_time& t0, const sc_time& period) {
+    return (unsigned long)((sc_time_stamp() - t0) / period + 0.5);
+}
+
+// Latency histogram: bucket 0 counts zero cycles, bucket b latencies in [2^(b-1), 2^b),
+// the last bucket everything above
+struct LatencyHistogram {
+    enum { buckets = 16 };
+
+    unsigned long count[buckets];
+    unsigned long samples;
+    unsigned long total;
+    unsigned long max;
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        for (int b = 0; b < buckets; ++b) {
+            count[b] = 0;
+        }
+        samples = 0;
+        total = 0;
+        max = 0;
+    }
+
+    void add(unsigned long cycles) {
+        int b = 0;
+        while (b < buckets - 1 && (cycles >> b) != 0) {
+            b++;
+        }
+        count[b]++;
+        samples++;
+        total += cycles;
+        if (cycles > max) {
+            max = cycles;
+        }
+    }
+
+    double mean() const {
+        return samples ? (double)total / samples : 0.0;
+    }
+
+    // Buckets up to the last non-empty one
+    template<typename Writer>
+    void write_json(Writer& w) const {
+        int last = 0;
+        for (int b = 0; b < buckets; ++b) {
+            if (count[b]) last = b;
+        }
+        w.StartObject();
+        w.Key("samples"); w.Uint64(samples);
+        w.Key("mean"); w.Double(mean());
+        w.Key("max"); w.Uint64(max);
+        w.Key("log2_buckets");
+        w.StartArray();
+        for (int b = 0; b <= last; ++b) {
+            w.Uint64(count[b]);
+        }
+        w.EndArray();
+        w.EndObject();
+    }
+};
+
+// AXI bursts of one direction of a port
+struct BurstCounters {
+    unsigned long bursts;
+    unsigned long beats;
+    unsigned long stall_cycles; // Cycles a ready beat or request was not accepted
+    LatencyHistogram latency;   // Address handshake to first data beat (R) or response (B)
+
+    BurstCounters() { reset(); }
+
+    void reset() {
+        bursts = 0;
+        beats = 0;
+        stall_cycles = 0;
+        latency.reset();
+    }
+
+    template<typename Writer>
+    void write_json(Writer& w) const {
+        w.StartObject();
+        w.Key("bursts"); w.Uint64(bursts);
+        w.Key("beats"); w.Uint64(beats);
+        w.Key("stall_cycles"); w.Uint64(stall_cycles);
+        w.Key("latency"); latency.write_json(w);
+        w.EndObject();
+    }
+};
+
+// Cycle breakdown of a streaming block thread with one input and one output channel
+struct StreamCounters {
+    unsigned long busy_cycles;         // Transfers and butterfly ALU cycles
+    unsigned long starved_cycles;      // Input not valid (including idle time)
+    unsigned long backpressure_cycles; // Output not accepted
+    unsigned long alu_wait_cycles;     // Extra cycles of multi-cycle butterflies (part of busy)
+    unsigned long pruned_butterflies;  // Butterflies that took no ALU slot (pruning)
+    unsigned long samples_in;
+    unsigned long samples_out;
+    sc_time period;
+
+    StreamCounters() : period(1.0, SC_NS) { reset(); }
+
+    // Clear the counters (thread reset); cycles are measured in units of period
+    void start(const sc_time& clk_period) {
+        reset();
+        period = clk_period;
+    }
+
+    void reset() {
+        busy_cycles = 0;
+        starved_cycles = 0;
+        backpressure_cycles = 0;
+        alu_wait_cycles = 0;
+        pruned_butterflies = 0;
+        samples_in = 0;
+        samples_out = 0;
+    }
+
+    // Blocking transfers; the cycle of the handshake is busy, every earlier one a stall
+    template<typename T>
+    T pop(In<T>& port) {
+        sc_time t0 = sc_time_stamp();
+        T v = port.Pop();
+        book(t0, starved_cycles);
+        samples_in++;
+        return v;
+    }
+
+    template<typename T>
+    void push(Out<T>& port, const T& v) {
+        sc_time t0 = sc_time_stamp();
+        port.Push(v);
+        book(t0, backpressure_cycles);
+        samples_out++;
+    }
+
+    void alu_wait(int cycles) {
+        busy_cycles += cycles;
+        alu_wait_cycles += cycles;
+    }
+
+    // Cycle of a thread using non-blocking transfers: a transfer makes it busy, otherwise
+    // a refused output or a missing input stalls it; with neither it waits for the ALU
+    void book_cycle(bool transfer, bool starved, bool blocked) {
+        if (transfer) {
+            busy_cycles++;
+        } else if (blocked) {
+            backpressure_cycles++;
+        } else if (starved) {
+            starved_cycles++;
+        } else {
+            alu_wait(1);
+        }
+    }
+
+    unsigned long total_cycles() const {
+        return busy_cycles + starved_cycles + backpressure_cycles;
+    }
+
+    double utilization() const {
+        unsigned long total = total_cycles();
+        return total ? (double)busy_cycles / total : 0.0;
+    }
+
+    template<typename Writer>
+    void write_json(Writer& w, const char* name) const {
+        w.StartObject();
+        w.Key("name"); w.String(name);
+        w.Key("busy_cycles"); w.Uint64(busy_cycles);
+        w.Key("starved_cycles"); w.Uint64(starved_cycles);
+        w.Key("backpressure_cycles"); w.Uint64(backpressure_cycles);
+        w.Key("alu_wait_cycles"); w.Uint64(alu_wait_cycles);
+        w.Key("pruned_butterflies"); w.Uint64(pruned_butterflies);
+        w.Key("samples_in"); w.Uint64(samples_in);
+        w.Key("samples_out"); w.Uint64(samples_out);
+        w.Key("utilization"); w.Double(utilization());
+        w.EndObject();
+    }
+
+private:
+    void book(const sc_time& t0, unsigned long& stall) {
+        unsigned long cycles = cycles_since(t0, period);
+        if (cycles > 0) {
+            busy_cycles++;
+            stall += cycles - 1;
+        }
+    }
+};
+
+// Counters of a named block, e.g. the busiest stage of a pipeline
+struct NamedCounters {
+    const char* name;
+    const StreamCounters* perf;
+};
+
+// DMA engine counters
+struct DmaCounters {
+    BurstCounters read;                  // AR bursts / R beats, stalls: data ready, FFT input full
+    BurstCounters write;                 // AW bursts / W beats, stalls: W or AW not accepted
+    unsigned long read_wait_cycles;      // FFT input ready but its data still in flight
+    unsigned long fft_wait_cycles;       // Write engine waiting for FFT outputs
+    unsigned long busy_cycles;           // Cycles with busy asserted
+    unsigned long desc_fetches;          // Scatter-gather descriptors read
+    sc_time period;
+    sc_time started;                     // End of the last reset
+    sc_time busy_since;
+    bool busy_state;
+
+    DmaCounters() : period(1.0, SC_NS), busy_state(false) { reset(); }
+
+    void start(const sc_time& clk_period) {
+        reset();
+        period = clk_period;
+        started = sc_time_stamp();
+    }
+
+    void reset() {
+        read.reset();
+        write.reset();
+        read_wait_cycles = 0;
+        fft_wait_cycles = 0;
+        busy_cycles = 0;
+        desc_fetches = 0;
+        busy_state = false;
+    }
+
+    // Track the busy output; open intervals are counted up to now
+    void set_busy(bool busy) {
+        if (busy && !busy_state) {
+            busy_since = sc_time_stamp();
+        } else if (!busy && busy_state) {
+            busy_cycles += cycles_since(busy_since, period);
+        }
+        busy_state = busy;
+    }
+
+    unsigned long busy_cycles_now() const {
+        return busy_cycles + (busy_state ? cycles_since(busy_since, period) : 0);
+    }
+
+    // Fraction of the cycles since reset in which the core had work
+    double utilization() const {
+        unsigned long elapsed = cycles_since(started, period);
+        return elapsed ? (double)busy_cycles_now() / elapsed : 0.0;
+    }
+
+    template<typename Writer>
+    void write_json(Writer& w) const {
+        w.StartObject();
+        w.Key("read"); read.write_json(w);
+        w.Key("write"); write.write_json(w);
+        w.Key("read_wait_cycles"); w.Uint64(read_wait_cycles);
+        w.Key("fft_wait_cycles"); w.Uint64(fft_wait_cycles);
+        w.Key("busy_cycles"); w.Uint64(busy_cycles_now());
+        w.Key("desc_fetches"); w.Uint64(desc_fetches);
+        w.Key("utilization"); w.Double(utilization());
+        w.EndObject();
+    }
+};
+
+// Slave memory counters
+struct MemoryCounters {
+    BurstCounters read;  // Stalls: R beat not accepted; latency: AR accept to first R beat
+    BurstCounters write; // Stalls: B response not accepted
+
+    void reset() {
+        read.reset();
+        write.reset();
+    }
+
+    template<typename Writer>
+    void write_json(Writer& w) const {
+        w.StartObject();
+        w.Key("read"); read.write_json(w);
+        w.Key("write"); write.write_json(w);
+        w.EndObject();
+    }
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,156 @@
+/*
+ * real_split.h
+ *
+ * Post-processing stage of the real-input FFT mode. An N-sample real frame x enters the
+ * datapath as the N/2-point complex sequence z[n] = x[2n] + j x[2n+1] (two real samples per
+ * beat), and the N/2-point FFT delivers Z in bit-reversed order. This stage collects one
+ * frame of Z in a ping-pong buffer and rebuilds the N/2 + 1 unique bins of the real
+ * spectrum in natural order with the conjugate-symmetry split
+ *     X[k] = (Z[k] + Z*[N/2-k]) / 2 - j W_N^k (Z[k] - Z*[N/2-k]) / 2,   k = 0..N/2
+ * (indices of Z modulo N/2). X[0] and X[N/2] are real and leave together as
+ * (X[0], X[N/2]), so a frame of N/2 input beats returns N/2 beats
+ * {(X[0], X[N/2]), X[1], ..., X[N/2-1]}. Each beat is one butterfly and one twiddle
+ * product on a ButterflyScheduler datapath, and a frame leaves the stage one frame after
+ * it arrived.
+ */
+
+#ifndef REAL_SPLIT_H
+#define REAL_SPLIT_H
+
+#include "fft_types.h"
+#include "twiddle_rom.h"
+#include "perf_counters.h"
+#include "butterfly_scheduler.h"
+#include <connections/connections.h>
+#include <vector>
+
+using namespace Connections;
+
+// Conjugate-symmetry split of the N/2-point transform of a packed N-sample real frame
+template<int N, int NUM_MULT = 4, int NUM_ADD = 6, typename T = complex_t>
+SC_MODULE(RealSplit) {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Real frame length must be a power of two >= 2");
+
+    static const int HALF = N / 2; // Complex samples (beats) of a frame
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    StreamCounters perf;
+
+    ButterflyScheduler sched;
+    const TwiddleRom& rom;
+
+    std::vector<T> ram[2];
+
+    static int reverse_bits(int index) {
+        int rev = 0;
+        for (int b = 1; b < HALF; b <<= 1) {
+            rev = (rev << 1) | ((index & b) ? 1 : 0);
+        }
+        return rev;
+    }
+
+    // Bin k of the real spectrum from the natural-order Z of one frame
+    T split_bin(const std::vector<T>& z, int k) const {
+        T zk = z[k % HALF];
+        T zc = z[(HALF - k) % HALF].conj();
+        T even, odd;
+        butterfly(zk, zc, true, even, odd);
+        T w = rom.template lookup<T>(k * (rom.size() / N));
+        return even + w * odd.mul_neg_j();
+    }
+
+    // Output beat b of a frame: bin b, beat 0 packs the real bins 0 and N/2
+    T split_beat(const std::vector<T>& z, int b) const {
+        T x = split_bin(z, b);
+        if (b == 0) {
+            x.imag = split_bin(z, HALF).real;
+        }
+        return x;
+    }
+
+    void split_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        perf.start(bound_clock_period(clk));
+        sched.reset();
+
+        int fill = 0;         // Buffer loading the next frame
+        int filled = 0;
+        bool emitting = false; // The other buffer holds a frame to split
+        int beat = 0;
+        unsigned long cycle = 0;
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+
+            if (emitting && sched.can_issue(cycle)) {
+                if (out_data.PushNB(split_beat(ram[1 - fill], beat))) {
+                    sched.issue(cycle);
+                    perf.samples_out++;
+                    transfer = true;
+                    if (++beat == HALF) {
+                        emitting = false;
+                    }
+                } else {
+                    blocked = true;
+                }
+            }
+
+            if (filled < HALF) {
+                T input;
+                if (in_data.PopNB(input)) {
+                    ram[fill][reverse_bits(filled++)] = input;
+                    perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+
+            // Swap once the next frame is loaded and the previous one has left
+            if (filled == HALF && !emitting) {
+                fill = 1 - fill;
+                filled = 0;
+                emitting = true;
+                beat = 0;
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            wait();
+            cycle++;
+        }
+    }
+
+    // Latency in beats: a frame is split while the next one is collected
+    static int calc_latency() {
+        return HALF;
+    }
+
+    SC_HAS_PROCESS(RealSplit);
+    RealSplit(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        out_data("out_data"),
+        sched(NUM_MULT, NUM_ADD),
+        rom(TwiddleRom::instance(N))
+    {
+        ram[0].assign(HALF, T(0.0, 0.0));
+        ram[1].assign(HALF, T(0.0, 0.0));
+
+        SC_THREAD(split_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // REAL_SPLIT_H
@@ -0,0 +1,88 @@
+/*
+ * reorder.h
+ *
+ * Bit-reversal reorder buffer turning the bit-reversed DIF output stream into natural order.
+ * Uses a single N-entry buffer updated in place: every sample is read out and replaced by the
+ * incoming one at the same address, with the address sequence alternating between natural
+ * and bit-reversed order from frame to frame. Adds a lag of one frame (N samples).
+ */
+
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "fft_types.h"
+#include "perf_counters.h"
+#include <connections/connections.h>
+#include <vector>
+
+using namespace Connections;
+
+// Single-buffer in-place bit-reversal reorder stage
+template<int N, typename T = complex_t>
+SC_MODULE(Reorder) {
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    StreamCounters perf;
+
+    std::vector<T> buf;
+    bool reversed; // Address sequence of the current frame is bit-reversed
+    bool primed;   // Buffer holds a complete frame
+
+    static int reverse_bits(int index) {
+        int rev = 0;
+        for (int b = 1; b < N; b <<= 1) {
+            rev = (rev << 1) | ((index & b) ? 1 : 0);
+        }
+        return rev;
+    }
+
+    void reorder_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        perf.start(bound_clock_period(clk));
+
+        for (int i = 0; i < N; ++i) {
+            buf[i] = T(0.0, 0.0);
+        }
+        reversed = false;
+        primed = false;
+
+        wait();
+
+        while (true) {
+            // Read-before-write at the same address frees the slot for the next frame
+            for (int i = 0; i < N; ++i) {
+                T input = perf.pop(in_data);
+                int addr = reversed ? reverse_bits(i) : i;
+
+                if (primed) {
+                    perf.push(out_data, buf[addr]);
+                }
+
+                buf[addr] = input;
+            }
+            primed = true;
+            reversed = !reversed;
+        }
+    }
+
+    SC_CTOR(Reorder)
+        : clk("clk"),
+          rst_n("rst_n"),
+          in_data("in_data"),
+          out_data("out_data"),
+          buf(N, T(0.0, 0.0)),
+          reversed(false),
+          primed(false)
+    {
+        SC_THREAD(reorder_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // REORDER_H
@@ -0,0 +1,181 @@
+/*
+ * spectrum_multiply.h
+ *
+ * Filter path of the fast-convolution chain. FilterRoute sits in front of the forward FFT
+ * and steers the beats the DMA sends while filter_load is set (one frame of filter
+ * spectrum) to the filter multiply instead of the FFT. SpectrumMultiply keeps that spectrum
+ * in an N-entry coefficient RAM and multiplies the natural-order bins of every frame by it,
+ * bin k of a frame by coefficient k. A product issues on a ButterflyScheduler datapath of
+ * the stage ALU configuration; both blocks register one beat and hold no samples back.
+ */
+
+#ifndef SPECTRUM_MULTIPLY_H
+#define SPECTRUM_MULTIPLY_H
+
+#include "fft_types.h"
+#include "perf_counters.h"
+#include "butterfly_scheduler.h"
+#include <connections/connections.h>
+#include <vector>
+
+using namespace Connections;
+
+// Demultiplexer of the DMA stream into FFT frames and filter spectra
+template<typename T = complex_t>
+SC_MODULE(FilterRoute) {
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+    sc_in<bool> filter_load; // Beats taken now belong to a filter spectrum
+
+    In<T> in_data;
+    Out<T> out_data;   // To the forward FFT
+    Out<T> filter_out; // To the filter multiply
+
+    StreamCounters perf;
+
+    void route_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        filter_out.Reset();
+        perf.start(bound_clock_period(clk));
+
+        T held;
+        bool have = false;
+        bool to_filter = false;
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+
+            if (have) {
+                if (to_filter ? filter_out.PushNB(held) : out_data.PushNB(held)) {
+                    have = false;
+                    perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            if (!have) {
+                if (in_data.PopNB(held)) {
+                    have = true;
+                    to_filter = filter_load.read();
+                    perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            wait();
+        }
+    }
+
+    SC_HAS_PROCESS(FilterRoute);
+    FilterRoute(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        filter_load("filter_load"),
+        in_data("in_data"),
+        out_data("out_data"),
+        filter_out("filter_out")
+    {
+        SC_THREAD(route_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+// Pointwise multiply of N-bin natural-order frames by a stored filter spectrum
+template<int N, int NUM_MULT = 4, int NUM_ADD = 6, typename T = complex_t>
+SC_MODULE(SpectrumMultiply) {
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    In<T> coeff_in; // Filter spectrum, bin 0 first
+    Out<T> out_data;
+
+    StreamCounters perf;
+
+    ButterflyScheduler sched;
+    std::vector<T> coeffs;
+
+    void multiply_thread() {
+        in_data.Reset();
+        coeff_in.Reset();
+        out_data.Reset();
+        perf.start(bound_clock_period(clk));
+        sched.reset();
+
+        T held;
+        bool have = false;
+        int bin = 0;
+        int loaded = 0; // Next coefficient to load
+        unsigned long cycle = 0;
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+
+            T c;
+            if (coeff_in.PopNB(c)) {
+                coeffs[loaded] = c;
+                loaded = (loaded + 1) % N;
+            }
+
+            if (have) {
+                if (out_data.PushNB(held)) {
+                    have = false;
+                    perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            if (!have && sched.can_issue(cycle)) {
+                T input;
+                if (in_data.PopNB(input)) {
+                    held = input * coeffs[bin];
+                    have = true;
+                    sched.issue(cycle);
+                    bin = (bin + 1) % N;
+                    perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            wait();
+            cycle++;
+        }
+    }
+
+    SC_HAS_PROCESS(SpectrumMultiply);
+    SpectrumMultiply(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        coeff_in("coeff_in"),
+        out_data("out_data"),
+        sched(NUM_MULT, NUM_ADD),
+        coeffs(N, T(0.0, 0.0))
+    {
+        SC_THREAD(multiply_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // SPECTRUM_MULTIPLY_H
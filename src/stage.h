@@ -3,134 +3,443 @@
  *
  * Implementation of a single Decimation-In-Frequency (DIF) radix-2 butterfly stage.
  * Alternates between storing the first half of incoming data in a feedback delay buffer
- * and executing butterfly calculations on the second half using local twiddle factor lookups.
+ * and executing butterfly calculations on the second half using strided lookups into the
+ * shared twiddle ROM.
+ * With fewer multipliers/adders than a single-cycle butterfly needs, the ButterflyScheduler
+ * issues a butterfly every interval() cycles into a pipelined ALU and the stage keeps
+ * accepting samples while earlier results are in flight.
+ * The sample type T is either complex_t (double), complex_fixed_t<W, I> (bit-accurate) or
+ * complex_bfp_t<W, I>, whose stages pick the divide-by-2 of every frame from the headroom
+ * left in the previous non-zero one, starting out scaled (block floating point).
+ * A run-time FFT length shorter than the cascade bypasses the stages larger than it: the
+ * remaining stages compute the shorter transform unchanged, as their twiddles only depend
+ * on their own size.
+ * Pruning frees the ALU slot of butterflies whose result is known or unused: with
+ * prune_zeros set, a butterfly on two zero operands (zero padding and flush frames), and
+ * with a bin range, every butterfly of a block whose outputs only reach bins outside it.
+ * The results are still evaluated so that the stream keeps the values of the full
+ * transform; only the schedule, and with it the cycles of an ALU-limited stage, changes.
+ * In inverse mode a stage multiplies by the conjugated twiddles and scales every butterfly
+ * by 1/2, so the cascade computes the inverse transform including its 1/N.
  */
 
 #ifndef STAGE_H
 #define STAGE_H
 
 #include "fft_types.h"
+#include "twiddle_rom.h"
+#include "perf_counters.h"
+#include "butterfly_scheduler.h"
 #include <connections/connections.h>
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <vector>
+#include <deque>
 
 using namespace Connections;
 
 // Base class for FFT pipeline stages
+template<typename T = complex_t>
 class StageBase : public sc_module {
 public:
-    StageBase(sc_module_name name) : sc_module(name) {}
+    StageBase(sc_module_name name) :
+        sc_module(name), fft_len("fft_len"), prune_zeros("prune_zeros"), bin_lo("bin_lo"),
+        bin_hi("bin_hi"), inverse("inverse") {}
     virtual ~StageBase() {}
-    virtual In<complex_t>& get_in_port() = 0;
-    virtual Out<complex_t>& get_out_port() = 0;
+    virtual In<T>& get_in_port() = 0;
+    virtual Out<T>& get_out_port() = 0;
+
+    // Run-time FFT length (optional, unbound: the full length of the cascade)
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> fft_len;
+
+    // Pruning (optional, unbound: off): skip butterflies on zero operands, and those that
+    // only feed bins outside [bin_lo, bin_hi) of the frame (bin_hi <= 0: up to the last bin)
+    sc_port<sc_signal_in_if<bool>, 1, SC_ZERO_OR_MORE_BOUND> prune_zeros;
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> bin_lo;
+    sc_port<sc_signal_in_if<int>, 1, SC_ZERO_OR_MORE_BOUND> bin_hi;
+
+    // Inverse transform (optional, unbound: forward)
+    sc_port<sc_signal_in_if<bool>, 1, SC_ZERO_OR_MORE_BOUND> inverse;
+
+    StreamCounters perf; // Busy/starved/back-pressured cycles of the stage thread
+
+protected:
+    // Sample waiting for the output port of the pipelined ALU path
+    struct PendingSample {
+        T value;
+        unsigned long ready; // First cycle it may be pushed
+    };
+
+    std::deque<PendingSample> pending;
+    unsigned long cycle;
+
+    void reset_schedule(ButterflyScheduler& sched) {
+        pending.clear();
+        cycle = 0;
+        sched.reset();
+    }
+
+    // FFT length in force, full_len while fft_len is unbound
+    int frame_len(int full_len) const {
+        return (fft_len.size() > 0) ? fft_len->read() : full_len;
+    }
+
+    // Block head hook of stages that are always in the path
+    struct AlwaysActive {
+        bool operator()() const { return true; }
+    };
+
+    // Butterflies of the block in progress that need no ALU slot
+    struct Pruning {
+        bool zeros;      // Both operands zero
+        bool skip_block; // The block only feeds unselected bins
+
+        Pruning() : zeros(false), skip_block(false) {}
+
+        bool active() const { return zeros || skip_block; }
+
+        bool operator()(const T& a, const T& b) const {
+            return skip_block || (zeros && is_zero(a) && is_zero(b));
+        }
+    };
+
+    bool zero_pruning() const {
+        return prune_zeros.size() > 0 && prune_zeros->read();
+    }
+
+    bool inverse_mode() const {
+        return inverse.size() > 0 && inverse->read();
+    }
+
+    // Whether block `block` of a stage of size m in a len-point frame feeds a bin of the
+    // selected range: its outputs end up at positions block * m .. block * m + m - 1 of the
+    // bit-reversed frame, which hold the bins congruent to bitrev(block) modulo len / m
+    bool block_selected(int block, int m, int len) const {
+        if (bin_lo.size() == 0 || bin_hi.size() == 0) {
+            return true;
+        }
+        int lo = std::max(bin_lo->read(), 0);
+        int hi = (bin_hi->read() <= 0) ? len : std::min(bin_hi->read(), len);
+        int stride = len / m;
+        int first = 0;
+        for (int b = 1; b < stride; b <<= 1) {
+            first = (first << 1) | ((block & b) ? 1 : 0);
+        }
+        int k = lo + ((first - lo) % stride + stride) % stride; // First such bin from lo
+        return k < hi;
+    }
+
+    // One block of delay_len store & forward steps and delay_len butterflies on a pipelined
+    // ALU: one transfer per port and cycle, butterflies issued every sched.interval() and
+    // retired sched.latency() cycles later, in order. Inputs stall only while sched.depth()
+    // results are waiting. bf(k, a, b, sum, diff) is the butterfly arithmetic. head() is
+    // called on the first input of the block; if it returns false the stage is bypassed,
+    // that input is forwarded as is and false is returned. Butterflies that prune selects
+    // retire without an ALU slot; while pruning is active an input is taken before a slot
+    // is free, and held until it gets one unless its butterfly is pruned.
+    template<typename Butterfly, typename Head = AlwaysActive>
+    bool scheduled_block(In<T>& in, Out<T>& out, T* buf, int delay_len,
+                         const bool& emit_stored, ButterflyScheduler& sched, Butterfly bf,
+                         Head head = Head(), const Pruning& prune = Pruning()) {
+        int step = 0;
+        bool held = false; // Butterfly input waiting for an ALU slot
+        T input;
+        while (step < 2 * delay_len) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+
+            if (!pending.empty() && pending.front().ready <= cycle) {
+                if (out.PushNB(pending.front().value)) {
+                    pending.pop_front();
+                    perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            bool compute = (step >= delay_len);
+            if ((int)pending.size() < sched.depth()) {
+                if (!held && (!compute || prune.active() || sched.can_issue(cycle))) {
+                    if (in.PopNB(input)) {
+                        perf.samples_in++;
+                        transfer = true;
+                        if (step == 0 && !head()) {
+                            pending.push_back({input, cycle});
+                            perf.book_cycle(transfer, starved, blocked);
+                            this->wait();
+                            cycle++;
+                            return false;
+                        }
+                        held = true;
+                    } else {
+                        starved = true;
+                    }
+                }
+                if (held && !compute) {
+                    if (emit_stored) {
+                        pending.push_back({buf[step], cycle});
+                    }
+                    buf[step] = input;
+                    held = false;
+                    step++;
+                } else if (held) {
+                    int k = step - delay_len;
+                    bool pruned = prune(buf[k], input);
+                    if (pruned || sched.can_issue(cycle)) {
+                        T sum, diff;
+                        bf(k, buf[k], input, sum, diff);
+                        if (pruned) {
+                            pending.push_back({sum, cycle});
+                            perf.pruned_butterflies++;
+                        } else {
+                            pending.push_back({sum, sched.issue(cycle)});
+                        }
+                        buf[k] = diff;
+                        held = false;
+                        step++;
+                    }
+                }
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            this->wait();
+            cycle++;
+        }
+        return true;
+    }
+};
+
+// Block-floating-point scaling control of a stage. All butterflies of a frame share one
+// divide-by-2 decision, so every frame leaves with a single exponent. The decision is taken
+// at the first butterfly of a frame from the headroom (redundant sign bits) of the previous
+// frame's results, corrected for the scaling it had and for the exponent change of the
+// inputs by the stages upstream: the stage scales unless the results would keep a bit of
+// headroom unscaled. Saturation counts as no headroom. A stage starts out scaled, where no
+// result outgrows the magnitude of its inputs, and a frame of zeros (flush frames, zero
+// padding) leaves the decision as it is, so a loud frame after one only meets a stage that
+// adapted to data. Frames that still saturate a stage are flagged.
+class BlockScaler {
+public:
+    BlockScaler(int frame_bfs = 1) { reset(frame_bfs); }
+
+    void reset(int bfs) {
+        frame_bfs = bfs;
+        count = 0;
+        scaled = true;
+        frame_exp = 0;
+        headroom = 0;
+        nonzero = false;
+    }
+
+    // Decision for the next butterfly, on inputs of exponent exp
+    bool next(int exp) {
+        if (count == frame_bfs) {
+            if (nonzero) {
+                int unscaled = headroom - (scaled ? 1 : 0) - (frame_exp - exp);
+                scaled = unscaled < 1;
+            }
+            count = 0;
+        }
+        if (count == 0) {
+            frame_exp = exp;
+            headroom = max_headroom;
+            nonzero = false;
+        }
+        count++;
+        return scaled;
+    }
+
+    // Results of the butterfly on (a, b); saturation it caused leaves no headroom
+    template<typename T>
+    void observe(const T& a, const T& b, const T& sum, const T& diff) {
+        bool saturated = (sum.sat || diff.sat) && !(a.sat || b.sat);
+        int h = saturated ? -1 : std::min(sum.headroom_bits(), diff.headroom_bits());
+        headroom = std::min(headroom, h);
+        nonzero = nonzero || !is_zero(sum) || !is_zero(diff);
+    }
+
+private:
+    static const int max_headroom = 64;
+
+    int frame_bfs; // Butterflies per frame
+    int count;
+    bool scaled;
+    int frame_exp; // Input exponent of the frame in progress
+    int headroom;  // Least headroom of its results so far
+    bool nonzero;  // Any of its results is non-zero
 };
 
-// A single pipeline stage of the Decimation-in-Frequency FFT.
-template<int N_STAGE>
-class Stage : public StageBase {
+// A single pipeline stage of the Decimation-in-Frequency FFT. In a P-parallel FFT it
+// carries one of LANES interleaved streams, on a delay line of 1/LANES the length.
+template<int N_STAGE, typename T = complex_t, int LANES = 1>
+class Stage : public StageBase<T> {
+    static_assert(N_STAGE >= 2 * LANES, "A lane stage pairs samples at least LANES apart");
+
 public:
     sc_in<bool> clk;
     sc_in<bool> rst_n;
     
-    In<complex_t> in_data;
-    Out<complex_t> out_data;
+    In<T> in_data;
+    Out<T> out_data;
 
-    In<complex_t>& get_in_port() override { return in_data; }
-    Out<complex_t>& get_out_port() override { return out_data; }
+    In<T>& get_in_port() override { return in_data; }
+    Out<T>& get_out_port() override { return out_data; }
     
     int delay_len;
-    int alu_cycles;
+    ButterflyScheduler sched; // Butterfly issue interval and latency under the ALU limits
+    bool scale; // Divide butterfly outputs by 2 (growth control)
     
-    std::vector<complex_t> buf;
-    std::vector<complex_t> twiddles;
+    std::array<T, N_STAGE / 2 / LANES> buf; // Delay line
+    const TwiddleRom& rom;
+    int rom_stride; // W_N_STAGE^k = W_rom^(k * rom_stride)
+    int lane;       // P-parallel FFT: the stage carries lane `lane` of LANES interleaved streams
+    int full_len;   // FFT length of the cascade
+    int active_len; // FFT length the delay line holds samples of
+    int block;      // Block of the frame the next input starts
     bool has_valid_diffs;
+    bool conj_twiddles; // The block in progress belongs to an inverse transform
+    typename StageBase<T>::Pruning prune; // Pruning of the block in progress
+
+    BlockScaler bfp; // Frame-level scaling of a block-floating-point datapath
+
+    void compute(int k, const T& val_a, const T& val_b, T& sum, T& diff) {
+        // Twiddle factor lookup (butterfly k of a lane is butterfly k * LANES + lane of the stage)
+        T w = rom.template lookup<T>((k * LANES + lane) * rom_stride);
+        if constexpr (bfp_traits<T>::enabled) {
+            bool frame_scaled = bfp.next(val_a.exp.to_int());
+            butterfly(val_a, val_b, scale || frame_scaled, sum, diff);
+            diff = diff * w;
+            bfp.observe(val_a, val_b, sum, diff);
+        } else {
+            butterfly(val_a, val_b, scale || conj_twiddles, sum, diff);
+            diff = diff * (conj_twiddles ? w.conj() : w);
+        }
+    }
+
+    // First input of a block: a change of the run-time length starts over from an empty
+    // delay line (the DMA drains the pipeline before it changes the length). Returns false
+    // while the stage is larger than the FFT length and bypassed. Takes the pruning of the
+    // block (bin ranges on a single lane only) and its direction (not on block floating point).
+    bool block_head() {
+        int len = this->frame_len(full_len);
+        if (len != active_len) {
+            active_len = len;
+            has_valid_diffs = false;
+            bfp.reset(len / 2 / LANES);
+            block = 0;
+        }
+        if (N_STAGE > len) {
+            return false;
+        }
+        conj_twiddles = !bfp_traits<T>::enabled && this->inverse_mode();
+        prune.zeros = this->zero_pruning();
+        prune.skip_block = (LANES == 1) && !this->block_selected(block, N_STAGE, len);
+        block = (block + 1) % (len / N_STAGE);
+        return true;
+    }
     
     void stage_thread() {
         in_data.Reset();
         out_data.Reset();
+        this->perf.start(bound_clock_period(clk));
+        this->reset_schedule(sched);
+        active_len = full_len;
+        block = 0;
+        conj_twiddles = false;
+        bfp.reset(full_len / 2 / LANES);
         
         // Initialize delay buffer
         for (int i = 0; i < delay_len; ++i) {
-            buf[i] = complex_t(0.0, 0.0);
+            buf[i] = T(0.0, 0.0);
         }
         has_valid_diffs = false;
         
-        wait();
+        this->wait();
         
         while (true) {
+            if (sched.pipelined()) {
+                if (this->scheduled_block(in_data, out_data, buf.data(), delay_len, has_valid_diffs, sched,
+                        [this](int k, const T& a, const T& b, T& sum, T& diff) { compute(k, a, b, sum, diff); },
+                        [this]() { return block_head(); }, prune)) {
+                    has_valid_diffs = true;
+                }
+                continue;
+            }
+
+            // A bypassed stage forwards every input
+            T head = this->perf.pop(in_data);
+            if (!block_head()) {
+                this->perf.push(out_data, head);
+                continue;
+            }
+
             // Phase 1: Store & Forward
             // Buffer incoming inputs while pushing out stored differences
             for (int c = 0; c < delay_len; ++c) {
-                complex_t input = in_data.Pop();
+                T input = (c == 0) ? head : this->perf.pop(in_data);
                 
                 if (has_valid_diffs) {
-                    complex_t output_val = buf[c];
-                    out_data.Push(output_val);
+                    T output_val = buf[c];
+                    this->perf.push(out_data, output_val);
                 }
                 
                 buf[c] = input;
             }
             
             // Phase 2: Compute
-            // Radix-2 butterfly computations on second half of block
+            // Radix-2 butterfly computations on second half of block (the single-cycle ALU
+            // gains no cycles from pruning, the count gives the ALU activity it saves)
             for (int k = 0; k < delay_len; ++k) {
-                complex_t val_b = in_data.Pop();
-                complex_t val_a = buf[k];
-                
-                // Twiddle factor lookup
-                complex_t w = twiddles[k];
-                
-                // Butterfly latency cycles
-                if (alu_cycles > 1) {
-                    wait(alu_cycles - 1);
+                T val_b = this->perf.pop(in_data);
+                if (prune(buf[k], val_b)) {
+                    this->perf.pruned_butterflies++;
                 }
-                
-                complex_t sum = val_a + val_b;
-                complex_t diff = (val_a - val_b) * w;
-                
-                out_data.Push(sum);
+                T sum, diff;
+                compute(k, buf[k], val_b, sum, diff);
+                this->perf.push(out_data, sum);
                 buf[k] = diff;
             }
             has_valid_diffs = true;
         }
     }
     
-    // Compute cycles based on hardware resource limits
+    // Butterfly latency under hardware resource limits
     static int calc_latency(int n_mult, int n_add) {
-        if (n_mult >= 4 && n_add >= 6) {
-            return 1; // Single-cycle butterfly
-        } else {
-            int adds1 = (4 + n_add - 1) / n_add;
-            int mults = (4 + n_mult - 1) / n_mult;
-            int adds2 = (2 + n_add - 1) / n_add;
-            return adds1 + mults + adds2;
-        }
+        return ButterflyScheduler(n_mult, n_add).latency();
+    }
+
+    // Cycles between butterflies under hardware resource limits
+    static int calc_interval(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add).interval();
     }
     
     SC_HAS_PROCESS(Stage);
-    Stage(sc_module_name name, int n_mult = 4, int n_add = 6) : 
-        StageBase(name),
+    Stage(sc_module_name name, int n_mult = 4, int n_add = 6, bool scale = false, int rom_n = N_STAGE,
+          int lane = 0) : 
+        StageBase<T>(name),
         clk("clk"),
         rst_n("rst_n"),
         in_data("in_data"),
         out_data("out_data"),
-        delay_len(N_STAGE / 2),
-        buf(N_STAGE / 2, complex_t(0, 0)),
-        has_valid_diffs(false)
+        delay_len(N_STAGE / 2 / LANES),
+        sched(n_mult, n_add),
+        scale(scale),
+        rom(TwiddleRom::instance(rom_n)),
+        lane(lane),
+        full_len(rom_n),
+        active_len(rom_n),
+        block(0),
+        has_valid_diffs(false),
+        conj_twiddles(false),
+        bfp(rom_n / 2 / LANES)
     {
-        alu_cycles = calc_latency(n_mult, n_add);
-        
-        // Precalculate twiddle table
-        twiddles.resize(delay_len);
-        const double PI = 3.14159265358979323846;
-        for (int k = 0; k < delay_len; ++k) {
-            double angle = -2.0 * PI * k / N_STAGE;
-            twiddles[k] = complex_t(cos(angle), sin(angle));
-        }
+        rom_stride = rom.size() / N_STAGE;
         
         SC_THREAD(stage_thread);
-        sensitive << clk.pos();
-        async_reset_signal_is(rst_n, false); // Active-low reset
+        this->sensitive << clk.pos();
+        this->async_reset_signal_is(rst_n, false); // Active-low reset
     }
 };
 
@@ -0,0 +1,254 @@
+/*
+ * stage_r22.h
+ *
+ * Radix-2^2 single-path delay feedback (R2^2SDF) butterfly stages.
+ * A radix-2^2 stage pair replaces two consecutive radix-2 stages of sizes M and M/2:
+ * the first butterfly (BF2I) only applies the trivial -j rotation, and the second
+ * butterfly (BF2II) carries all twiddle multipliers of the pair. The saving is in
+ * multiplier instances (one stage of the pair has none) rather than multiplications:
+ * BF2II rotates both outputs of its lower half blocks and the differences of the upper
+ * ones (their sum twiddle is W^0 and skipped), 3/4 of the samples, where the two radix-2
+ * stages it replaces rotate half of the samples each.
+ * Output ordering is identical to the radix-2 cascade (bit-reversed).
+ */
+
+#ifndef STAGE_R22_H
+#define STAGE_R22_H
+
+#include "fft_types.h"
+#include "stage.h"
+#include "twiddle_rom.h"
+#include "butterfly_scheduler.h"
+#include <connections/connections.h>
+#include <array>
+#include <cmath>
+
+using namespace Connections;
+
+// First butterfly of a radix-2^2 pair: multiplier-less, rotates the last quarter by -j.
+template<int N_STAGE, typename T = complex_t>
+class StageR22I : public StageBase<T> {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    In<T>& get_in_port() override { return in_data; }
+    Out<T>& get_out_port() override { return out_data; }
+
+    int delay_len;
+    ButterflyScheduler sched; // Butterfly issue interval and latency under the adder limit
+    bool scale; // Divide butterfly outputs by 2 (growth control)
+
+    std::array<T, N_STAGE / 2> buf; // Delay line
+    bool has_valid_diffs;
+
+    void compute(int k, const T& val_a, const T& val_b, T& sum, T& diff) const {
+        butterfly(val_a, val_b, scale, sum, diff);
+        if (k >= delay_len / 2) {
+            diff = diff.mul_neg_j();
+        }
+    }
+
+    void stage_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        this->perf.start(bound_clock_period(clk));
+        this->reset_schedule(sched);
+
+        // Initialize delay buffer
+        for (int i = 0; i < delay_len; ++i) {
+            buf[i] = T(0.0, 0.0);
+        }
+        has_valid_diffs = false;
+
+        this->wait();
+
+        while (true) {
+            if (sched.pipelined()) {
+                this->scheduled_block(in_data, out_data, buf.data(), delay_len, has_valid_diffs, sched,
+                    [this](int k, const T& a, const T& b, T& sum, T& diff) { compute(k, a, b, sum, diff); });
+                has_valid_diffs = true;
+                continue;
+            }
+
+            // Phase 1: Store & Forward
+            for (int c = 0; c < delay_len; ++c) {
+                T input = this->perf.pop(in_data);
+
+                if (has_valid_diffs) {
+                    this->perf.push(out_data, buf[c]);
+                }
+
+                buf[c] = input;
+            }
+
+            // Phase 2: Compute
+            // Differences in the second quarter are rotated by -j (real/imag swap)
+            for (int k = 0; k < delay_len; ++k) {
+                T val_b = this->perf.pop(in_data);
+                T sum, diff;
+                compute(k, buf[k], val_b, sum, diff);
+                this->perf.push(out_data, sum);
+                buf[k] = diff;
+            }
+            has_valid_diffs = true;
+        }
+    }
+
+    // Butterfly latency under hardware resource limits (adders only)
+    static int calc_latency(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add, ButterflyScheduler::BF2I).latency();
+    }
+
+    // Cycles between butterflies under hardware resource limits
+    static int calc_interval(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add, ButterflyScheduler::BF2I).interval();
+    }
+
+    SC_HAS_PROCESS(StageR22I);
+    StageR22I(sc_module_name name, int n_mult = 4, int n_add = 6, bool scale = false) :
+        StageBase<T>(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        out_data("out_data"),
+        delay_len(N_STAGE / 2),
+        sched(n_mult, n_add, ButterflyScheduler::BF2I),
+        scale(scale),
+        has_valid_diffs(false)
+    {
+        SC_THREAD(stage_thread);
+        this->sensitive << clk.pos();
+        this->async_reset_signal_is(rst_n, false); // Active-low reset
+    }
+};
+
+// Second butterfly of a radix-2^2 pair: processes blocks of N_STAGE/2 and applies
+// the combined twiddle W_N^(k*m), m = 2*is_diff + half, on every output but the sums of
+// the upper half (m = 0).
+template<int N_STAGE, typename T = complex_t>
+class StageR22II : public StageBase<T> {
+public:
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    In<T>& get_in_port() override { return in_data; }
+    Out<T>& get_out_port() override { return out_data; }
+
+    int delay_len;
+    ButterflyScheduler sched;       // Butterfly schedule of lower half blocks (both outputs twiddled)
+    ButterflyScheduler sched_upper; // Upper half blocks: the sum twiddle is W^0, as in radix-2
+    bool scale; // Divide butterfly outputs by 2 (growth control)
+
+    std::array<T, N_STAGE / 4> buf; // Delay line
+    const TwiddleRom& rom;
+    int rom_stride; // W_N_STAGE^j = W_rom^(j * rom_stride)
+    bool has_valid_diffs;
+    int half; // 0: upper (sum) half of the BF2I block, 1: lower (difference) half
+
+    void compute(int k, const T& val_a, const T& val_b, T& sum, T& diff) const {
+        butterfly(val_a, val_b, scale, sum, diff);
+        if (half) {
+            sum = sum * rom.template lookup<T>(k * rom_stride);
+        }
+        diff = diff * rom.template lookup<T>(k * (2 + half) * rom_stride);
+    }
+
+    void stage_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        this->perf.start(bound_clock_period(clk));
+        this->reset_schedule(sched);
+        sched_upper.reset();
+
+        // Initialize delay buffer
+        for (int i = 0; i < delay_len; ++i) {
+            buf[i] = T(0.0, 0.0);
+        }
+        has_valid_diffs = false;
+        half = 0;
+
+        this->wait();
+
+        while (true) {
+            // The lower half schedule is the longer one: pipelined whenever the upper one is
+            if (sched.pipelined()) {
+                ButterflyScheduler& block_sched = half ? sched : sched_upper;
+                block_sched.take_over(half ? sched_upper : sched);
+                this->scheduled_block(in_data, out_data, buf.data(), delay_len, has_valid_diffs, block_sched,
+                    [this](int k, const T& a, const T& b, T& sum, T& diff) { compute(k, a, b, sum, diff); });
+                has_valid_diffs = true;
+                half ^= 1;
+                continue;
+            }
+
+            // Phase 1: Store & Forward
+            for (int c = 0; c < delay_len; ++c) {
+                T input = this->perf.pop(in_data);
+
+                if (has_valid_diffs) {
+                    this->perf.push(out_data, buf[c]);
+                }
+
+                buf[c] = input;
+            }
+
+            // Phase 2: Compute
+            // Butterfly followed by the pair's shared twiddle multiplier
+            for (int k = 0; k < delay_len; ++k) {
+                T val_b = this->perf.pop(in_data);
+                T sum, diff;
+                compute(k, buf[k], val_b, sum, diff);
+                this->perf.push(out_data, sum);
+                buf[k] = diff;
+            }
+            has_valid_diffs = true;
+            half ^= 1;
+        }
+    }
+
+    // Butterfly latency under hardware resource limits (lower half blocks, the longer one)
+    static int calc_latency(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add, ButterflyScheduler::BF2II).latency();
+    }
+
+    // Cycles between butterflies of lower half blocks under hardware resource limits
+    static int calc_interval(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add, ButterflyScheduler::BF2II).interval();
+    }
+
+    // Cycles between butterflies of upper half blocks
+    static int calc_upper_interval(int n_mult, int n_add) {
+        return ButterflyScheduler(n_mult, n_add).interval();
+    }
+
+    SC_HAS_PROCESS(StageR22II);
+    StageR22II(sc_module_name name, int n_mult = 4, int n_add = 6, bool scale = false, int rom_n = N_STAGE) :
+        StageBase<T>(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        in_data("in_data"),
+        out_data("out_data"),
+        delay_len(N_STAGE / 4),
+        sched(n_mult, n_add, ButterflyScheduler::BF2II),
+        sched_upper(n_mult, n_add),
+        scale(scale),
+        rom(TwiddleRom::instance(rom_n)),
+        has_valid_diffs(false),
+        half(0)
+    {
+        rom_stride = rom.size() / N_STAGE;
+
+        SC_THREAD(stage_thread);
+        this->sensitive << clk.pos();
+        this->async_reset_signal_is(rst_n, false); // Active-low reset
+    }
+};
+
+#endif // STAGE_R22_H
@@ -0,0 +1,371 @@
+/*
+ * tlm_top.h
+ *
+ * Loosely-timed TLM-2.0 fast functional model of the multi-core FFT (Top).
+ * Every core moves a whole job with one blocking read and one blocking write transaction
+ * and computes each N-point frame at once, applying the butterflies, twiddle lookups and
+ * scaling of the Stage / StageR22I / StageR22II cascade in the same order so the outputs
+ * match the cycle-accurate model bit for bit. Timing is annotated from the DMA pipeline
+ * latency and stage throughput, and cores run ahead of the kernel with a quantum keeper.
+ */
+
+#ifndef TLM_TOP_H
+#define TLM_TOP_H
+
+#include <systemc.h>
+#include <tlm.h>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/multi_passthrough_target_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <axi/axi4.h>
+#include "fft_types.h"
+#include "twiddle_rom.h"
+#include "dma.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace sc_core;
+
+// Frame-at-once DIF transform with the arithmetic of the FFT stage cascade
+template<int N, int RADIX = 2, typename T = complex_t, unsigned SCALE_MASK = 0, bool NATURAL_ORDER = false>
+struct BlockFFT {
+    static bool stage_scaled(int index) {
+        return (SCALE_MASK >> index) & 1u;
+    }
+
+    // Radix-2 stage (Stage<M>) on one block of M samples
+    static void radix2(T* x, int m, int index, const TwiddleRom& rom) {
+        int half = m / 2;
+        int stride = rom.size() / m;
+        for (int k = 0; k < half; ++k) {
+            T sum, diff;
+            butterfly(x[k], x[k + half], stage_scaled(index), sum, diff);
+            x[k] = sum;
+            x[k + half] = diff * rom.template lookup<T>(k * stride);
+        }
+    }
+
+    // Radix-2^2 pair (StageR22I<M> + StageR22II<M>) on one block of M samples
+    static void radix22(T* x, int m, int index, const TwiddleRom& rom) {
+        int half = m / 2;
+        int quarter = m / 4;
+        for (int k = 0; k < half; ++k) {
+            T sum, diff;
+            butterfly(x[k], x[k + half], stage_scaled(index), sum, diff);
+            x[k] = sum;
+            x[k + half] = (k >= quarter) ? diff.mul_neg_j() : diff;
+        }
+        int stride = rom.size() / m;
+        for (int h = 0; h < 2; ++h) {
+            T* y = x + h * half;
+            for (int k = 0; k < quarter; ++k) {
+                T sum, diff;
+                butterfly(y[k], y[k + quarter], stage_scaled(index + 1), sum, diff);
+                y[k] = h ? sum * rom.template lookup<T>(k * stride) : sum;
+                y[k + quarter] = diff * rom.template lookup<T>(k * (2 + h) * stride);
+            }
+        }
+    }
+
+    // Transform one frame in place; the result is in the output order of the pipeline
+    static void transform(T* x) {
+        if (N == 1) {
+            return;
+        }
+        const TwiddleRom& rom = TwiddleRom::instance(N);
+        int m = N;
+        int index = 0;
+        while (m >= 2) {
+            bool pair = (RADIX == 4) && (m >= 4);
+            for (int b = 0; b < N; b += m) {
+                if (pair) {
+                    radix22(x + b, m, index, rom);
+                } else {
+                    radix2(x + b, m, index, rom);
+                }
+            }
+            m /= pair ? 4 : 2;
+            index += pair ? 2 : 1;
+        }
+        if (NATURAL_ORDER) {
+            for (int i = 0; i < N; ++i) {
+                int rev = reverse_bits(i);
+                if (i < rev) {
+                    std::swap(x[i], x[rev]);
+                }
+            }
+        }
+    }
+
+    static int reverse_bits(int index) {
+        int rev = 0;
+        for (int b = 1; b < N; b <<= 1) {
+            rev = (rev << 1) | ((index & b) ? 1 : 0);
+        }
+        return rev;
+    }
+};
+
+// Memory target shared by all cores (blocking transport with per-beat latency)
+template<unsigned DEPTH, typename AxiCfg>
+SC_MODULE(TlmMemory) {
+    tlm_utils::multi_passthrough_target_socket<TlmMemory> socket;
+
+    static const int bytesPerBeat = AxiCfg::dataWidth / 8;
+
+    sc_time beat_time;    // Transfer time of one beat
+    sc_time access_time;  // Fixed latency of every transaction
+    std::vector<unsigned char> mem;
+
+    unsigned long reads;
+    unsigned long writes;
+
+    // Backdoor access for preloading and checking
+    void write_word(unsigned int addr, sc_uint<AxiCfg::dataWidth> data) {
+        uint64_t raw = data.to_uint64();
+        std::memcpy(&mem[addr % (DEPTH * bytesPerBeat)], &raw, bytesPerBeat);
+    }
+
+    sc_uint<AxiCfg::dataWidth> read_word(unsigned int addr) const {
+        uint64_t raw = 0;
+        std::memcpy(&raw, &mem[addr % (DEPTH * bytesPerBeat)], bytesPerBeat);
+        return raw;
+    }
+
+    void b_transport(int id, tlm::tlm_generic_payload& trans, sc_time& delay) {
+        uint64_t addr = trans.get_address();
+        unsigned int len = trans.get_data_length();
+        if (addr + len > mem.size() || trans.get_byte_enable_ptr() != nullptr) {
+            trans.set_response_status(addr + len > mem.size() ? tlm::TLM_ADDRESS_ERROR_RESPONSE
+                                                               : tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+        if (trans.is_read()) {
+            std::memcpy(trans.get_data_ptr(), &mem[addr], len);
+            reads++;
+        } else if (trans.is_write()) {
+            std::memcpy(&mem[addr], trans.get_data_ptr(), len);
+            writes++;
+        }
+        delay += access_time + beat_time * (double)((len + bytesPerBeat - 1) / bytesPerBeat);
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+    }
+
+    TlmMemory(sc_module_name name, sc_time beat_time = sc_time(2.0, SC_NS),
+              sc_time access_time = SC_ZERO_TIME)
+        : sc_module(name),
+          socket("socket"),
+          beat_time(beat_time),
+          access_time(access_time),
+          mem(DEPTH * bytesPerBeat, 0),
+          reads(0),
+          writes(0)
+    {
+        socket.register_b_transport(this, &TlmMemory::b_transport);
+    }
+};
+
+// Job of a TLM core (same meaning as a core's base_addr/num_samples)
+struct TlmJob {
+    uint64_t addr;
+    int samples;
+};
+
+// One DMA + FFT core: reads a job, transforms every frame, writes it back to addr + N beats
+template<int N_SIZE, typename AxiCfg, int NUM_MULT = 4, int NUM_ADD = 6, int RADIX = 2,
+         typename T = complex_t, unsigned SCALE_MASK = 0, bool NATURAL_ORDER = false>
+SC_MODULE(TlmCore) {
+    static_assert(!bfp_traits<T>::enabled, "The TLM model has no block-floating-point datapath");
+
+    tlm_utils::simple_initiator_socket<TlmCore> socket;
+
+    typedef DMA<AxiCfg, N_SIZE, NUM_MULT, NUM_ADD, RADIX, T, dma_cfg::standard, NATURAL_ORDER> Dma;
+    typedef BlockFFT<N_SIZE, RADIX, T, SCALE_MASK, NATURAL_ORDER> Transform;
+
+    static const int bytesPerBeat = AxiCfg::dataWidth / 8;
+
+    sc_time clk_period;
+    sc_time start_offset; // Delay before the first job (HOP stagger)
+    tlm_utils::tlm_quantumkeeper qk;
+
+    std::deque<TlmJob> jobs;
+    sc_event job_event;
+
+    // Statistics
+    unsigned long jobs_done;
+    unsigned long frames_done;
+    sc_time done_time; // Last output of the last finished job written
+    bool busy;
+    bool errors;
+
+    void submit(uint64_t addr, int samples) {
+        TlmJob job = { addr, samples };
+        jobs.push_back(job);
+        job_event.notify(SC_ZERO_TIME);
+    }
+
+    // Work still queued on this core in cycles, plus one for a running job (adaptive placement)
+    unsigned long pending_cycles() const {
+        unsigned long cycles = busy ? 1 : 0;
+        for (const TlmJob& job : jobs) {
+            cycles += job_cycles(job.samples);
+        }
+        return cycles;
+    }
+
+    // Cycles the slowest stage needs for the frames of a job: half of every block is
+    // buffered at one sample per cycle, the other half computed at the butterfly
+    // initiation interval of the ALU (radix-2^2: the BF2II stages, whose lower half blocks
+    // twiddle both outputs)
+    static unsigned long job_cycles(int samples) {
+        unsigned long aligned = ((samples + N_SIZE - 1) / N_SIZE) * N_SIZE;
+        if (N_SIZE == 1) {
+            return aligned;
+        }
+        if (RADIX == 4 && N_SIZE >= 4) {
+            int lower = StageR22II<4>::calc_interval(NUM_MULT, NUM_ADD);
+            int upper = StageR22II<4>::calc_upper_interval(NUM_MULT, NUM_ADD);
+            return aligned / 2 + (aligned / 4) * (lower + upper);
+        }
+        int interval = Stage<2>::calc_interval(NUM_MULT, NUM_ADD);
+        return aligned / 2 + (aligned / 2) * interval;
+    }
+
+    bool transport(tlm::tlm_command cmd, uint64_t addr, std::vector<unsigned char>& data, sc_time& delay) {
+        tlm::tlm_generic_payload trans;
+        trans.set_command(cmd);
+        trans.set_address(addr);
+        trans.set_data_ptr(data.data());
+        trans.set_data_length(data.size());
+        trans.set_streaming_width(data.size());
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_dmi_allowed(false);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        socket->b_transport(trans, delay);
+        if (trans.is_response_error()) {
+            std::cout << name() << ": " << trans.get_response_string() << " at 0x"
+                      << std::hex << addr << std::dec << std::endl;
+            errors = true;
+            return false;
+        }
+        return true;
+    }
+
+    void run_job(const TlmJob& job) {
+        int aligned = ((job.samples + N_SIZE - 1) / N_SIZE) * N_SIZE;
+        std::vector<unsigned char> bytes(job.samples * bytesPerBeat);
+        std::vector<T> frames(aligned, T(0.0, 0.0));
+
+        sc_time local = qk.get_local_time();
+        sc_time read_delay = local;
+        transport(tlm::TLM_READ_COMMAND, job.addr, bytes, read_delay);
+        for (int i = 0; i < job.samples; ++i) {
+            uint64_t raw = 0;
+            std::memcpy(&raw, &bytes[i * bytesPerBeat], bytesPerBeat);
+            frames[i] = T(unpack_complex<AxiCfg>(sc_uint<AxiCfg::dataWidth>(raw)));
+        }
+
+        for (int f = 0; f < aligned; f += N_SIZE) {
+            Transform::transform(&frames[f]);
+        }
+        frames_done += aligned / N_SIZE;
+
+        for (int i = 0; i < job.samples; ++i) {
+            uint64_t raw = pack_complex<AxiCfg>(frames[i]).to_uint64();
+            std::memcpy(&bytes[i * bytesPerBeat], &raw, bytesPerBeat);
+        }
+
+        // Reads overlap with the computation; the outputs trail by the pipeline latency
+        sc_time compute_time = clk_period * (double)job_cycles(job.samples);
+        sc_time job_time = std::max(read_delay - local, compute_time);
+        sc_time write_delay = local + job_time + clk_period * (double)Dma::calc_pipeline_latency();
+        transport(tlm::TLM_WRITE_COMMAND, job.addr + N_SIZE * bytesPerBeat, bytes, write_delay);
+
+        qk.inc(job_time);
+        done_time = sc_time_stamp() + write_delay;
+        jobs_done++;
+    }
+
+    void core_thread() {
+        qk.reset();
+        qk.inc(start_offset);
+        while (true) {
+            if (jobs.empty()) {
+                busy = false;
+                qk.sync();
+                wait(job_event);
+                continue;
+            }
+            busy = true;
+            TlmJob job = jobs.front();
+            jobs.pop_front();
+            run_job(job);
+            if (qk.need_sync()) {
+                qk.sync();
+            }
+        }
+    }
+
+    SC_HAS_PROCESS(TlmCore);
+    TlmCore(sc_module_name name, sc_time clk_period = sc_time(2.0, SC_NS))
+        : sc_module(name),
+          socket("socket"),
+          clk_period(clk_period),
+          start_offset(SC_ZERO_TIME),
+          jobs_done(0),
+          frames_done(0),
+          done_time(SC_ZERO_TIME),
+          busy(false),
+          errors(false)
+    {
+        SC_THREAD(core_thread);
+    }
+};
+
+// Multi-core TLM model of Top: per-core job queues, first jobs staggered by HOP_SIZE cycles
+template<int N_SIZE, int NUM_CORES, int HOP_SIZE, typename AxiCfg, int NUM_MULT = 4, int NUM_ADD = 6,
+         int RADIX = 2, typename T = complex_t, unsigned SCALE_MASK = 0, bool NATURAL_ORDER = false>
+SC_MODULE(TlmTop) {
+    typedef TlmCore<N_SIZE, AxiCfg, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, NATURAL_ORDER> CoreType;
+
+    sc_vector<CoreType> cores;
+
+    // Queue a job on one core (HOP stagger mode)
+    void submit(int core, uint64_t addr, int samples) {
+        cores[core].submit(addr, samples);
+    }
+
+    // Queue a job on the core with the least pending work (adaptive mode)
+    void submit(uint64_t addr, int samples) {
+        int best = 0;
+        for (int i = 1; i < NUM_CORES; ++i) {
+            if (cores[i].pending_cycles() < cores[best].pending_cycles()) {
+                best = i;
+            }
+        }
+        cores[best].submit(addr, samples);
+    }
+
+    // Time the last output of all finished jobs was written
+    sc_time done_time() const {
+        sc_time t = SC_ZERO_TIME;
+        for (int i = 0; i < NUM_CORES; ++i) {
+            t = std::max(t, cores[i].done_time);
+        }
+        return t;
+    }
+
+    TlmTop(sc_module_name name, sc_time clk_period = sc_time(2.0, SC_NS))
+        : sc_module(name),
+          cores("core", NUM_CORES, [clk_period](const char* n, size_t) { return new CoreType(n, clk_period); })
+    {
+        for (int i = 0; i < NUM_CORES; ++i) {
+            cores[i].start_offset = clk_period * (double)(i * HOP_SIZE);
+        }
+    }
+};
+
+#endif // TLM_TOP_H
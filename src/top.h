@@ -4,6 +4,13 @@
  * Interleaved multi-core FFT wrapper module.
  * Controls the staggered activation of individual processing cores using a HOP_SIZE
  * delay state machine to optimize memory bus bandwidth and throughput.
+ * In adaptive mode a scheduler instead pulls jobs from job_in and launches them on idle
+ * cores whenever the AR/AW bursts in flight across all cores drop below load_limit, so a
+ * queue of any number of jobs is spread over the cores as they finish.
+ * A non-zero stft_hop splits the short-time Fourier transform of the job on the ports of
+ * core 0 over the cores round-robin: core i computes every NUM_CORES-th frame from frame i
+ * on and writes it to its slot of the spectrogram at stft_dst.
+ * prune_zeros, the output bin range bin_lo/bin_hi and inverse apply to the jobs of all cores.
  */
 
 #ifndef TOP_FFT_H
@@ -12,35 +19,94 @@
 #include <systemc.h>
 #include <vector>
 #include <axi/axi4.h>
+#include <connections/connections.h>
 #include "core.h"
 
 using namespace sc_core;
 using namespace axi;
+using namespace Connections;
+
+// Job for the adaptive scheduler (same meaning as a core's base_addr/num_samples/fft_len)
+template<typename AxiCfg>
+struct FftJob {
+    sc_uint<AxiCfg::addrWidth> addr;
+    sc_uint<32> samples;
+    sc_uint<32> len;
+
+    AUTO_GEN_FIELD_METHODS(FftJob, (addr, samples, len))
+};
 
 // Multi-core staggered FFT coordinator
-template<int N_SIZE, int NUM_CORES, int HOP_SIZE, typename AxiCfg, int NUM_MULT=4, int NUM_ADD=6>
+template<int N_SIZE, int NUM_CORES, int HOP_SIZE, typename AxiCfg, int NUM_MULT=4, int NUM_ADD=6, int RADIX=2,
+         typename T=complex_t, unsigned SCALE_MASK=0, typename DmaCfg=dma_cfg::standard,
+         bool NATURAL_ORDER=false, int FOLD_BF=0, bool REAL_INPUT=false>
 SC_MODULE(Top) {
     sc_in<bool> clk;
     sc_in<bool> rst_n; // Active-low reset
     sc_in<bool> start;
+    sc_in<bool> stream_mode; // Cores queue and stream successive jobs back to back
+    sc_in<bool> desc_mode;   // base_addrs point to per-core descriptor chains
+    sc_in<bool> adaptive_mode; // Cores run jobs from job_in instead of the HOP_SIZE stagger
+
+    // Job queue of the adaptive scheduler
+    In<FftJob<AxiCfg>> job_in;
 
     // External AXI ports
     sc_vector<typename axi4<AxiCfg>::read::template master<>> mem_read_ports;
     sc_vector<typename axi4<AxiCfg>::write::template master<>> mem_write_ports;
-    
+
     sc_vector<sc_in<sc_uint<AxiCfg::addrWidth>>> base_addrs;
-    sc_vector<sc_in<int>> num_samples; 
+    sc_vector<sc_in<int>> num_samples;
+    sc_vector<sc_in<int>> fft_lens; // FFT length of every core's next job (0: N_SIZE)
+    sc_in<int> window;   // WindowRom kind of the jobs of all cores
+    sc_in<int> stft_hop; // Samples between STFT frames (0: every core runs its own job)
+    sc_in<sc_uint<AxiCfg::addrWidth>> stft_dst; // First frame of the STFT output
+    sc_in<bool> prune_zeros; // Stages skip butterflies on zero operands
+    sc_in<int> bin_lo;       // Output bins [bin_lo, bin_hi) of the jobs (bin_hi <= 0: all)
+    sc_in<int> bin_hi;
+    sc_in<bool> inverse;     // Inverse transforms (radix-2 stage cascade)
 
     // Inter-core control signals
     sc_vector<sc_signal<bool>> core_starts;
     sc_vector<sc_signal<bool>> core_busy;
+    sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>> core_base_addrs;
+    sc_vector<sc_signal<int>> core_num_samples;
+    sc_vector<sc_signal<int>> core_fft_lens;
+    sc_vector<sc_signal<int>> core_stft_hops;
+    sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>> core_stft_dsts;
+    sc_vector<sc_signal<int>> core_stft_pitches;
+    sc_signal<bool> core_stream_mode;
+    sc_vector<sc_signal<int>> core_rd_outstanding;
+    sc_vector<sc_signal<int>> core_wr_outstanding;
 
-    sc_vector<Core<N_SIZE, AxiCfg, NUM_MULT, NUM_ADD>> cores;
+    sc_vector<Core<N_SIZE, AxiCfg, NUM_MULT, NUM_ADD, RADIX, T, SCALE_MASK, DmaCfg, NATURAL_ORDER, FOLD_BF,
+                   REAL_INPUT>> cores;
+    typedef DMA<AxiCfg, N_SIZE, NUM_MULT, NUM_ADD, RADIX, T, DmaCfg, NATURAL_ORDER, FOLD_BF, REAL_INPUT> Dma;
 
     // Stagger logic state signals
     sc_signal<bool> active_stagger;
     sc_signal<int> stagger_counter;
 
+    // Adaptive scheduler launches and the job parameters they apply
+    sc_vector<sc_signal<bool>> sched_starts;
+    sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>> sched_addrs;
+    sc_vector<sc_signal<int>> sched_samples;
+    sc_vector<sc_signal<int>> sched_lens;
+
+    // A job is launched only while fewer AR + AW bursts than this are in flight across all
+    // cores (default: every other core may keep its full read window outstanding).
+    // May be changed before the simulation starts.
+    int load_limit;
+
+    // Jobs launched on every core by the adaptive scheduler
+    unsigned long core_launches[NUM_CORES];
+
+    // Cycles a launched core is skipped until its busy flag reflects the new job
+    static const int launch_holdoff = 4;
+
+    int holdoff[NUM_CORES];
+    int next_core;
+
     SC_HAS_PROCESS(Top);
 
     Top(sc_module_name name)
@@ -48,28 +114,82 @@ SC_MODULE(Top) {
           clk("clk"),
           rst_n("rst_n"),
           start("start"),
+          stream_mode("stream_mode"),
+          desc_mode("desc_mode"),
+          adaptive_mode("adaptive_mode"),
+          job_in("job_in"),
           mem_read_ports("mem_read_ports", NUM_CORES),
           mem_write_ports("mem_write_ports", NUM_CORES),
           base_addrs("base_addrs", NUM_CORES),
           num_samples("num_samples", NUM_CORES),
+          fft_lens("fft_lens", NUM_CORES),
+          window("window"),
+          stft_hop("stft_hop"),
+          stft_dst("stft_dst"),
+          prune_zeros("prune_zeros"),
+          bin_lo("bin_lo"),
+          bin_hi("bin_hi"),
+          inverse("inverse"),
           core_starts("core_starts", NUM_CORES),
           core_busy("core_busy", NUM_CORES),
-          cores("core", NUM_CORES)
+          core_base_addrs("core_base_addrs", NUM_CORES),
+          core_num_samples("core_num_samples", NUM_CORES),
+          core_fft_lens("core_fft_lens", NUM_CORES),
+          core_stft_hops("core_stft_hops", NUM_CORES),
+          core_stft_dsts("core_stft_dsts", NUM_CORES),
+          core_stft_pitches("core_stft_pitches", NUM_CORES),
+          core_stream_mode("core_stream_mode"),
+          core_rd_outstanding("core_rd_outstanding", NUM_CORES),
+          core_wr_outstanding("core_wr_outstanding", NUM_CORES),
+          cores("core", NUM_CORES),
+          sched_starts("sched_starts", NUM_CORES),
+          sched_addrs("sched_addrs", NUM_CORES),
+          sched_samples("sched_samples", NUM_CORES),
+          sched_lens("sched_lens", NUM_CORES),
+          load_limit(NUM_CORES * DmaCfg::maxOutstanding),
+          next_core(0)
     {
         for (int i = 0; i < NUM_CORES; ++i) {
             cores[i].clk(clk);
             cores[i].rst_n(rst_n);
             cores[i].start(core_starts[i]);
-            cores[i].base_addr(base_addrs[i]);
-            cores[i].num_samples(num_samples[i]);
+            cores[i].stream_mode(core_stream_mode);
+            cores[i].desc_mode(desc_mode);
+            cores[i].base_addr(core_base_addrs[i]);
+            cores[i].num_samples(core_num_samples[i]);
+            cores[i].fft_len(core_fft_lens[i]);
+            cores[i].window(window);
+            cores[i].stft_hop(core_stft_hops[i]);
+            cores[i].stft_dst(core_stft_dsts[i]);
+            cores[i].stft_pitch(core_stft_pitches[i]);
+            cores[i].prune_zeros(prune_zeros);
+            cores[i].bin_lo(bin_lo);
+            cores[i].bin_hi(bin_hi);
+            cores[i].inverse(inverse);
             cores[i].busy(core_busy[i]);
-            
+            cores[i].rd_outstanding(core_rd_outstanding[i]);
+            cores[i].wr_outstanding(core_wr_outstanding[i]);
+
             cores[i].mem_read_port(mem_read_ports[i]);
             cores[i].mem_write_port(mem_write_ports[i]);
+
+            core_launches[i] = 0;
+            holdoff[i] = 0;
         }
 
         SC_METHOD(control_logic);
         sensitive << clk.pos() << rst_n.neg();
+
+        SC_METHOD(job_select);
+        sensitive << adaptive_mode << stream_mode << stft_hop << stft_dst;
+        for (int i = 0; i < NUM_CORES; ++i) {
+            sensitive << base_addrs[i] << num_samples[i] << fft_lens[i]
+                      << sched_addrs[i] << sched_samples[i] << sched_lens[i];
+        }
+
+        SC_THREAD(scheduler_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
     }
 
     // Stagger launches to smooth bus traffic
@@ -80,6 +200,12 @@ SC_MODULE(Top) {
             for (int i = 0; i < NUM_CORES; ++i) {
                 core_starts[i].write(false);
             }
+        } else if (adaptive_mode.read()) {
+            // Launches come from the scheduler, start is ignored
+            active_stagger.write(false);
+            for (int i = 0; i < NUM_CORES; ++i) {
+                core_starts[i].write(sched_starts[i].read());
+            }
         } else {
             bool is_active = active_stagger.read();
             int cnt = stagger_counter.read();
@@ -100,7 +226,7 @@ SC_MODULE(Top) {
                     }
                 }
                 stagger_counter.write(cnt + 1);
-                
+
                 if (cnt > NUM_CORES * HOP_SIZE + 2) {
                     active_stagger.write(false);
                 }
@@ -111,6 +237,116 @@ SC_MODULE(Top) {
             }
         }
     }
+
+    // Job parameters of the cores: external ports or the scheduler's current jobs.
+    // Adaptive mode runs the cores in stream mode so that busy tracks their queued jobs.
+    void job_select() {
+        bool adaptive = adaptive_mode.read();
+        int hop = adaptive ? 0 : stft_hop.read();
+        core_stream_mode.write(stream_mode.read() || adaptive);
+        for (int i = 0; i < NUM_CORES; ++i) {
+            if (hop > 0) {
+                stft_split(i, hop);
+                continue;
+            }
+            core_base_addrs[i].write(adaptive ? sched_addrs[i].read() : base_addrs[i].read());
+            core_num_samples[i].write(adaptive ? sched_samples[i].read() : num_samples[i].read());
+            core_fft_lens[i].write(adaptive ? sched_lens[i].read() : fft_lens[i].read());
+            core_stft_hops[i].write(0);
+            core_stft_dsts[i].write(0);
+            core_stft_pitches[i].write(0);
+        }
+    }
+
+    // Round-robin share of core i in the STFT of the job on the ports of core 0: its frames
+    // start i hops in and NUM_CORES hops apart, and land NUM_CORES frames apart at the i-th
+    // frame of stft_dst. A core whose first frame is past the samples gets no samples.
+    void stft_split(int i, int hop) {
+        static const int sample_bytes = Dma::bytesPerBeat / Dma::SAMPLES_PER_BEAT;
+        int len = Dma::job_len(fft_lens[0].read());
+        int frame_bytes = Dma::frame_beats(len) * Dma::bytesPerBeat;
+        int offset = i * hop;
+        int samples = num_samples[0].read() - offset;
+        core_base_addrs[i].write(base_addrs[0].read() + (uint64_t)offset * sample_bytes);
+        core_num_samples[i].write((i == 0 || samples >= len) ? samples : 0);
+        core_fft_lens[i].write(fft_lens[0].read());
+        core_stft_hops[i].write(NUM_CORES * hop);
+        core_stft_dsts[i].write(stft_dst.read() + (uint64_t)i * frame_bytes);
+        core_stft_pitches[i].write(NUM_CORES * frame_bytes);
+    }
+
+    // AR + AW bursts currently in flight across all cores
+    int bus_load() {
+        int load = 0;
+        for (int i = 0; i < NUM_CORES; ++i) {
+            load += core_rd_outstanding[i].read() + core_wr_outstanding[i].read();
+        }
+        return load;
+    }
+
+    // Next idle core in round-robin order, or -1
+    int pick_idle_core() {
+        for (int k = 0; k < NUM_CORES; ++k) {
+            int i = (next_core + k) % NUM_CORES;
+            if (!core_busy[i].read() && holdoff[i] == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Adaptive scheduler: one launch per cycle when a core is idle and the bus has room
+    void scheduler_thread() {
+        job_in.Reset();
+        for (int i = 0; i < NUM_CORES; ++i) {
+            sched_starts[i].write(false);
+            sched_addrs[i].write(0);
+            sched_samples[i].write(0);
+            sched_lens[i].write(0);
+            holdoff[i] = 0;
+        }
+        next_core = 0;
+        bool have_job = false;
+        FftJob<AxiCfg> job;
+        wait();
+
+        while (true) {
+            for (int i = 0; i < NUM_CORES; ++i) {
+                sched_starts[i].write(false);
+                if (holdoff[i] > 0) {
+                    holdoff[i]--;
+                }
+            }
+
+            if (adaptive_mode.read()) {
+                if (!have_job) {
+                    have_job = job_in.PopNB(job);
+                }
+                int core = (have_job && bus_load() < load_limit) ? pick_idle_core() : -1;
+                if (core >= 0) {
+                    sched_addrs[core].write(job.addr);
+                    sched_samples[core].write(job.samples.to_int());
+                    sched_lens[core].write(job.len.to_int());
+                    sched_starts[core].write(true);
+                    holdoff[core] = launch_holdoff;
+                    core_launches[core]++;
+                    next_core = (core + 1) % NUM_CORES;
+                    have_job = false;
+                }
+            }
+            wait();
+        }
+    }
+
+    // Performance counters of every core
+    template<typename Writer>
+    void write_perf_json(Writer& w) const {
+        w.StartArray();
+        for (int i = 0; i < NUM_CORES; ++i) {
+            cores[i].write_perf_json(w);
+        }
+        w.EndArray();
+    }
 };
 
 #endif // TOP_FFT_H
@@ -0,0 +1,81 @@
+/*
+ * twiddle_rom.h
+ *
+ * Shared twiddle factor ROM for the FFT stages.
+ * A single ROM is built per transform size and stored with octant symmetry: only
+ * cos/sin of the first N/8 + 1 angles are kept, every other W_N^k is rebuilt by
+ * swapping and negating the stored pair. All stages of all cores index into the
+ * same ROM with a stride of N / N_STAGE instead of holding their own tables.
+ */
+
+#ifndef TWIDDLE_ROM_H
+#define TWIDDLE_ROM_H
+
+#include "fft_types.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Octant-symmetric twiddle ROM holding W_N^k = exp(-j*2*pi*k/N)
+class TwiddleRom {
+public:
+    // Shared ROM for size n (elaboration-time singleton per n, minimum size 8)
+    static const TwiddleRom& instance(int n) {
+        static std::map<int, std::unique_ptr<TwiddleRom>> roms;
+        int rom_n = (n < 8) ? 8 : n;
+        auto it = roms.find(rom_n);
+        if (it == roms.end()) {
+            it = roms.emplace(rom_n, std::unique_ptr<TwiddleRom>(new TwiddleRom(rom_n))).first;
+        }
+        return *it->second;
+    }
+
+    // Transform size covered by the ROM
+    int size() const { return n; }
+
+    // Number of stored cos/sin pairs (N/8 + 1)
+    int words() const { return (int)octant.size(); }
+
+    // Twiddle W_N^k rebuilt from the first octant
+    template<typename T = complex_t>
+    T lookup(int k) const {
+        int quarter = n / 4;
+        int eighth = n / 8;
+        k &= (n - 1);
+        int q = k / quarter;
+        int m = k % quarter;
+
+        // cos/sin of the angle within the quadrant
+        double c, s;
+        if (m <= eighth) {
+            c = octant[m].real;
+            s = octant[m].imag;
+        } else {
+            c = octant[quarter - m].imag;
+            s = octant[quarter - m].real;
+        }
+
+        // Rotate into quadrant q, then W = cos(theta) - j*sin(theta)
+        switch (q) {
+            case 0:  return T(c, -s);
+            case 1:  return T(-s, -c);
+            case 2:  return T(-c, s);
+            default: return T(s, c);
+        }
+    }
+
+private:
+    int n;
+    std::vector<complex_t> octant; // (cos, sin) of 2*pi*m/N for m <= N/8
+
+    explicit TwiddleRom(int n) : n(n), octant(n / 8 + 1) {
+        const double PI = 3.14159265358979323846;
+        for (int m = 0; m <= n / 8; ++m) {
+            double angle = 2.0 * PI * m / n;
+            octant[m] = complex_t(cos(angle), sin(angle));
+        }
+    }
+};
+
+#endif // TWIDDLE_ROM_H
@@ -0,0 +1,192 @@
+/*
+ * window.h
+ *
+ * Window-multiply stage in front of the first FFT stage. Every sample of a frame is scaled by
+ * its coefficient from a shared window ROM (Hann, Hamming, or a custom table loaded at
+ * elaboration); the rectangular window passes the samples through unchanged. The window and
+ * the frame length are taken at the first beat of every frame, so a job's window applies
+ * from its first frame on. A beat carries LANES consecutive samples, or two real samples in
+ * real-input mode, each scaled by its own coefficient. The stage registers one beat and
+ * holds no samples back, so it adds no pipeline latency in beats.
+ */
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include "fft_types.h"
+#include "perf_counters.h"
+#include <connections/connections.h>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace Connections;
+
+// Periodic (DFT-even) window coefficients of a transform size, shared by all cores
+class WindowRom {
+public:
+    enum Kind {
+        rectangular = 0,
+        hann = 1,
+        hamming = 2,
+        custom = 3, // Table loaded with load_custom()
+    };
+
+    // Shared ROM of a window kind for size n (elaboration-time singleton per n and kind;
+    // unknown kinds are rectangular)
+    static WindowRom& instance(int n, int kind) {
+        static std::map<std::pair<int, int>, std::unique_ptr<WindowRom>> roms;
+        if (kind < rectangular || kind > custom) {
+            kind = rectangular;
+        }
+        auto key = std::make_pair(n, kind);
+        auto it = roms.find(key);
+        if (it == roms.end()) {
+            it = roms.emplace(key, std::unique_ptr<WindowRom>(new WindowRom(n, kind))).first;
+        }
+        return *it->second;
+    }
+
+    // Fill the custom window of size n (before the simulation starts); missing
+    // coefficients are 1
+    static void load_custom(int n, const std::vector<double>& coeffs) {
+        WindowRom& rom = instance(n, custom);
+        for (int k = 0; k < n; ++k) {
+            rom.table[k] = (k < (int)coeffs.size()) ? coeffs[k] : 1.0;
+        }
+    }
+
+    int size() const { return n; }
+
+    // Coefficient k of the window of a len-point frame (len divides the ROM size)
+    double coeff(int k, int len) const {
+        return table[(k * (n / len)) & (n - 1)];
+    }
+
+private:
+    int n;
+    std::vector<double> table;
+
+    WindowRom(int n, int kind) : n(n), table(n, 1.0) {
+        const double PI = 3.14159265358979323846;
+        for (int k = 0; k < n; ++k) {
+            double c = std::cos(2.0 * PI * k / n);
+            if (kind == hann) {
+                table[k] = 0.5 - 0.5 * c;
+            } else if (kind == hamming) {
+                table[k] = 0.54 - 0.46 * c;
+            }
+        }
+    }
+};
+
+// Window multiply of frames of up to N samples
+template<int N, typename T = complex_t, bool REAL_INPUT = false>
+SC_MODULE(Window) {
+    static const int LANES = beat_lanes<T>::value;
+    static const int SAMPLES_PER_BEAT = REAL_INPUT ? 2 : LANES;
+
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+    sc_in<int> window_sel; // WindowRom kind of the next frame
+    sc_in<int> frame_len;  // Samples per frame (FFT length of the stages)
+
+    In<T> in_data;
+    Out<T> out_data;
+
+    StreamCounters perf;
+
+    const WindowRom* rom; // Window of the current frame (nullptr: rectangular)
+    int len;              // Samples of the current frame
+
+    // Window of beat b of the frame: sample b * SAMPLES_PER_BEAT + l by coefficient l
+    T apply(const T& x, int b) const {
+        int k = b * SAMPLES_PER_BEAT;
+        if constexpr (LANES > 1) {
+            T y = x;
+            for (int l = 0; l < LANES; ++l) {
+                double c = rom->coeff(k + l, len);
+                y.lane[l] = scale_parts(x.lane[l], c, c);
+            }
+            return y;
+        } else if constexpr (REAL_INPUT) {
+            return scale_parts(x, rom->coeff(k, len), rom->coeff(k + 1, len));
+        } else {
+            double c = rom->coeff(k, len);
+            return scale_parts(x, c, c);
+        }
+    }
+
+    void window_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        perf.start(bound_clock_period(clk));
+        rom = nullptr;
+        len = N;
+
+        T held;
+        bool have = false;
+        int beat = 0;
+        wait();
+
+        while (true) {
+            bool transfer = false;
+            bool starved = false;
+            bool blocked = false;
+
+            if (have) {
+                if (out_data.PushNB(held)) {
+                    have = false;
+                    perf.samples_out++;
+                    transfer = true;
+                } else {
+                    blocked = true;
+                }
+            }
+
+            if (!have) {
+                T input;
+                if (in_data.PopNB(input)) {
+                    if (beat == 0) {
+                        int sel = window_sel.read();
+                        len = frame_len.read();
+                        rom = (sel == WindowRom::rectangular) ? nullptr : &WindowRom::instance(N, sel);
+                    }
+                    held = (rom != nullptr) ? apply(input, beat) : input;
+                    have = true;
+                    if (++beat == len / SAMPLES_PER_BEAT) {
+                        beat = 0;
+                    }
+                    perf.samples_in++;
+                    transfer = true;
+                } else {
+                    starved = true;
+                }
+            }
+
+            perf.book_cycle(transfer, starved, blocked);
+            wait();
+        }
+    }
+
+    SC_HAS_PROCESS(Window);
+    Window(sc_module_name name) :
+        sc_module(name),
+        clk("clk"),
+        rst_n("rst_n"),
+        window_sel("window_sel"),
+        frame_len("frame_len"),
+        in_data("in_data"),
+        out_data("out_data"),
+        rom(nullptr),
+        len(N)
+    {
+        SC_THREAD(window_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+#endif // WINDOW_H
@@ -1,9 +1,11 @@
 #!/usr/bin/env python3
 import os
 import subprocess
-import shutil
 import re
 import json
+import hashlib
+import argparse
+from concurrent.futures import ThreadPoolExecutor, as_completed
 import numpy as np
 import matplotlib
 matplotlib.use('Agg')
@@ -15,11 +17,144 @@ def run_cmd(cmd):
     res = subprocess.run(cmd, shell=True, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
     return res.stdout, res.stderr, res.returncode
 
+def build_key(flags):
+    """Stable build directory name for a set of compiler macro flags."""
+    if not flags:
+        return "default"
+    return hashlib.sha1(flags.encode()).hexdigest()[:12]
+
+def build_binary(target, flags, container_prefix, rebuild):
+    """Builds target into its own build directory keyed by the flags. make runs every time and
+    rebuilds only after a change of the sources or headers (-MMD dependencies)."""
+    build_dir = os.path.join("build", "sweep", f"{target}_{build_key(flags)}")
+    binary = os.path.join(build_dir, target)
+    os.makedirs(build_dir, exist_ok=True)
+    flags_file = os.path.join(build_dir, "flags.txt")
+    if not os.path.isfile(flags_file):
+        with open(flags_file, "w") as f_flags:
+            f_flags.write(flags + "\n")
+    force = " -B" if rebuild else ""
+    build_cmd = f"{container_prefix} make{force} {binary} BUILD_DIR={build_dir} EXTRA_CXXFLAGS=\"{flags}\""
+    _, build_err, build_rc = run_cmd(build_cmd)
+    if build_rc != 0:
+        return None, build_err.strip()
+    return binary, None
+
+def run_point(point, binary, container_prefix):
+    """Simulates one sweep point in its own SIM_OUT_DIR and parses PERFORMANCE_RESULT."""
+    name = f"N{point['size']}_M{point['mult']}_A{point['add']}"
+    if point.get("fold"):
+        name += f"_BF{point['fold']}"
+    out_dir = os.path.join("out", "sweep", name)
+    os.makedirs(out_dir, exist_ok=True)
+    env = os.environ.copy()
+    env["SIM_OUT_DIR"] = out_dir
+    res = subprocess.run(f"{container_prefix} {binary} {point['args']}", shell=True, env=env,
+                         stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    with open(os.path.join(out_dir, "sim.log"), "w") as f_log:
+        f_log.write(res.stdout)
+    if res.returncode != 0:
+        return point, None, res.stderr.strip()
+    perf_match = re.search(r"PERFORMANCE_RESULT:\s*(.*)", res.stdout)
+    if not perf_match:
+        return point, None, "could not parse performance metrics"
+    return point, dict(item.split("=") for item in perf_match.group(1).split()), None
+
+def run_folding_sweep(args, sizes, samples, container_prefix):
+    """Throughput against butterfly count: folded cores with 1..N/2 units vs the log2(N) stage cascade."""
+    counts = sorted({int(c) for c in args.butterflies.split(",")})
+    points = []
+    for size in sizes:
+        if size < 2:
+            continue
+        stages = size.bit_length() - 1
+        for fold in [c for c in counts if c <= size // 2] + [0]:
+            points.append({
+                "size": size, "mult": 4, "add": 6, "fold": fold,
+                "butterflies": fold if fold else stages,
+                "target": "tb_system",
+                "flags": f"-DFFT_N={size} -DFFT_NUM_CORES=1 -DFFT_HOP=1 -DFFT_FOLD_BF={fold}",
+                "args": f"SAMPLES={samples} TRACE=none",
+            })
+
+    builds = sorted({(p["target"], p["flags"]) for p in points})
+    print(f"\n[ BUILD ] {len(builds)} binaries, up to {args.jobs} in parallel")
+    binaries = {}
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(build_binary, target, flags, container_prefix, args.rebuild): (target, flags)
+                   for target, flags in builds}
+        for future in as_completed(futures):
+            binary, err = future.result()
+            if binary is None:
+                print(f"  [ ERROR ] Compilation failed for {futures[future]}! {err}")
+            binaries[futures[future]] = binary
+
+    print(f"[ SWEEP ] {len(points)} points, {args.jobs} concurrent simulations")
+    raw_data = []
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = [pool.submit(run_point, p, binaries[(p["target"], p["flags"])], container_prefix)
+                   for p in points if binaries[(p["target"], p["flags"])] is not None]
+        for future in as_completed(futures):
+            point, kv_pairs, err = future.result()
+            kind = f"folded, {point['fold']} BF" if point["fold"] else "pipelined"
+            if err is not None:
+                print(f"  [ ERROR ] Size={point['size']}, {kind}: {err}")
+                continue
+            cycles = float(kv_pairs["CYCLES"])
+            throughput = float(kv_pairs["SAMPLES"]) * float(kv_pairs["CORES"]) / cycles
+            raw_data.append({"size": point["size"], "fold_bf": point["fold"],
+                             "butterflies": point["butterflies"], "cycles": cycles,
+                             "throughput": throughput})
+            print(f"  [ SUCCESS ] Size={point['size']}, {kind}: Cycles={cycles:.0f}, "
+                  f"Throughput={throughput:.4f} samples/cycle")
+
+    raw_data.sort(key=lambda d: (d["size"], d["butterflies"]))
+    with open("out/folding_sweep_results.json", "w") as f:
+        json.dump(raw_data, f, indent=4)
+    print("\n[ INFO ] Folding sweep results saved to out/folding_sweep_results.json")
+
+    plt.style.use('default')
+    fig, ax = plt.subplots(figsize=(9, 6))
+    for size in sizes:
+        folded = [d for d in raw_data if d["size"] == size and d["fold_bf"]]
+        pipelined = [d for d in raw_data if d["size"] == size and not d["fold_bf"]]
+        if not folded and not pipelined:
+            continue
+        line = ax.plot([d["butterflies"] for d in folded], [d["throughput"] for d in folded],
+                       marker="o", linewidth=1.5, label=f"N={size} folded")
+        color = line[0].get_color()
+        for d in pipelined:
+            ax.scatter([d["butterflies"]], [d["throughput"]], marker="*", s=120, color=color,
+                       label=f"N={size} pipelined")
+    ax.axhline(1.0, color="#718096", linestyle="--", linewidth=1.2, alpha=0.8)
+    ax.set_xscale("log", base=2)
+    ax.set_title("Throughput vs Butterfly Units", fontsize=13, fontweight='bold')
+    ax.set_xlabel("Butterfly Units (4 Muls, 6 Adds each)", fontsize=11)
+    ax.set_ylabel("Throughput (Samples / Clock Cycle)", fontsize=11)
+    ax.grid(True, which="both", ls=":", color="#E2E8F0", alpha=0.7)
+    ax.legend(frameon=True, fontsize=8, loc="best")
+    plt.tight_layout()
+    plt.savefig("out/fft_folding.png", dpi=150)
+    plt.close()
+    print("[ SUCCESS ] Plot saved successfully to out/fft_folding.png")
+
 def main():
     print("=" * 60)
     print(" FFT SystemC Performance Sweep & Visualization (Constant Workload)")
     print("=" * 60)
 
+    parser = argparse.ArgumentParser(description="Parallel performance sweep of FFT SystemC")
+    parser.add_argument("--jobs", type=int, default=os.cpu_count(),
+                        help="Simulations run concurrently (default: CPU count)")
+    parser.add_argument("--per-point-build", action="store_true",
+                        help="Compile tb_system for every point instead of using tb_system_multi")
+    parser.add_argument("--rebuild", action="store_true",
+                        help="Rebuild binaries even if they are up to date")
+    parser.add_argument("--butterflies", default="",
+                        help="Comma-separated butterfly unit counts of folded cores (e.g. 1,2,4,8): "
+                             "chart throughput against butterfly count instead of NUM_MULT/NUM_ADD")
+    args = parser.parse_args()
+
     # 1. Configuration Setup
     sizes = [4, 8, 16, 256, 1024, 2048]
     configs = [
@@ -42,104 +177,103 @@ def main():
     # Ensure output sweep directories exist
     os.makedirs("out/sweep", exist_ok=True)
 
-    # 2. Run Sweep
+    if args.butterflies:
+        run_folding_sweep(args, sizes, samples, container_prefix)
+        return
+
+    # 2. Build matrix: one binary per distinct set of compile-time flags
+    points = []
     for size in sizes:
         for cfg in configs:
-            cfg_name = cfg["name"]
-            mult = cfg["mult"]
-            add = cfg["add"]
-            
-            print(f"\n[ SWEEP ] Size={size}, Config={cfg_name} (Mult={mult}, Add={add})")
+            point = {"size": size, "config": cfg["name"], "mult": cfg["mult"], "add": cfg["add"]}
+            if args.per_point_build:
+                point["target"] = "tb_system"
+                point["flags"] = (
+                    f"-DFFT_N={size} "
+                    f"-DFFT_NUM_CORES={num_cores} "
+                    f"-DFFT_HOP={hop} "
+                    f"-DFFT_NUM_MULT={cfg['mult']} "
+                    f"-DFFT_NUM_ADD={cfg['add']}"
+                )
+                point["args"] = f"SAMPLES={samples} TRACE=none"
+            else:
+                point["target"] = "tb_system_multi"
+                point["flags"] = ""
+                point["args"] = (f"N={size} NUM_CORES={num_cores} HOP={hop} SAMPLES={samples} "
+                                 f"NUM_MULS={cfg['mult']} NUM_ADDS={cfg['add']} TRACE=none")
+            points.append(point)
+
+    builds = sorted({(p["target"], p["flags"]) for p in points})
+    print(f"\n[ BUILD ] {len(builds)} binaries, up to {args.jobs} in parallel")
+    binaries = {}
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = {pool.submit(build_binary, target, flags, container_prefix, args.rebuild): (target, flags)
+                   for target, flags in builds}
+        for future in as_completed(futures):
+            binary, err = future.result()
+            if binary is None:
+                print(f"  [ ERROR ] Compilation failed for {futures[future]}! {err}")
+            binaries[futures[future]] = binary
+
+    # 3. Run Sweep: every point simulates in its own output directory
+    print(f"[ SWEEP ] {len(points)} points, {args.jobs} concurrent simulations")
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = [pool.submit(run_point, p, binaries[(p["target"], p["flags"])], container_prefix)
+                   for p in points if binaries[(p["target"], p["flags"])] is not None]
+        for future in as_completed(futures):
+            point, kv_pairs, err = future.result()
+            size, cfg_name, mult, add = point["size"], point["config"], point["mult"], point["add"]
+            if err is not None:
+                print(f"  [ ERROR ] Size={size}, Config={cfg_name}: {err}")
+                continue
+
+            cycles = float(kv_pairs["CYCLES"])
+            ideal = float(kv_pairs["IDEAL"])
+            overhead = float(kv_pairs["OVERHEAD"])
+            total_samples = float(kv_pairs["SAMPLES"]) * float(kv_pairs["CORES"])
             
-            # Clean container build files
-            run_cmd(f"{container_prefix} rm -f build/tb_system.o build/tb_system")
+            latency_per_sample = cycles / total_samples
+            ideal_per_sample = ideal / total_samples
+            overhead_per_sample = overhead / total_samples
+            throughput = total_samples / cycles
             
-            # Compile command inside the container
-            cxx_flags = (
-                f"-DFFT_N={size} "
-                f"-DFFT_NUM_CORES={num_cores} "
-                f"-DFFT_HOP={hop} "
-                f"-DFFT_SAMPLES={samples} "
-                f"-DFFT_NUM_MULT={mult} "
-                f"-DFFT_NUM_ADD={add}"
-            )
-            build_cmd = f"{container_prefix} make build/tb_system EXTRA_CXXFLAGS=\"{cxx_flags}\""
+            data_point = {
+                "size": size,
+                "samples": samples,
+                "cycles": cycles,
+                "ideal": ideal,
+                "overhead": overhead,
+                "latency_per_sample": latency_per_sample,
+                "ideal_per_sample": ideal_per_sample,
+                "overhead_per_sample": overhead_per_sample,
+                "throughput": throughput
+            }
             
-            print("  Compiling inside container...")
-            build_out, build_err, build_rc = run_cmd(build_cmd)
-            if build_rc != 0:
-                print(f"  [ ERROR ] Compilation failed! {build_err.strip()}")
-                continue
-            
-            print("  Simulating inside container...")
-            sim_out, sim_err, sim_rc = run_cmd(f"{container_prefix} ./build/tb_system")
-            if sim_rc != 0:
-                print(f"  [ ERROR ] Simulation failed! {sim_err.strip()}")
-                continue
+            results[cfg_name].append(data_point)
+            raw_data.append({
+                "size": size,
+                "config": cfg_name,
+                "mult": mult,
+                "add": add,
+                "cycles": cycles,
+                "ideal": ideal,
+                "overhead": overhead,
+                "latency_per_sample": latency_per_sample,
+                "ideal_per_sample": ideal_per_sample,
+                "overhead_per_sample": overhead_per_sample,
+                "throughput": throughput
+            })
+            print(f"  [ SUCCESS ] Size={size}, Config={cfg_name}: Cycles={cycles:.0f} (Ideal={ideal:.0f}, Overhead={overhead:.0f}), Throughput={throughput:.4f} samples/cycle")
 
-            # Parse simulation logs for PERFORMANCE_RESULT
-            perf_match = re.search(r"PERFORMANCE_RESULT:\s*(.*)", sim_out)
-            if perf_match:
-                perf_line = perf_match.group(1)
-                kv_pairs = dict(item.split("=") for item in perf_line.split())
-                
-                cycles = float(kv_pairs["CYCLES"])
-                ideal = float(kv_pairs["IDEAL"])
-                overhead = float(kv_pairs["OVERHEAD"])
-                total_samples = float(kv_pairs["SAMPLES"]) * float(kv_pairs["CORES"])
-                
-                latency_per_sample = cycles / total_samples
-                ideal_per_sample = ideal / total_samples
-                overhead_per_sample = overhead / total_samples
-                throughput = total_samples / cycles
-                
-                data_point = {
-                    "size": size,
-                    "samples": samples,
-                    "cycles": cycles,
-                    "ideal": ideal,
-                    "overhead": overhead,
-                    "latency_per_sample": latency_per_sample,
-                    "ideal_per_sample": ideal_per_sample,
-                    "overhead_per_sample": overhead_per_sample,
-                    "throughput": throughput
-                }
-                
-                results[cfg_name].append(data_point)
-                raw_data.append({
-                    "size": size,
-                    "config": cfg_name,
-                    "mult": mult,
-                    "add": add,
-                    "cycles": cycles,
-                    "ideal": ideal,
-                    "overhead": overhead,
-                    "latency_per_sample": latency_per_sample,
-                    "ideal_per_sample": ideal_per_sample,
-                    "overhead_per_sample": overhead_per_sample,
-                    "throughput": throughput
-                })
-                print(f"  [ SUCCESS ] Cycles={cycles:.0f} (Ideal={ideal:.0f}, Overhead={overhead:.0f}), Throughput={throughput:.4f} samples/cycle")
-                
-                # Archive trace and logs for this config point into out/sweep/
-                log_target = f"out/sweep/sim_N{size}_M{mult}_A{add}.log"
-                with open(log_target, "w") as f_log:
-                    f_log.write(sim_out)
-                    
-                trace_source = "out/trace.vcd"
-                trace_target = f"out/sweep/trace_N{size}_M{mult}_A{add}.vcd"
-                if os.path.exists(trace_source):
-                    shutil.copy(trace_source, trace_target)
-            else:
-                print("  [ ERROR ] Could not parse performance metrics from simulation logs!")
-                print(sim_out)
+    # Merge in sweep order regardless of completion order
+    raw_data.sort(key=lambda d: (sizes.index(d["size"]), d["mult"], d["add"]))
 
-    # 3. Save Raw Data
+    # 4. Save Raw Data
     with open("out/performance_sweep_results.json", "w") as f:
         json.dump(raw_data, f, indent=4)
     print("\n[ INFO ] Performance sweep results saved to out/performance_sweep_results.json")
 
-    # 4. Generate Light-Themed Dashboard Visualization
+    # 5. Generate Light-Themed Dashboard Visualization
     print("[ INFO ] Generating plots...")
     
     # Use clean default light style
@@ -167,7 +301,7 @@ def main():
     x_indices = np.arange(len(sizes))
     bar_width = 0.18
 
-    # 4.1 Plot Throughput (Grouped Column Chart)
+    # 5.1 Plot Throughput (Grouped Column Chart)
     # Add horizontal dashed line at Y=1.0 for peak streaming throughput
     ax1.axhline(1.0, color="#718096", linestyle="--", linewidth=1.2, alpha=0.8)
 
@@ -198,7 +332,7 @@ def main():
     ax1.legend(frameon=True, facecolor="#FFFFFF", edgecolor="#E2E8F0", loc="best")
     ax1.set_ylim(0.0, 1.8)
 
-    # 4.2 Plot Latency per Sample Breakdown (Grouped Stacked Column Chart)
+    # 5.2 Plot Latency per Sample Breakdown (Grouped Stacked Column Chart)
     for idx, cfg in enumerate(configs):
         cfg_name = cfg["name"]
         data = results[cfg_name]
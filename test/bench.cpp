@@ -0,0 +1,548 @@
+#include <systemc.h>
+#include <axi/axi4.h>
+#include <connections/connections.h>
+#include "stage.h"
+#include "fft.h"
+#include "dma.h"
+#include "memory.h"
+#include "perf_counters.h"
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace sc_core;
+using namespace axi;
+using namespace Connections;
+
+// Micro-benchmarks of the hot paths of the model, each block alone on a synthetic source and
+// sink. Every benchmark reports the hardware throughput (simulated cycles per sample or beat,
+// steady state) and the model speed (host ns per simulated cycle).
+// Usage:
+//   bench [--samples K] [--out bench.json]   (every benchmark, one child process each)
+//   bench --case fft_n1024 [--samples K]
+
+typedef axi::cfg::standard AxiCfg;
+
+static const int BENCH_N = 1024;
+static const int BURST_BEATS = 16; // Beats per burst of the memory benchmarks
+
+// Measurement of one benchmark, filled in by its testbench before sc_stop()
+struct BenchCounters {
+    bool done;
+    unsigned long units;  // Samples or beats the cycles are counted over
+    unsigned long cycles; // Simulated cycles they took
+
+    BenchCounters() : done(false), units(0), cycles(0) {}
+};
+
+// Stage or FFT cascade between a source pushing a sample per cycle and a sink popping one;
+// cycles are counted from the first output to the last
+template<typename Dut, int FLUSH>
+SC_MODULE(StreamBench) {
+    sc_clock clk;
+    sc_signal<bool> rst_n;
+
+    Combinational<complex_t> in_chan;
+    Combinational<complex_t> out_chan;
+    Out<complex_t> src;
+    In<complex_t> snk;
+
+    Dut dut;
+    BenchCounters result;
+    int samples;
+
+    SC_HAS_PROCESS(StreamBench);
+    StreamBench(sc_module_name name, int samples) :
+        sc_module(name),
+        clk("clk", 1, SC_NS),
+        rst_n("rst_n"),
+        in_chan("in_chan"),
+        out_chan("out_chan"),
+        src("src"),
+        snk("snk"),
+        dut("dut"),
+        samples(samples)
+    {
+        Connections::set_sim_clk(&clk);
+
+        dut.clk(clk);
+        dut.rst_n(rst_n);
+        dut.in_data(in_chan);
+        dut.out_data(out_chan);
+        src(in_chan);
+        snk(out_chan);
+
+        SC_THREAD(reset_thread);
+        SC_THREAD(source);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+        SC_THREAD(sink);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+    }
+
+    void reset_thread() {
+        rst_n.write(false);
+        wait(5, SC_NS);
+        rst_n.write(true);
+    }
+
+    // Samples and then FLUSH zeros that push the last ones out of the delay lines
+    void source() {
+        src.Reset();
+        wait();
+        for (int i = 0; i < samples + FLUSH; ++i) {
+            src.Push(i < samples ? complex_t(std::sin(0.1 * i), std::cos(0.3 * i)) : complex_t(0.0, 0.0));
+        }
+        while (true) {
+            wait();
+        }
+    }
+
+    void sink() {
+        snk.Reset();
+        wait();
+        sc_time first = SC_ZERO_TIME;
+        for (int i = 0; i < samples; ++i) {
+            snk.Pop();
+            if (i == 0) {
+                first = sc_time_stamp();
+            }
+        }
+        result.units = samples - 1;
+        result.cycles = cycles_since(first, clk.period());
+        result.done = true;
+        sc_stop();
+    }
+};
+
+// Non-blocking loopback in place of the FFT pipeline: one beat per cycle
+SC_MODULE(Loopback) {
+    sc_in<bool> clk;
+    sc_in<bool> rst_n;
+
+    In<complex_t> in_data;
+    Out<complex_t> out_data;
+
+    void loop_thread() {
+        in_data.Reset();
+        out_data.Reset();
+        complex_t held;
+        bool have = false;
+        wait();
+
+        while (true) {
+            if (have && out_data.PushNB(held)) {
+                have = false;
+            }
+            if (!have && in_data.PopNB(held)) {
+                have = true;
+            }
+            wait();
+        }
+    }
+
+    SC_CTOR(Loopback) : clk("clk"), rst_n("rst_n"), in_data("in_data"), out_data("out_data") {
+        SC_THREAD(loop_thread);
+        sensitive << clk.pos();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+// DMA job against a zero-latency Memory with the pipeline looped back; cycles are counted
+// from start to busy falling
+template<int N>
+SC_MODULE(DmaBench) {
+    sc_clock clk;
+    sc_signal<bool> rst_n;
+
+    sc_signal<bool> start;
+    sc_signal<bool> stream_mode;
+    sc_signal<bool> desc_mode;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> base_addr;
+    sc_signal<int> num_samples;
+    sc_signal<int> fft_len;
+    sc_signal<int> active_len;
+    sc_signal<int> window;
+    sc_signal<int> active_window;
+    sc_signal<int> stft_hop;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> stft_dst;
+    sc_signal<int> stft_pitch;
+    sc_signal<int> bin_lo;
+    sc_signal<int> bin_hi;
+    sc_signal<int> active_bin_lo;
+    sc_signal<int> active_bin_hi;
+    sc_signal<bool> inverse;
+    sc_signal<bool> active_inverse;
+    sc_signal<int> conv_taps;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> filter_addr;
+    sc_signal<bool> filter_load;
+    sc_signal<bool> busy;
+    sc_signal<int> rd_outstanding;
+    sc_signal<int> wr_outstanding;
+
+    typename axi4<AxiCfg>::read::template chan<> read_chan;
+    typename axi4<AxiCfg>::write::template chan<> write_chan;
+    Combinational<complex_t> to_pipe_chan;
+    Combinational<complex_t> from_pipe_chan;
+
+    DMA<AxiCfg, N> dma;
+    Loopback loopback;
+    Memory<(1 << 15), AxiCfg, 0> mem;
+    BenchCounters result;
+    int samples;
+
+    SC_HAS_PROCESS(DmaBench);
+    DmaBench(sc_module_name name, int samples) :
+        sc_module(name),
+        clk("clk", 1, SC_NS),
+        rst_n("rst_n"),
+        read_chan("read_chan"),
+        write_chan("write_chan"),
+        to_pipe_chan("to_pipe_chan"),
+        from_pipe_chan("from_pipe_chan"),
+        dma("dma"),
+        loopback("loopback"),
+        mem("mem"),
+        samples(samples)
+    {
+        Connections::set_sim_clk(&clk);
+
+        dma.clk(clk);
+        dma.rst_n(rst_n);
+        dma.start(start);
+        dma.stream_mode(stream_mode);
+        dma.desc_mode(desc_mode);
+        dma.base_addr(base_addr);
+        dma.num_samples(num_samples);
+        dma.fft_len(fft_len);
+        dma.active_len(active_len);
+        dma.window(window);
+        dma.active_window(active_window);
+        dma.stft_hop(stft_hop);
+        dma.stft_dst(stft_dst);
+        dma.stft_pitch(stft_pitch);
+        dma.bin_lo(bin_lo);
+        dma.bin_hi(bin_hi);
+        dma.active_bin_lo(active_bin_lo);
+        dma.active_bin_hi(active_bin_hi);
+        dma.inverse(inverse);
+        dma.active_inverse(active_inverse);
+        dma.conv_taps(conv_taps);
+        dma.filter_addr(filter_addr);
+        dma.filter_load(filter_load);
+        dma.busy(busy);
+        dma.rd_outstanding(rd_outstanding);
+        dma.wr_outstanding(wr_outstanding);
+        dma.mem_read_port(read_chan);
+        dma.mem_write_port(write_chan);
+        dma.fft_out(to_pipe_chan);
+        dma.fft_in(from_pipe_chan);
+
+        loopback.clk(clk);
+        loopback.rst_n(rst_n);
+        loopback.in_data(to_pipe_chan);
+        loopback.out_data(from_pipe_chan);
+
+        mem.clk(clk);
+        mem.rst_n(rst_n);
+        mem.read_port(read_chan);
+        mem.write_port(write_chan);
+
+        SC_THREAD(stimuli);
+        sensitive << clk.posedge_event();
+    }
+
+    void stimuli() {
+        rst_n.write(false);
+        start.write(false);
+        stream_mode.write(false);
+        desc_mode.write(false);
+        wait(5, SC_NS);
+        rst_n.write(true);
+        wait(5, SC_NS);
+
+        base_addr.write(0);
+        num_samples.write(samples);
+        start.write(true);
+        sc_time t0 = sc_time_stamp();
+        wait(1, SC_NS);
+        start.write(false);
+        wait(2, SC_NS);
+        while (busy.read()) {
+            wait(1, SC_NS);
+        }
+        result.units = samples;
+        result.cycles = cycles_since(t0, clk.period());
+        result.done = true;
+        sc_stop();
+    }
+};
+
+// Back-to-back BURST_BEATS-beat bursts of a master against a zero-latency Memory, reads or
+// writes; cycles are counted from the first request to the last R beat or B response
+template<bool WRITE>
+SC_MODULE(MemoryBench) {
+    static const int bytesPerBeat = AxiCfg::dataWidth / 8;
+
+    sc_clock clk;
+    sc_signal<bool> rst_n;
+
+    typename axi4<AxiCfg>::read::template chan<> read_chan;
+    typename axi4<AxiCfg>::write::template chan<> write_chan;
+    typename axi4<AxiCfg>::read::template master<> rd_port;
+    typename axi4<AxiCfg>::write::template master<> wr_port;
+
+    Memory<(1 << 15), AxiCfg, 0> mem;
+    BenchCounters result;
+    int bursts;
+
+    SC_HAS_PROCESS(MemoryBench);
+    MemoryBench(sc_module_name name, int beats) :
+        sc_module(name),
+        clk("clk", 1, SC_NS),
+        rst_n("rst_n"),
+        read_chan("read_chan"),
+        write_chan("write_chan"),
+        rd_port("rd_port"),
+        wr_port("wr_port"),
+        mem("mem"),
+        bursts(std::max(1, beats / BURST_BEATS))
+    {
+        Connections::set_sim_clk(&clk);
+
+        mem.clk(clk);
+        mem.rst_n(rst_n);
+        mem.read_port(read_chan);
+        mem.write_port(write_chan);
+        rd_port(read_chan);
+        wr_port(write_chan);
+
+        SC_THREAD(reset_thread);
+        SC_THREAD(master_thread);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+    }
+
+    void reset_thread() {
+        rst_n.write(false);
+        wait(5, SC_NS);
+        rst_n.write(true);
+    }
+
+    typename axi4<AxiCfg>::AddrPayload burst_req(int burst) {
+        typename axi4<AxiCfg>::AddrPayload req;
+        req.addr = (unsigned int)(burst * BURST_BEATS * bytesPerBeat) % ((1 << 15) * bytesPerBeat);
+        req.id = 0;
+        req.len = BURST_BEATS - 1;
+        req.size = (int)std::log2(bytesPerBeat);
+        req.burst = 1; // INCR burst
+        return req;
+    }
+
+    void master_thread() {
+        rd_port.reset();
+        wr_port.reset();
+        wait();
+
+        sc_time t0 = sc_time_stamp();
+        int issued = 0;    // Address requests accepted
+        int sent = 0;      // Write bursts whose data is all sent
+        int beat = 0;      // Next write beat of burst `sent`
+        int completed = 0; // Read bursts with their last beat in, write bursts with their response
+        while (completed < bursts) {
+            if (issued < bursts && (!WRITE || issued == sent)) {
+                if (WRITE ? wr_port.aw.PushNB(burst_req(issued)) : rd_port.ar.PushNB(burst_req(issued))) {
+                    issued++;
+                }
+            }
+            if (WRITE) {
+                typename axi4<AxiCfg>::WritePayload w;
+                w.data = beat;
+                w.wstrb = ~0;
+                w.last = (beat == BURST_BEATS - 1);
+                if (sent < issued && wr_port.w.PushNB(w) && ++beat == BURST_BEATS) {
+                    beat = 0;
+                    sent++;
+                }
+                typename axi4<AxiCfg>::WRespPayload resp;
+                if (wr_port.b.PopNB(resp)) {
+                    completed++;
+                }
+            } else {
+                typename axi4<AxiCfg>::ReadPayload resp;
+                if (rd_port.r.PopNB(resp) && resp.last) {
+                    completed++;
+                }
+            }
+            wait();
+        }
+        result.units = (unsigned long)bursts * BURST_BEATS;
+        result.cycles = cycles_since(t0, clk.period());
+        result.done = true;
+        sc_stop();
+    }
+};
+
+// Elaborate and simulate one benchmark; prints its BENCH_RESULT line
+template<typename Bench>
+int run_bench(const std::string& name, int samples) {
+    std::unique_ptr<Bench> bench(new Bench("bench", samples));
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    sc_start(sc_time(1000.0 * samples + 1e6, SC_NS)); // Generous bound on a hung model
+    double host_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    if (!bench->result.done) {
+        std::cout << "Error: benchmark " << name << " did not complete @ " << sc_time_stamp() << std::endl;
+        return 1;
+    }
+    unsigned long sim_cycles = (unsigned long)(sc_time_stamp() / bench->clk.period() + 0.5);
+    std::cout << "BENCH_RESULT: NAME=" << name << " UNITS=" << bench->result.units
+              << " CYCLES=" << bench->result.cycles << " SIM_CYCLES=" << sim_cycles
+              << " HOST_NS=" << std::fixed << std::setprecision(0) << host_ns << std::endl;
+    return 0;
+}
+
+struct BenchCase {
+    const char* name;
+    const char* unit;
+    int (*run)(const std::string&, int);
+};
+
+static const BenchCase bench_cases[] = {
+    { "stage_n1024", "sample", &run_bench<StreamBench<Stage<BENCH_N>, BENCH_N / 2>> },
+    { "fft_n1024", "sample", &run_bench<StreamBench<FFT<BENCH_N>, BENCH_N>> },
+    { "dma_n1024", "sample", &run_bench<DmaBench<BENCH_N>> },
+    { "memory_read", "beat", &run_bench<MemoryBench<false>> },
+    { "memory_write", "beat", &run_bench<MemoryBench<true>> },
+};
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    unsigned long units;
+    unsigned long cycles;
+    unsigned long sim_cycles;
+    double host_ns;
+};
+
+static std::string option_value(int argc, char* argv[], const std::string& option) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (option == argv[i]) {
+            return argv[i + 1];
+        }
+    }
+    return "";
+}
+
+static void write_results(const std::string& path, int samples, const std::vector<BenchResult>& results) {
+    std::ofstream ofs(path);
+    rapidjson::OStreamWrapper osw(ofs);
+    rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(osw);
+    writer.StartObject();
+    writer.Key("samples"); writer.Int(samples);
+    writer.Key("benchmarks");
+    writer.StartArray();
+    for (const BenchResult& r : results) {
+        writer.StartObject();
+        writer.Key("name"); writer.String(r.name.c_str());
+        writer.Key("unit"); writer.String(r.unit.c_str());
+        writer.Key("units"); writer.Uint64(r.units);
+        writer.Key("cycles"); writer.Uint64(r.cycles);
+        writer.Key("cycles_per_unit"); writer.Double((double)r.cycles / r.units);
+        writer.Key("sim_cycles"); writer.Uint64(r.sim_cycles);
+        writer.Key("host_ns"); writer.Double(r.host_ns);
+        writer.Key("host_ns_per_cycle"); writer.Double(r.host_ns / r.sim_cycles);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    ofs << std::endl;
+}
+
+int sc_main(int argc, char* argv[]) {
+    sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", SC_DO_NOTHING);
+    sc_set_default_time_unit(1.0, SC_NS);
+
+    // Whole frames of the BENCH_N-point blocks
+    std::string samples_opt = option_value(argc, argv, "--samples");
+    int samples = samples_opt.empty() ? 16 * BENCH_N : std::atoi(samples_opt.c_str());
+    samples = std::max(1, (samples + BENCH_N - 1) / BENCH_N) * BENCH_N;
+    std::string case_name = option_value(argc, argv, "--case");
+
+    if (!case_name.empty()) {
+        for (const BenchCase& c : bench_cases) {
+            if (case_name == c.name) {
+                return c.run(c.name, samples);
+            }
+        }
+        std::cerr << "Error: unknown benchmark " << case_name << std::endl;
+        return 1;
+    }
+
+    const char* out_dir_env = std::getenv("SIM_OUT_DIR");
+    std::string out_dir = std::string((out_dir_env != nullptr) ? out_dir_env : "out") + "/bench";
+    std::filesystem::create_directories(out_dir);
+    std::string out_file = option_value(argc, argv, "--out");
+    if (out_file.empty()) {
+        out_file = out_dir + "/bench.json";
+    }
+
+    // Every benchmark elaborates in its own child process, one at a time so that the host
+    // timings do not compete for cores
+    std::vector<BenchResult> results;
+    int failures = 0;
+    for (const BenchCase& c : bench_cases) {
+        std::string log_path = out_dir + "/" + c.name + "_log.txt";
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (std::freopen(log_path.c_str(), "w", stdout) == nullptr) {
+                std::_Exit(1);
+            }
+            std::exit(c.run(c.name, samples));
+        }
+        int status = 0;
+        if (pid > 0) {
+            waitpid(pid, &status, 0);
+        }
+
+        BenchResult r = { c.name, c.unit, 0, 0, 0, 0.0 };
+        bool parsed = false;
+        std::ifstream log(log_path);
+        std::string line;
+        while (std::getline(log, line)) {
+            char name[64];
+            if (std::sscanf(line.c_str(), "BENCH_RESULT: NAME=%63s UNITS=%lu CYCLES=%lu SIM_CYCLES=%lu HOST_NS=%lf",
+                            name, &r.units, &r.cycles, &r.sim_cycles, &r.host_ns) == 5 &&
+                r.name == name) {
+                parsed = true;
+            }
+        }
+        if (pid <= 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !parsed || r.units == 0 || r.sim_cycles == 0) {
+            std::cout << "[ FAILED ] " << c.name << " (see " << log_path << ")" << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << "[ BENCH ] " << std::left << std::setw(14) << c.name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(9) << (double)r.cycles / r.units << " cycles/" << c.unit
+                  << std::setprecision(1) << std::setw(10) << r.host_ns / r.sim_cycles << " host ns/cycle" << std::endl;
+        results.push_back(r);
+    }
+
+    write_results(out_file, samples, results);
+    std::cout << "Results written to " << out_file << std::endl;
+    std::cout << "SUMMARY: RUNS=" << results.size() + failures << " FAILURES=" << failures << std::endl;
+    return (failures > 0) ? 1 : 0;
+}
@@ -4,8 +4,8 @@
 int sc_main(int argc, char* argv[]) {
     std::cout << "Starting Interleaved FFT Simulation" << std::endl;
 
-    // Simulation parameters: N=4, Cores=2, Hop=1, NUM_MULT=4, NUM_ADD=6
-    Testbench<8, 2, 1, 2, 2> tb("tb");
+    // Simulation parameters: N=8, Cores=2, Hop=1, NUM_MULT=2, NUM_ADD=2, 16-cycle memory read latency
+    Testbench<8, 2, 1, 2, 2, 16> tb("tb");
     
     sc_start();
     
@@ -0,0 +1,146 @@
+/*
+ * sample_logger.h
+ *
+ * Asynchronous beat logger of the system testbenches. The monitor records every R/W data
+ * beat as a raw {time, AXI word} pair into a preallocated single-producer ring buffer per
+ * stream; a background thread drains the buffers into compact binary files, so the
+ * simulation thread neither allocates nor formats. sample_log_convert.py turns the files
+ * into the Timestamp,Real,Imaginary CSV read by plot_fft_output.py.
+ *
+ * File layout: "FFTBEAT2", uint32 AXI data width, uint32 samples per beat, then
+ * {uint64 time (ps), uint64 word} records in host byte order.
+ */
+
+#ifndef SAMPLE_LOGGER_H
+#define SAMPLE_LOGGER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BeatRecord {
+    uint64_t time_ps;
+    uint64_t data;
+};
+
+class SampleLogger {
+public:
+    // capacity: records per stream buffer, rounded up to a power of two
+    explicit SampleLogger(size_t capacity = 1 << 16) : capacity(4), stop(false) {
+        while (this->capacity < capacity) {
+            this->capacity <<= 1;
+        }
+    }
+
+    ~SampleLogger() {
+        close();
+    }
+
+    // Open one stream before start(); returns its index for log()
+    int open(const std::string& path, int data_width, int lanes = 1) {
+        Stream* s = new Stream(capacity);
+        s->os.open(path, std::ios::binary);
+        if (!s->os.good()) {
+            std::cerr << "Warning: cannot open sample log " << path << std::endl;
+        }
+        uint32_t header[2] = {(uint32_t)data_width, (uint32_t)lanes};
+        s->os.write("FFTBEAT2", 8);
+        s->os.write(reinterpret_cast<const char*>(header), sizeof(header));
+        streams.emplace_back(s);
+        return (int)streams.size() - 1;
+    }
+
+    void start() {
+        writer = std::thread(&SampleLogger::writer_loop, this);
+    }
+
+    // Simulation thread: blocks only while the writer is a full buffer behind
+    void log(int stream, uint64_t time_ps, uint64_t data) {
+        Stream& s = *streams[stream];
+        size_t head = s.head.load(std::memory_order_relaxed);
+        while (head - s.tail.load(std::memory_order_acquire) >= capacity) {
+            wake();
+            std::this_thread::yield();
+        }
+        BeatRecord& r = s.buf[head & (capacity - 1)];
+        r.time_ps = time_ps;
+        r.data = data;
+        s.head.store(head + 1, std::memory_order_release);
+        // Hand over a quarter buffer at a time
+        if (((head + 1) & (capacity / 4 - 1)) == 0) {
+            wake();
+        }
+    }
+
+    // Drain every buffer, stop the writer and close the files
+    void close() {
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            cv.notify_one();
+            writer.join();
+        }
+        for (auto& s : streams) {
+            drain(*s);
+            s->os.close();
+        }
+    }
+
+private:
+    struct Stream {
+        explicit Stream(size_t capacity) : buf(capacity), head(0), tail(0) {}
+        std::vector<BeatRecord> buf;
+        std::atomic<size_t> head; // Next record written by the simulation thread
+        std::atomic<size_t> tail; // Next record written to the file
+        std::ofstream os;
+    };
+
+    size_t capacity;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stop;
+
+    // Lock-free: a missed notification only delays the writer until its timeout
+    void wake() {
+        cv.notify_one();
+    }
+
+    void drain(Stream& s) {
+        size_t tail = s.tail.load(std::memory_order_relaxed);
+        size_t head = s.head.load(std::memory_order_acquire);
+        while (tail != head) {
+            size_t first = tail & (capacity - 1);
+            size_t count = std::min(head - tail, capacity - first);
+            s.os.write(reinterpret_cast<const char*>(&s.buf[first]), count * sizeof(BeatRecord));
+            tail += count;
+            s.tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    void writer_loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stop) {
+            lock.unlock();
+            for (auto& s : streams) {
+                drain(*s);
+            }
+            lock.lock();
+            cv.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+};
+
+#endif // SAMPLE_LOGGER_H
@@ -0,0 +1,64 @@
+#ifndef TB_BANKED_MEMORY_H
+#define TB_BANKED_MEMORY_H
+
+#define BOOST_NULLPTR nullptr
+#define HLS_CATAPULT
+
+#include <systemc.h>
+#include <axi/axi4.h>
+#include <connections/connections.h>
+#include <axi/testbench/Master.h>
+#include "banked_memory.h"
+
+using namespace sc_core;
+using namespace axi;
+using namespace Connections;
+
+typedef axi::cfg::standard AxiCfg;
+
+// Two masters exercising disjoint halves of the shared banks
+struct MasterCfgLow {
+    enum {
+        numWrites = 50,
+        numReads = 50,
+        readDelay = 10,
+        seed = 42,
+    };
+    static const uint64_t addrBoundLower = 0x0;
+    static const uint64_t addrBoundUpper = 0x1F8;
+};
+
+struct MasterCfgHigh {
+    enum {
+        numWrites = 50,
+        numReads = 50,
+        readDelay = 10,
+        seed = 7,
+    };
+    static const uint64_t addrBoundLower = 0x200;
+    static const uint64_t addrBoundUpper = 0x3F8;
+};
+
+SC_MODULE(Testbench) {
+    sc_clock clk;
+    sc_signal<bool> rst_n; // Active-low reset
+    sc_signal<bool> done_low;
+    sc_signal<bool> done_high;
+
+    sc_vector<typename axi4<AxiCfg>::read::template chan<>> read_chans;
+    sc_vector<typename axi4<AxiCfg>::write::template chan<>> write_chans;
+
+    Master<AxiCfg, MasterCfgLow>* master_low;
+    Master<AxiCfg, MasterCfgHigh>* master_high;
+    BankedMemory<1024, AxiCfg, 2, 4, ARB_QOS>* mem;
+
+    sc_trace_file* tf;
+
+    SC_CTOR(Testbench);
+    ~Testbench();
+
+    void stimuli();
+    bool check_arbitration();
+};
+
+#endif // TB_BANKED_MEMORY_H
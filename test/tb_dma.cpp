@@ -10,7 +10,8 @@ Testbench::Testbench(sc_module_name name)
       fft_out_chan("fft_out_chan"),
       fft_in_chan("fft_in_chan"),
       tb_fft_in("tb_fft_in"),
-      tb_fft_out("tb_fft_out")
+      tb_fft_out("tb_fft_out"),
+      filter_beats(0)
 {
     // Instantiate Slave
     slave_inst = new Slave<AxiCfg>("Slave");
@@ -22,9 +23,29 @@ Testbench::Testbench(sc_module_name name)
     dma_inst->clk(clk);
     dma_inst->rst_n(rst_n);
     dma_inst->start(start);
+    dma_inst->stream_mode(stream_mode);
+    dma_inst->desc_mode(desc_mode);
     dma_inst->base_addr(base_addr);
     dma_inst->num_samples(num_samples);
+    dma_inst->fft_len(fft_len);
+    dma_inst->active_len(active_len);
+    dma_inst->window(window);
+    dma_inst->active_window(active_window);
+    dma_inst->stft_hop(stft_hop);
+    dma_inst->stft_dst(stft_dst);
+    dma_inst->stft_pitch(stft_pitch);
+    dma_inst->bin_lo(bin_lo);
+    dma_inst->bin_hi(bin_hi);
+    dma_inst->active_bin_lo(active_bin_lo);
+    dma_inst->active_bin_hi(active_bin_hi);
+    dma_inst->inverse(inverse);
+    dma_inst->active_inverse(active_inverse);
+    dma_inst->conv_taps(conv_taps);
+    dma_inst->filter_addr(filter_addr);
+    dma_inst->filter_load(filter_load);
     dma_inst->busy(busy);
+    dma_inst->rd_outstanding(rd_outstanding);
+    dma_inst->wr_outstanding(wr_outstanding);
     
     // Connect DMA to Slave directly
     dma_inst->mem_read_port(read_chan);
@@ -46,6 +67,8 @@ Testbench::Testbench(sc_module_name name)
     sc_trace(tf, rst_n, "rst_n");
     sc_trace(tf, start, "start");
     sc_trace(tf, busy, "busy");
+    sc_trace(tf, rd_outstanding, "rd_outstanding");
+    sc_trace(tf, wr_outstanding, "wr_outstanding");
 
     SC_THREAD(stimuli);
     sensitive << clk.posedge_event();
@@ -60,6 +83,37 @@ Testbench::~Testbench() {
     sc_close_vcd_trace_file(tf);
 }
 
+void Testbench::slave_write(uint64_t byte_addr, sc_uint<AxiCfg::dataWidth> data) {
+    slave_inst->localMem[byte_addr] = data;
+    for (int j = 0; j < (AxiCfg::dataWidth / 8); j++) {
+        slave_inst->localMem_wstrb[byte_addr + j] = nvhls::get_slc<8>(data, 8 * j);
+    }
+    slave_inst->validReadAddresses.push_back(byte_addr);
+}
+
+sc_uint<AxiCfg::dataWidth> Testbench::slave_read(uint64_t byte_addr) {
+    sc_uint<AxiCfg::dataWidth> raw = 0;
+    for (int j = 0; j < (AxiCfg::dataWidth / 8); j++) {
+        raw = nvhls::set_slc(raw, slave_inst->localMem_wstrb[byte_addr + j], 8 * j);
+    }
+    return raw;
+}
+
+bool Testbench::check_outputs(uint64_t byte_addr, const double* expected, int len) {
+    bool pass = true;
+    for (int i = 0; i < len; i++) {
+        complex_t val = unpack_complex<AxiCfg>(slave_read(byte_addr + i * (AxiCfg::dataWidth / 8)));
+        std::cout << "  Addr[0x" << std::hex << byte_addr + i * (AxiCfg::dataWidth / 8) << std::dec << "] = " << val;
+        if (std::abs(val.real - expected[i]) < 1e-2 && std::abs(val.imag) < 1e-2) {
+            std::cout << " [OK]" << std::endl;
+        } else {
+            std::cout << " [ERROR: expected " << expected[i] << "]" << std::endl;
+            pass = false;
+        }
+    }
+    return pass;
+}
+
 void Testbench::monitor() {
     tb_fft_in.Reset();
     tb_fft_out.Reset();
@@ -68,6 +122,12 @@ void Testbench::monitor() {
     while (true) {
         complex_t val = tb_fft_in.Pop();
         std::cout << "[DMA TB] Received from DMA: " << val << " @ " << sc_time_stamp() << std::endl;
+
+        // A filter spectrum stays in the (simulated) filter multiply
+        if (filter_load.read()) {
+            filter_beats++;
+            continue;
+        }
         
         // Simulating FFT core behavior (bias bypass)
         complex_t out_val = val + complex_t(100.0, 0.0);
@@ -80,6 +140,8 @@ void Testbench::stimuli() {
     std::cout << "[DMA TB] Asserting Reset..." << std::endl;
     rst_n.write(false);
     start.write(false);
+    stream_mode.write(false);
+    desc_mode.write(false);
     wait(20, SC_NS);
     
     rst_n.write(true);
@@ -131,6 +193,173 @@ void Testbench::stimuli() {
         }
     }
 
+    // Scatter-gather: two chained descriptors gather the even and odd samples of a
+    // source buffer with a two-beat stride into separate output buffers
+    const int bpb = AxiCfg::dataWidth / 8;
+    const uint64_t src_base = 0x400;
+    const uint64_t desc_base = 0x100;
+    for (int i = 0; i < 8; i++) {
+        slave_write(src_base + i * bpb, pack_complex<AxiCfg>((double)i, 0.0));
+    }
+    for (int d = 0; d < 2; d++) {
+        uint64_t desc_addr = desc_base + d * 4 * bpb;
+        uint64_t next = (d == 0) ? desc_base + 4 * bpb : 0;
+        slave_write(desc_addr + 0 * bpb, src_base + d * bpb);
+        slave_write(desc_addr + 1 * bpb, 0x200 + d * 0x40);
+        slave_write(desc_addr + 2 * bpb, ((uint64_t)4 << (AxiCfg::dataWidth / 2)) | (2 * bpb));
+        slave_write(desc_addr + 3 * bpb, next);
+    }
+    wait(10, SC_NS);
+
+    std::cout << "[DMA TB] Launching descriptor chain (Head: 0x" << std::hex << desc_base << std::dec << ")..." << std::endl;
+    desc_mode.write(true);
+    base_addr.write(desc_base);
+    start.write(true);
+    wait(10, SC_NS);
+    start.write(false);
+    wait(20, SC_NS);
+
+    while (busy.read()) {
+        wait(10, SC_NS);
+    }
+    wait(50, SC_NS);
+
+    std::cout << "[DMA TB] Verifying gathered frames..." << std::endl;
+    const double even_expected[4] = { 100.0, 102.0, 104.0, 106.0 };
+    const double odd_expected[4] = { 101.0, 103.0, 105.0, 107.0 };
+    pass &= check_outputs(0x200, even_expected, 4);
+    pass &= check_outputs(0x240, odd_expected, 4);
+
+    // STFT: a streamed job over 10 samples with a hop of 2 reads every sample once and
+    // writes the 4 overlapping frames two frames apart
+    const uint64_t stft_src = 0x600;
+    const uint64_t stft_out = 0x800;
+    for (int i = 0; i < 10; i++) {
+        slave_write(stft_src + i * bpb, pack_complex<AxiCfg>((double)i, 0.0));
+    }
+    unsigned long reads_before = dma_inst->perf.read.beats;
+    wait(10, SC_NS);
+
+    std::cout << "[DMA TB] Launching STFT job (Hop: 2, Len: 10)..." << std::endl;
+    desc_mode.write(false);
+    stream_mode.write(true);
+    base_addr.write(stft_src);
+    num_samples.write(10);
+    stft_hop.write(2);
+    stft_dst.write(stft_out);
+    stft_pitch.write(8 * bpb);
+    start.write(true);
+    wait(10, SC_NS);
+    start.write(false);
+    wait(20, SC_NS);
+
+    while (busy.read()) {
+        wait(10, SC_NS);
+    }
+    wait(50, SC_NS);
+
+    std::cout << "[DMA TB] Verifying STFT frames..." << std::endl;
+    for (int f = 0; f < 4; f++) {
+        double frame_expected[4];
+        for (int i = 0; i < 4; i++) {
+            frame_expected[i] = 100.0 + 2 * f + i;
+        }
+        pass &= check_outputs(stft_out + f * 8 * bpb, frame_expected, 4);
+    }
+    unsigned long stft_reads = dma_inst->perf.read.beats - reads_before;
+    std::cout << "  Sample beats read: " << stft_reads;
+    if (stft_reads == 10) {
+        std::cout << " [OK]" << std::endl;
+    } else {
+        std::cout << " [ERROR: expected 10]" << std::endl;
+        pass = false;
+    }
+
+    // Output pruning: bin range [1, 2) of a 4-point frame is bit-reversed position 2, the
+    // only beat written back; the other output slots keep their marker
+    const uint64_t bins_src = 0xA00;
+    const uint64_t bins_out = bins_src + 4 * bpb;
+    for (int i = 0; i < 4; i++) {
+        slave_write(bins_src + i * bpb, pack_complex<AxiCfg>((double)i, 0.0));
+        slave_write(bins_out + i * bpb, pack_complex<AxiCfg>(-1.0, 0.0));
+    }
+    unsigned long writes_before = dma_inst->perf.write.beats;
+    wait(10, SC_NS);
+
+    std::cout << "[DMA TB] Launching bin range job (Bins: [1, 2), Len: 4)..." << std::endl;
+    base_addr.write(bins_src);
+    num_samples.write(4);
+    stft_hop.write(0);
+    bin_lo.write(1);
+    bin_hi.write(2);
+    start.write(true);
+    wait(10, SC_NS);
+    start.write(false);
+    wait(20, SC_NS);
+
+    while (busy.read()) {
+        wait(10, SC_NS);
+    }
+    wait(50, SC_NS);
+
+    std::cout << "[DMA TB] Verifying selected bins..." << std::endl;
+    const double bins_expected[4] = { -1.0, -1.0, 102.0, -1.0 };
+    pass &= check_outputs(bins_out, bins_expected, 4);
+    unsigned long bin_writes = dma_inst->perf.write.beats - writes_before;
+    std::cout << "  Output beats written: " << bin_writes;
+    if (bin_writes == 1) {
+        std::cout << " [OK]" << std::endl;
+    } else {
+        std::cout << " [ERROR: expected 1]" << std::endl;
+        pass = false;
+    }
+
+    // Overlap-save: 6 samples through a 2-tap filter run as 2 frames 3 samples apart, the
+    // first behind one zero of history; the first output of every frame is dropped, so the
+    // biased samples come back in place of the input after one filter load
+    const uint64_t conv_src = 0xC00;
+    const uint64_t conv_filter = 0xB00;
+    for (int i = 0; i < 6; i++) {
+        slave_write(conv_src + i * bpb, pack_complex<AxiCfg>((double)i, 0.0));
+    }
+    for (int i = 0; i < 4; i++) {
+        slave_write(conv_filter + i * bpb, pack_complex<AxiCfg>(1.0, 0.0));
+    }
+    reads_before = dma_inst->perf.read.beats;
+    wait(10, SC_NS);
+
+    std::cout << "[DMA TB] Launching overlap-save job (Taps: 2, Len: 6)..." << std::endl;
+    base_addr.write(conv_src);
+    num_samples.write(6);
+    bin_lo.write(0);
+    bin_hi.write(0);
+    conv_taps.write(2);
+    filter_addr.write(conv_filter);
+    start.write(true);
+    wait(10, SC_NS);
+    start.write(false);
+    wait(20, SC_NS);
+
+    while (busy.read()) {
+        wait(10, SC_NS);
+    }
+    wait(50, SC_NS);
+
+    std::cout << "[DMA TB] Verifying overlap-save output..." << std::endl;
+    double conv_expected[6];
+    for (int i = 0; i < 6; i++) {
+        conv_expected[i] = 100.0 + i;
+    }
+    pass &= check_outputs(conv_src + 4 * bpb, conv_expected, 6);
+    unsigned long conv_reads = dma_inst->perf.read.beats - reads_before;
+    std::cout << "  Beats read: " << conv_reads << ", filter beats: " << filter_beats;
+    if (conv_reads == 10 && filter_beats == 4) {
+        std::cout << " [OK]" << std::endl;
+    } else {
+        std::cout << " [ERROR: expected 10 and 4]" << std::endl;
+        pass = false;
+    }
+
     if (pass) {
         std::cout << "[DMA TB] DMA VERIFICATION PASSED." << std::endl;
     } else {
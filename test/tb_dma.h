@@ -19,9 +19,29 @@ SC_MODULE(Testbench) {
     
     // Control signals
     sc_signal<bool> start;
+    sc_signal<bool> stream_mode;
+    sc_signal<bool> desc_mode;
     sc_signal<sc_uint<AxiCfg::addrWidth>> base_addr;
     sc_signal<int> num_samples;
+    sc_signal<int> fft_len;    // Tied to 0: full-length jobs
+    sc_signal<int> active_len;
+    sc_signal<int> window;     // Tied to 0: rectangular window
+    sc_signal<int> active_window;
+    sc_signal<int> stft_hop;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> stft_dst;
+    sc_signal<int> stft_pitch;
+    sc_signal<int> bin_lo;
+    sc_signal<int> bin_hi;
+    sc_signal<int> active_bin_lo;
+    sc_signal<int> active_bin_hi;
+    sc_signal<bool> inverse;
+    sc_signal<bool> active_inverse;
+    sc_signal<int> conv_taps;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> filter_addr;
+    sc_signal<bool> filter_load;
     sc_signal<bool> busy;
+    sc_signal<int> rd_outstanding;
+    sc_signal<int> wr_outstanding;
     
     // AXI channels (default port types)
     typename axi4<AxiCfg>::read::template chan<> read_chan;
@@ -35,6 +55,8 @@ SC_MODULE(Testbench) {
     In<complex_t> tb_fft_in;
     Out<complex_t> tb_fft_out;
 
+    int filter_beats; // Filter spectrum beats taken off the stream by the monitor
+
     Slave<AxiCfg>* slave_inst;
     DMA<AxiCfg, 4>* dma_inst;
 
@@ -45,6 +67,11 @@ SC_MODULE(Testbench) {
     
     void stimuli();
     void monitor();
+
+    // Slave memory backdoor access
+    void slave_write(uint64_t byte_addr, sc_uint<AxiCfg::dataWidth> data);
+    sc_uint<AxiCfg::dataWidth> slave_read(uint64_t byte_addr);
+    bool check_outputs(uint64_t byte_addr, const double* expected, int len);
 };
 
 #endif // TB_DMA_H
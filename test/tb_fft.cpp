@@ -2,13 +2,23 @@
 #include <vector>
 #include <connections/connections.h>
 #include "fft.h"
+#include "folded_fft.h"
+#include <type_traits>
 
 using namespace std;
 using namespace Connections;
 
+// Butterfly units of the folded FFT under test (0: pipelined stage cascade)
+#ifndef FFT_FOLD_BF
+#define FFT_FOLD_BF 0
+#endif
+
 // Standalone FFT Core Testbench
-template<int N, int NUM_MULT=4, int NUM_ADD=6>
+template<int N, int NUM_MULT=4, int NUM_ADD=6, int FOLD_BF=0>
 SC_MODULE(FFT_TB) {
+    typedef typename std::conditional<(FOLD_BF > 0), FoldedFFT<N, FOLD_BF, NUM_MULT, NUM_ADD>,
+                                      FFT<N, NUM_MULT, NUM_ADD>>::type FftType;
+
     sc_clock                clk;
     sc_signal<bool>         rst_n;
 
@@ -18,7 +28,7 @@ SC_MODULE(FFT_TB) {
     Out<complex_t> tb_in_port;
     In<complex_t> tb_out_port;
 
-    FFT<N, NUM_MULT, NUM_ADD>* fft;
+    FftType* fft;
     sc_trace_file* tf;
 
     sc_signal<double> trace_in_real;
@@ -33,7 +43,7 @@ SC_MODULE(FFT_TB) {
         tb_in_port("tb_in_port"),
         tb_out_port("tb_out_port") 
     {
-        fft = new FFT<N, NUM_MULT, NUM_ADD>("fft");
+        fft = new FftType("fft");
         fft->clk(clk);
         fft->rst_n(rst_n);
         fft->in_data(in_chan);
@@ -156,7 +166,7 @@ SC_MODULE(FFT_TB) {
 
 int sc_main(int argc, char* argv[]) {
     const int N = 8;
-    FFT_TB<N> tb("fft_tb");
+    FFT_TB<N, 4, 6, FFT_FOLD_BF> tb("fft_tb");
     sc_start();
     cout << "FFT Module Simulation Finished." << endl;
     return 0;
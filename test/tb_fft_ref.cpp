@@ -0,0 +1,48 @@
+#include <systemc.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "fft_ref.h"
+
+// Reference FFT testbench (built for the host CPU): the AVX2/NEON butterflies against the
+// scalar ones on random frames of every size from 2 to 4096 points, odd log2 sizes included
+// for the trailing radix-2 pass
+static bool check_size(int n, boost::random::mt19937& gen) {
+    boost::random::uniform_real_distribution<> uniform_rand(-32768.0, 32767.0);
+    std::vector<complex_t> input(3 * n);
+    for (complex_t& x : input) {
+        x = complex_t(uniform_rand(gen), uniform_rand(gen));
+    }
+
+    std::vector<complex_t> simd = BasicFftReference<fft_ref::SimdVec>(n).frames(input);
+    std::vector<complex_t> scalar = BasicFftReference<fft_ref::ScalarVec>(n).frames(input);
+    double max_err = 0.0;
+    for (size_t i = 0; i < simd.size(); ++i) {
+        double err = std::max(std::abs(simd[i].real - scalar[i].real), std::abs(simd[i].imag - scalar[i].imag));
+        max_err = std::max(max_err, err);
+    }
+    // Both run the same operations in the same order, rounding may only differ by contraction
+    bool pass = max_err <= 1e-9 * n * 32768.0;
+    if (!pass) {
+        std::cout << "[FFT REF TB] N=" << n << " SIMD/scalar mismatch, max error " << max_err << std::endl;
+    }
+    return pass;
+}
+
+int sc_main(int argc, char* argv[]) {
+    std::cout << "[FFT REF TB] Vector width " << fft_ref::SimdVec::width << " doubles" << std::endl;
+    boost::random::mt19937 gen(0);
+    bool all_pass = true;
+    for (int n = 2; n <= 4096; n *= 2) {
+        all_pass = check_size(n, gen) && all_pass;
+    }
+    if (all_pass) {
+        std::cout << "[FFT REF TB] ALL TESTS PASSED." << std::endl;
+    } else {
+        std::cout << "[FFT REF TB] SIMD reference FFT FAILED." << std::endl;
+    }
+    return all_pass ? 0 : 1;
+}
@@ -1,5 +1,8 @@
 #include "tb_memory.h"
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <vector>
 
 Testbench::Testbench(sc_module_name name)
     : sc_module(name),
@@ -9,7 +12,7 @@ Testbench::Testbench(sc_module_name name)
 {
     // Instantiate sub-modules
     master = new Master<AxiCfg, MyMasterCfg>("master");
-    mem = new Memory<1024, AxiCfg>("mem");
+    mem = new Memory<1024, AxiCfg, 8>("mem");
 
     Connections::set_sim_clk(&clk);
 
@@ -58,13 +61,55 @@ void Testbench::stimuli() {
         wait(10, SC_NS);
         if (done.read()) {
             std::cout << "[MEM TB] Matchlib AXI Master completed all checks successfully!" << std::endl;
-            std::cout << "[MEM TB] ALL TESTS PASSED." << std::endl;
+            if (check_backdoor()) {
+                std::cout << "[MEM TB] ALL TESTS PASSED." << std::endl;
+            } else {
+                std::cout << "[MEM TB] Backdoor load/dump FAILED." << std::endl;
+            }
             sc_stop();
             return;
         }
     }
 }
 
+// Binary load and dump round trip above the address range used by the Master
+bool Testbench::check_backdoor() {
+    const unsigned int base = 0x200;
+    const int words = 64;
+    const char* load_path = "./out/mem_backdoor_load.bin";
+    const char* dump_path = "./out/mem_backdoor_dump.bin";
+
+    std::vector<uint64_t> pattern(words);
+    {
+        std::ofstream os(load_path, std::ios::binary);
+        for (int i = 0; i < words; ++i) {
+            pattern[i] = 0x0123456789ABCDEFull * (i + 1);
+            for (int b = 0; b < 8; ++b) {
+                os.put((char)((pattern[i] >> (8 * b)) & 0xFF));
+            }
+        }
+    }
+
+    if (mem->load(load_path, base) != words) {
+        std::cout << "[MEM TB] Cannot load " << load_path << std::endl;
+        return false;
+    }
+    for (int i = 0; i < words; ++i) {
+        if (mem->read_word(base + i * 8).to_uint64() != pattern[i]) {
+            std::cout << "[MEM TB] Backdoor word " << i << " mismatch" << std::endl;
+            return false;
+        }
+    }
+
+    if (!mem->dump(dump_path, base, words)) {
+        return false;
+    }
+    std::ifstream a(load_path, std::ios::binary), b(dump_path, std::ios::binary);
+    std::string load_bytes((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+    std::string dump_bytes((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+    return load_bytes == dump_bytes;
+}
+
 int sc_main(int argc, char* argv[]) {
     Testbench tb("tb_memory");
     sc_start();
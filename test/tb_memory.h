@@ -36,7 +36,7 @@ SC_MODULE(Testbench) {
     typename axi4<AxiCfg>::write::template chan<> write_chan;
 
     Master<AxiCfg, MyMasterCfg>* master;
-    Memory<1024, AxiCfg>* mem;
+    Memory<1024, AxiCfg, 8>* mem; // Pipelined reads with 8-cycle latency
 
     sc_trace_file* tf;
 
@@ -44,6 +44,7 @@ SC_MODULE(Testbench) {
     ~Testbench();
 
     void stimuli();
+    bool check_backdoor();
 };
 
 #endif // TB_MEMORY_H
\ No newline at end of file
@@ -0,0 +1,1656 @@
+/*
+ * tb_system.h
+ *
+ * System testbench of the multi-core FFT against matchlib AXI slaves, templated on the
+ * Top configuration (N, cores, HOP, ALU resources) so that one binary can hold several
+ * pre-instantiated configurations. Sample count and job submission mode are run-time
+ * parameters (SystemConfig); datapath type, radix, scaling and output order stay build-wide.
+ */
+
+#ifndef TB_SYSTEM_H
+#define TB_SYSTEM_H
+
+#define CONNECTIONS_NAMING_ORIGINAL
+#define BOOST_NULLPTR nullptr
+
+#include <systemc.h>
+#include <ac_reset_signal_is.h>
+#include <axi/axi4.h>
+#include <mc_scverify.h>
+#include <testbench/nvhls_rand.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <top.h>
+#include <monitor.h>
+#include <filesystem>
+#include <fft_types.h>
+#include <fft_ref.h>
+#include <mapped_file.h>
+#include "wave_tracer.h"
+#include "sample_logger.h"
+#include <rapidjson/document.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+
+#include <axi/testbench/SlaveFromFile.h>
+#include <axi/testbench/Slave.h>
+
+using namespace sc_core;
+using namespace std;
+
+// Build-wide datapath configuration
+#ifndef FFT_RADIX
+#define FFT_RADIX 2
+#endif
+
+// Reorder FFT outputs to natural order before write-back (0: bit-reversed)
+#ifndef FFT_NATURAL_ORDER
+#define FFT_NATURAL_ORDER 0
+#endif
+
+// Butterfly units of the folded FFT core (0: pipelined stage cascade)
+#ifndef FFT_FOLD_BF
+#define FFT_FOLD_BF 0
+#endif
+
+// Samples per AXI beat (> 1: P-parallel FFT, components of dataWidth / (2 * FFT_LANES) bits)
+#ifndef FFT_LANES
+#define FFT_LANES 1
+#endif
+
+// Real-input mode: two real samples per beat, N/2 + 1 bins packed in N/2 beats per frame
+#ifndef FFT_REAL_INPUT
+#define FFT_REAL_INPUT 0
+#endif
+
+// Bit i enables the divide-by-2 scaling of stage i
+#ifndef FFT_SCALE_MASK
+#define FFT_SCALE_MASK 0
+#endif
+
+// Block floating point on the FFT_FIXED_W/FFT_FIXED_I mantissa: frame exponents are applied
+// to the outputs before verification
+#ifndef FFT_BFP
+#define FFT_BFP 0
+#endif
+
+// Minimum SQNR (dB) accepted for the fixed-point datapath
+#ifndef FFT_SQNR_MIN_DB
+#define FFT_SQNR_MIN_DB 40.0
+#endif
+
+typedef axi::cfg::standard AxiCfg;
+
+const int RADIX = FFT_RADIX;
+const unsigned SCALE_MASK = FFT_SCALE_MASK;
+const bool NATURAL_ORDER = FFT_NATURAL_ORDER;
+const int FOLD_BF = FFT_FOLD_BF;
+const int LANES = FFT_LANES;
+const bool REAL_INPUT = FFT_REAL_INPUT;
+const bool BFP = FFT_BFP;
+const int DESC_READ_ID = (1 << AxiCfg::idWidth) - 1; // Reserved by the DMA for descriptor fetches
+
+// Datapath sample type: FFT_FIXED_W total bits with FFT_FIXED_I integer bits
+#ifdef FFT_FIXED_W
+#ifndef FFT_FIXED_I
+#define FFT_FIXED_I 32
+#endif
+#if FFT_BFP
+typedef complex_bfp_t<FFT_FIXED_W, FFT_FIXED_I> sample_t;
+#else
+typedef complex_fixed_t<FFT_FIXED_W, FFT_FIXED_I> sample_t;
+#endif
+const bool FIXED_POINT = true;
+#else
+#if FFT_BFP
+#error "FFT_BFP needs a fixed-point mantissa (FFT_FIXED_W, FFT_FIXED_I)"
+#endif
+typedef complex_t sample_t;
+const bool FIXED_POINT = false;
+#endif
+
+// Datapath transfer type: one sample, or LANES samples per beat
+typedef std::conditional<(LANES > 1), sample_vec_t<sample_t, LANES>, sample_t>::type beat_t;
+typedef BeatPacking<AxiCfg, LANES> Packing;
+const int SAMPLES_PER_BEAT = REAL_INPUT ? 2 : LANES;
+const int SAMPLE_BYTES = AxiCfg::dataWidth / 8 / SAMPLES_PER_BEAT; // Memory footprint of one sample
+
+const sc_time CLK_PERIOD (2.0, SC_NS);
+
+const unsigned int seed = 0;
+
+// Configuration of one simulation run
+struct SystemConfig {
+    // Top template parameters (select the pre-instantiated configuration)
+    int n;
+    int num_cores;
+    int hop;
+    int num_mult;
+    int num_add;
+
+    // Run-time parameters
+    int samples;          // Samples per core
+    int stream_jobs;      // Back-to-back jobs per core in streaming mode (0: single job)
+    int desc_frames;      // Frames per core in one descriptor chain (0: disabled)
+    int sched_jobs;       // Jobs run by the adaptive Top scheduler (0: HOP stagger)
+    int sched_load_limit; // Scheduler bus occupancy limit (0: Top default)
+    double sqnr_min_db;   // Fixed-point acceptance threshold
+    int fft_len;          // Run-time FFT length (0: N); streamed jobs alternate it with N
+    int stft_hop;         // STFT hop in samples, frames split over the cores (0: off)
+    int window;           // WindowRom kind applied to every frame
+    int prune;            // Stages skip butterflies on zero operands
+    int bin_lo;           // Output bins [bin_lo, bin_hi) written back (bin_hi 0: all)
+    int bin_hi;
+    int inverse;          // Inverse transforms (with their 1/N scaling)
+    int partition;        // Simulate every core in its own process (single jobs, descriptor chains)
+
+    TraceOptions trace;   // Waveform format, window and signal subset (TRACE*=...)
+    MonitorOptions monitor;   // AXI transaction monitor mode and filters (MONITOR*=...)
+    std::string monitor_file; // Record mode output ("-": stdout, empty: $SIM_OUT_DIR/monitor.log)
+};
+
+// Set one parameter by its test_configs.json name; returns false for unknown names
+inline bool set_system_param(SystemConfig& cfg, const std::string& key, double value) {
+    int v = (int)value;
+    if (key == "N") cfg.n = v;
+    else if (key == "NUM_CORES") cfg.num_cores = v;
+    else if (key == "HOP") cfg.hop = v;
+    else if (key == "NUM_MULS") cfg.num_mult = v;
+    else if (key == "NUM_ADDS") cfg.num_add = v;
+    else if (key == "SAMPLES") cfg.samples = v;
+    else if (key == "STREAM_JOBS") cfg.stream_jobs = v;
+    else if (key == "DESC_FRAMES") cfg.desc_frames = v;
+    else if (key == "SCHED_JOBS") cfg.sched_jobs = v;
+    else if (key == "SCHED_LOAD_LIMIT") cfg.sched_load_limit = v;
+    else if (key == "SQNR_MIN_DB") cfg.sqnr_min_db = value;
+    else if (key == "FFT_LEN") cfg.fft_len = v;
+    else if (key == "STFT_HOP") cfg.stft_hop = v;
+    else if (key == "WINDOW") cfg.window = v;
+    else if (key == "PRUNE") cfg.prune = v;
+    else if (key == "BIN_LO") cfg.bin_lo = v;
+    else if (key == "BIN_HI") cfg.bin_hi = v;
+    else if (key == "INVERSE") cfg.inverse = v;
+    else if (key == "PARTITION") cfg.partition = v;
+    else return false;
+    return true;
+}
+
+// Parameters fixed at build time (template arguments and sample type shared by all configurations)
+inline bool is_build_param(const std::string& key) {
+    return key == "RADIX" || key == "SCALE_MASK" || key == "NATURAL_ORDER" ||
+           key == "FOLD_BF" || key == "LANES" || key == "REAL_INPUT" || key == "BFP" ||
+           key == "FIXED_W" || key == "FIXED_I";
+}
+
+// Check a build-wide parameter against the values this binary was compiled with
+inline bool build_param_matches(const std::string& key, double value) {
+    if (key == "RADIX") return (int)value == RADIX;
+    if (key == "SCALE_MASK") return (unsigned)value == SCALE_MASK;
+    if (key == "NATURAL_ORDER") return (value != 0) == NATURAL_ORDER;
+    if (key == "FOLD_BF") return (int)value == FOLD_BF;
+    if (key == "LANES") return (int)value == LANES;
+    if (key == "REAL_INPUT") return (value != 0) == REAL_INPUT;
+    if (key == "BFP") return (value != 0) == BFP;
+#ifdef FFT_FIXED_W
+    if (key == "FIXED_W") return (int)value == FFT_FIXED_W;
+    if (key == "FIXED_I") return (int)value == FFT_FIXED_I;
+#else
+    if (key == "FIXED_W" || key == "FIXED_I") return false;
+#endif
+    return true;
+}
+
+// Apply one named parameter, rejecting unknown names and build-wide mismatches
+inline bool apply_system_param(SystemConfig& cfg, const std::string& key, double value) {
+    if (set_system_param(cfg, key, value)) {
+        return true;
+    }
+    if (!is_build_param(key)) {
+        std::cerr << "Error: unknown parameter " << key << std::endl;
+        return false;
+    }
+    if (!build_param_matches(key, value)) {
+        std::cerr << "Error: " << key << "=" << value << " needs a rebuild of this binary" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Bit mask of the entries of a comma-separated list found in names (empty list: all)
+inline bool parse_name_mask(const std::string& list, const std::vector<std::string>& names, uint32_t& mask) {
+    if (list.empty()) {
+        mask = (1u << names.size()) - 1;
+        return true;
+    }
+    mask = 0;
+    std::stringstream ss(list);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        auto it = std::find(names.begin(), names.end(), entry);
+        if (it == names.end()) {
+            return false;
+        }
+        mask |= 1u << (it - names.begin());
+    }
+    return true;
+}
+
+// Apply one MONITOR* argument; returns false if key is not a monitor option or the value
+// is invalid (ok tells the two apart)
+inline bool set_monitor_option(SystemConfig& cfg, const std::string& key, const std::string& value, bool& ok) {
+    MonitorOptions& m = cfg.monitor;
+    ok = true;
+    if (key == "MONITOR") {
+        if (value == "off") m.mode = MON_OFF;
+        else if (value == "summary") m.mode = MON_SUMMARY;
+        else if (value == "record") m.mode = MON_RECORD;
+        else ok = false;
+    } else if (key == "MONITOR_CORES") {
+        m.core_mask = 0;
+        std::stringstream ss(value);
+        std::string entry;
+        while (std::getline(ss, entry, ',')) {
+            m.core_mask |= 1u << std::atoi(entry.c_str());
+        }
+        if (value.empty()) {
+            m.core_mask = ~0u;
+        }
+    } else if (key == "MONITOR_CHANNELS") {
+        ok = parse_name_mask(value, {"ar", "r", "aw", "w", "b"}, m.channel_mask);
+    } else if (key == "MONITOR_ADDR_LO") {
+        m.addr_lo = std::strtoull(value.c_str(), nullptr, 0);
+    } else if (key == "MONITOR_ADDR_HI") {
+        m.addr_hi = std::strtoull(value.c_str(), nullptr, 0);
+    } else if (key == "MONITOR_FILE") {
+        cfg.monitor_file = value;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Apply KEY=VALUE command line overrides (--option value pairs are left to the caller)
+inline bool parse_system_args(int argc, char* argv[], SystemConfig& cfg) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg.rfind("--", 0) == 0) {
+            ++i;
+            continue;
+        }
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "Error: expected KEY=VALUE, got " << arg << std::endl;
+            return false;
+        }
+        std::string key = arg.substr(0, eq);
+        if (set_trace_option(cfg.trace, key, arg.substr(eq + 1))) {
+            if (!valid_trace_format(cfg.trace.format)) {
+                std::cerr << "Error: unsupported TRACE format " << cfg.trace.format << std::endl;
+                return false;
+            }
+            continue;
+        }
+        bool ok;
+        if (set_monitor_option(cfg, key, arg.substr(eq + 1), ok)) {
+            if (!ok) {
+                std::cerr << "Error: invalid " << arg << std::endl;
+                return false;
+            }
+            continue;
+        }
+        if (!apply_system_param(cfg, key, std::atof(arg.c_str() + eq + 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper Functions for DFT Verification
+inline int bit_reverse(int index, int bits) {
+    int rev = 0;
+    for (int i = 0; i < bits; ++i) {
+        if ((index & (1 << i)) != 0) {
+            rev |= (1 << (bits - 1 - i));
+        }
+    }
+    return rev;
+}
+
+// Stimulus file of a core: "%d" in the template is the 1-based core index if that file
+// exists, otherwise the 0-based one
+inline std::string stimulus_filename(const std::string& file_template, int core) {
+    std::string filename = file_template;
+    size_t pos = filename.find("%d");
+    if (pos != std::string::npos) {
+        std::string filename_1 = filename;
+        filename_1.replace(pos, 2, std::to_string(core + 1));
+        std::ifstream f_test(filename_1);
+        if (f_test.good()) {
+            filename = filename_1;
+        } else {
+            filename.replace(pos, 2, std::to_string(core));
+        }
+    }
+    return filename;
+}
+
+// Signal-to-quantization-noise ratio of actual outputs against the reference
+inline double compute_sqnr_db(const std::vector<complex_t>& actual, const std::vector<complex_t>& expected, int len) {
+    double signal_power = 0.0;
+    double noise_power = 0.0;
+    for (int i = 0; i < len; ++i) {
+        double er = actual[i].real - expected[i].real;
+        double ei = actual[i].imag - expected[i].imag;
+        signal_power += expected[i].real * expected[i].real + expected[i].imag * expected[i].imag;
+        noise_power += er * er + ei * ei;
+    }
+    if (noise_power == 0.0) {
+        return INFINITY;
+    }
+    return 10.0 * std::log10(signal_power / noise_power);
+}
+
+// Data flow events of one core (ns; first_read_ns < 0: the core never read a sample)
+struct CoreTiming {
+    double first_read_ns;
+    double last_write_ns;
+    double end_ns;
+    int stall_cycles; // Read starvation and write back-pressure cycles
+};
+
+// PERFORMANCE_RESULT line of a run started at start_ns, with the cycle count up to the last
+// core done and the ideal/overhead split averaged over the cores that ran a job
+inline void print_performance_result(const SystemConfig& cfg, double start_ns, const std::vector<CoreTiming>& cores) {
+    double max_end_time = start_ns;
+    for (const CoreTiming& t : cores) {
+        if (t.end_ns > max_end_time) {
+            max_end_time = t.end_ns;
+        }
+    }
+    double total_cycles = max_end_time - start_ns;
+
+    double avg_overhead_cycles = 0;
+    int active_cores = 0;
+    for (const CoreTiming& t : cores) {
+        if (t.first_read_ns < 0.0) {
+            continue; // Never received a scheduled job
+        }
+        active_cores++;
+        double setup_overhead = t.first_read_ns - start_ns;
+        double tail_overhead = t.end_ns - t.last_write_ns - 1;
+        if (tail_overhead < 0) tail_overhead = 0;
+
+        avg_overhead_cycles += (setup_overhead + t.stall_cycles + tail_overhead);
+    }
+    if (active_cores > 0) {
+        avg_overhead_cycles /= active_cores;
+    }
+    double avg_ideal_cycles = total_cycles - avg_overhead_cycles;
+
+    std::cout << "PERFORMANCE_RESULT: N=" << cfg.n
+              << " CORES=" << cfg.num_cores
+              << " HOP=" << cfg.hop
+              << " MULT=" << cfg.num_mult
+              << " ADD=" << cfg.num_add
+              << " RADIX=" << RADIX
+              << " STREAM_JOBS=" << cfg.stream_jobs
+              << " NATURAL_ORDER=" << NATURAL_ORDER
+              << " FOLD_BF=" << FOLD_BF
+              << " LANES=" << LANES
+              << " REAL_INPUT=" << REAL_INPUT
+              << " BFP=" << BFP
+              << " DESC_FRAMES=" << cfg.desc_frames
+              << " SCHED_JOBS=" << cfg.sched_jobs
+              << " FFT_LEN=" << ((cfg.fft_len > 0) ? cfg.fft_len : cfg.n)
+              << " STFT_HOP=" << cfg.stft_hop
+              << " WINDOW=" << cfg.window
+              << " PRUNE=" << (cfg.prune != 0)
+              << " BIN_LO=" << cfg.bin_lo
+              << " BIN_HI=" << cfg.bin_hi
+              << " INVERSE=" << (cfg.inverse != 0)
+              << " SAMPLES=" << cfg.samples
+              << " START=" << start_ns
+              << " END=" << max_end_time
+              << " CYCLES=" << total_cycles
+              << " IDEAL=" << avg_ideal_cycles
+              << " OVERHEAD=" << avg_overhead_cycles
+              << std::endl;
+}
+
+
+// System testbench for one Top configuration; the run parameters come from a SystemConfig
+template<int N, int NUM_CORES, int HOP, int NUM_MULT, int NUM_ADD>
+SC_MODULE(SystemTestbench) {
+    // Run parameters
+    const SystemConfig run_cfg;
+    const bool partitioned; // This process simulates core core_base of a cfg.num_cores system
+    const int core_base;    // System index of core 0
+    const int samples;
+    const int stream_jobs;
+    const int desc_frames;
+    const int sched_jobs;
+    const double sqnr_min_db;
+    const int fft_len;
+    const int stft_hop;
+    const int window_kind;
+    const bool prune_zeros;
+    const int bin_lo;
+    const int bin_hi;
+    const bool inverse;
+    int selected_count; // Outputs a core writes back for the bin range
+
+    sc_clock clk;
+    sc_signal<bool> rst_n;
+    sc_signal<bool> start_signal;
+    sc_signal<bool> stream_mode;
+    sc_signal<bool> desc_mode;
+    sc_signal<bool> adaptive_mode;
+    sc_signal<int> window_signal;
+    sc_signal<int> stft_hop_signal;
+    sc_signal<sc_uint<AxiCfg::addrWidth>> stft_dst_signal;
+    sc_signal<bool> prune_signal;
+    sc_signal<int> bin_lo_signal;
+    sc_signal<int> bin_hi_signal;
+    sc_signal<bool> inverse_signal;
+
+    // Adaptive scheduler job queue
+    Connections::Combinational<FftJob<AxiCfg>> job_chan;
+    Connections::Out<FftJob<AxiCfg>> job_out;
+    bool sched_go;
+    
+    // Core Configuration Ports
+    sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>> base_addrs;
+    sc_vector<sc_signal<int>> num_samples;
+    sc_vector<sc_signal<int>> fft_lens;
+    
+    // AXI4 Transaction Channels
+    sc_vector<typename axi4<AxiCfg>::read::template chan<>> mem_read_chans;
+    sc_vector<typename axi4<AxiCfg>::write::template chan<>> mem_write_chans;
+
+#ifdef USE_CSV_INIT
+    sc_vector<SlaveFromFile<AxiCfg>> slaves;
+#else
+    sc_vector<Slave<AxiCfg>> slaves;
+#endif
+
+    Top<N, NUM_CORES, HOP, AxiCfg, NUM_MULT, NUM_ADD, RADIX, beat_t, SCALE_MASK,
+        dma_cfg::standard, NATURAL_ORDER, FOLD_BF, REAL_INPUT> fft_sys;
+    typedef DMA<AxiCfg, N, NUM_MULT, NUM_ADD, RADIX, beat_t, dma_cfg::standard, NATURAL_ORDER,
+                FOLD_BF, REAL_INPUT> Dma;
+
+    SampleLogger sample_log;
+    int r_logs[NUM_CORES];
+    int w_logs[NUM_CORES];
+    vector<vector<complex_t>> inputs;
+    vector<vector<complex_t>> outputs;
+    int read_count[NUM_CORES];
+
+    double start_time_ns;
+    double core_end_times_ns[NUM_CORES];
+    bool core_done[NUM_CORES];
+    int write_count[NUM_CORES];
+
+    // Output frames of the block-floating-point datapath with their exponent beats
+    struct BfpFrame {
+        int start; // First output of the frame
+        int end;
+        int exp;
+        bool sat;
+    };
+    vector<vector<BfpFrame>> bfp_frames;
+    int frame_start[NUM_CORES]; // First output not covered by an exponent yet
+    bool exp_pending[NUM_CORES]; // Next W beat is an exponent
+    int exp_addr_errors[NUM_CORES]; // Write bursts on the wrong side of DmaCfg::expBase
+
+    // Jobs of a core in submission order from their first input sample on, with their FFT length
+    struct LenSegment {
+        int start;
+        int len;
+    };
+    vector<vector<LenSegment>> len_segments;
+
+    // Dynamic data flow tracking for exact cycle counts
+    double first_read_times_ns[NUM_CORES];
+    double first_write_times_ns[NUM_CORES];
+    double last_write_times_ns[NUM_CORES];
+    int read_stall_cycles[NUM_CORES];
+    int write_stall_cycles[NUM_CORES];
+
+    SC_HAS_PROCESS(SystemTestbench);
+    SystemTestbench(sc_module_name name, const SystemConfig& cfg, int partition_core = -1)
+        : sc_module(name),
+          run_cfg(cfg),
+          partitioned(partition_core >= 0),
+          core_base(partitioned ? partition_core : 0),
+          samples(cfg.samples),
+          stream_jobs(cfg.stream_jobs),
+          desc_frames(cfg.desc_frames),
+          sched_jobs(cfg.sched_jobs),
+          sqnr_min_db(cfg.sqnr_min_db),
+          fft_len((cfg.fft_len > 0) ? cfg.fft_len : N),
+          stft_hop(cfg.stft_hop),
+          window_kind(cfg.window),
+          prune_zeros(cfg.prune != 0),
+          bin_lo(cfg.bin_lo),
+          bin_hi(cfg.bin_hi),
+          inverse(cfg.inverse != 0),
+          clk("clk", CLK_PERIOD, 0.5, SC_ZERO_TIME, true),
+          rst_n("rst_n"),
+          start_signal("start_signal"),
+          stream_mode("stream_mode"),
+          desc_mode("desc_mode"),
+          adaptive_mode("adaptive_mode"),
+          window_signal("window_signal"),
+          stft_hop_signal("stft_hop_signal"),
+          stft_dst_signal("stft_dst_signal"),
+          prune_signal("prune_signal"),
+          bin_lo_signal("bin_lo_signal"),
+          bin_hi_signal("bin_hi_signal"),
+          inverse_signal("inverse_signal"),
+          job_chan("job_chan"),
+          job_out("job_out"),
+          sched_go(false),
+          base_addrs("base_addrs", NUM_CORES),
+          num_samples("num_samples", NUM_CORES),
+          fft_lens("fft_lens", NUM_CORES),
+          mem_read_chans("mem_read_chans", NUM_CORES),
+          mem_write_chans("mem_write_chans", NUM_CORES),
+#ifdef USE_CSV_INIT
+          slaves("slaves"),
+#else
+          slaves("slaves", NUM_CORES),
+#endif
+          fft_sys("fft_sys") 
+    {
+        Connections::set_sim_clk(&clk);
+
+        fft_sys.clk(clk);
+        fft_sys.rst_n(rst_n);
+        fft_sys.start(start_signal);
+        fft_sys.stream_mode(stream_mode);
+        fft_sys.desc_mode(desc_mode);
+        fft_sys.adaptive_mode(adaptive_mode);
+        fft_sys.window(window_signal);
+        fft_sys.stft_hop(stft_hop_signal);
+        fft_sys.stft_dst(stft_dst_signal);
+        fft_sys.prune_zeros(prune_signal);
+        fft_sys.bin_lo(bin_lo_signal);
+        fft_sys.bin_hi(bin_hi_signal);
+        fft_sys.inverse(inverse_signal);
+        fft_sys.job_in(job_chan);
+        job_out(job_chan);
+        if (cfg.sched_load_limit > 0) {
+            fft_sys.load_limit = cfg.sched_load_limit;
+        }
+        selected_count = (int)selected_outputs(output_len(samples)).size();
+        inputs.assign(NUM_CORES, vector<complex_t>(core_capacity()));
+        outputs.assign(NUM_CORES, vector<complex_t>(std::max(core_capacity(), core_outputs(0))));
+        bfp_frames.assign(NUM_CORES, vector<BfpFrame>());
+        len_segments.assign(NUM_CORES, vector<LenSegment>());
+        if (!Dma::valid_len(fft_len)) {
+            std::cerr << "Error: FFT_LEN=" << fft_len << " is not supported by this datapath" << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "unsupported FFT_LEN", __FILE__, __LINE__);
+        }
+        if (stft_hop < 0 || stft_hop % SAMPLES_PER_BEAT != 0 ||
+            (stft_hop > 0 && (stream_jobs > 0 || desc_frames > 0 || sched_jobs > 0))) {
+            std::cerr << "Error: STFT_HOP needs whole beats and a single job per core" << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "unsupported STFT_HOP", __FILE__, __LINE__);
+        }
+        if (bins_active() && (stream_jobs > 0 || desc_frames > 0 || sched_jobs > 0 || stft_hop > 0 || BFP)) {
+            std::cerr << "Error: BIN_LO/BIN_HI need a single job per core (no STFT, no BFP)" << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "unsupported bin range", __FILE__, __LINE__);
+        }
+        if (inverse && !Dma::INVERSE) {
+            std::cerr << "Error: INVERSE needs the radix-2 stage cascade without BFP" << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "unsupported INVERSE", __FILE__, __LINE__);
+        }
+        if (window_kind < WindowRom::rectangular || window_kind > WindowRom::custom) {
+            std::cerr << "Error: unknown WINDOW=" << window_kind << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "unknown WINDOW", __FILE__, __LINE__);
+        }
+        if (window_kind == WindowRom::custom) {
+            // Custom ROM contents: a triangular (Bartlett) window
+            std::vector<double> coeffs(N);
+            for (int k = 0; k < N; ++k) {
+                coeffs[k] = 1.0 - std::abs(2.0 * k / N - 1.0);
+            }
+            WindowRom::load_custom(N, coeffs);
+        }
+
+        // Determine output directory
+        const char* out_dir_env = std::getenv("SIM_OUT_DIR");
+        std::string out_dir = (out_dir_env != nullptr) ? out_dir_env : "out";
+        
+        // Create output directory and its data subfolder
+        std::filesystem::create_directories(out_dir + "/data");
+
+#ifdef USE_CSV_INIT
+        // Determine filenames for each core
+        const char* stim_file_env = std::getenv("STIMULUS_FILE");
+        std::vector<std::string> filenames(NUM_CORES);
+        
+        if (stim_file_env == nullptr) {
+            std::cerr << "Error: USE_CSV_INIT is defined but STIMULUS_FILE is not set!" << std::endl;
+            sc_report_handler::report(SC_ERROR, "Config error", "STIMULUS_FILE not set", __FILE__, __LINE__);
+        } else {
+            for (int c = 0; c < NUM_CORES; ++c) {
+                filenames[c] = stimulus_filename(stim_file_env, core_base + c);
+            }
+        }
+
+        // Initialize slaves vector using custom filenames
+        slaves.init(NUM_CORES, [&](const char* name, int i) {
+            return new SlaveFromFile<AxiCfg>(name, filenames[i]);
+        });
+#endif
+
+        // Connect Cores, Channels, and Slaves
+        for (int i = 0; i < NUM_CORES; ++i) {
+            fft_sys.mem_read_ports[i](mem_read_chans[i]);
+            fft_sys.mem_write_ports[i](mem_write_chans[i]);
+            fft_sys.base_addrs[i](base_addrs[i]);
+            fft_sys.num_samples[i](num_samples[i]);
+            fft_sys.fft_lens[i](fft_lens[i]);
+            
+            slaves[i].clk(clk);
+            slaves[i].reset_bar(rst_n);
+            slaves[i].if_rd(mem_read_chans[i]);
+            slaves[i].if_wr(mem_write_chans[i]);
+            
+            std::string prefix = out_dir + "/data/core" + std::to_string(core_base + i);
+            r_logs[i] = sample_log.open(prefix + "_input.bin", AxiCfg::dataWidth, LANES);
+            w_logs[i] = sample_log.open(prefix + "_output.bin", AxiCfg::dataWidth, LANES);
+
+            read_count[i] = 0;
+            write_count[i] = 0;
+            frame_start[i] = 0;
+            exp_pending[i] = false;
+            exp_addr_errors[i] = 0;
+            core_done[i] = false;
+            core_end_times_ns[i] = -1.0;
+            first_read_times_ns[i] = -1.0;
+            first_write_times_ns[i] = -1.0;
+            last_write_times_ns[i] = -1.0;
+            read_stall_cycles[i] = 0;
+            write_stall_cycles[i] = 0;
+        }
+        start_time_ns = -1.0;
+        sample_log.start();
+
+        SC_THREAD(run);
+
+        SC_THREAD(job_source);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+        
+        SC_METHOD(monitor_transfers);
+        sensitive << clk.posedge_event();
+    }
+    
+    ~SystemTestbench() {
+        sample_log.close();
+    }
+
+    // Whole-frame length of every adaptive scheduler job, sized so that the jobs carry about
+    // samples per core and each one fits in the initialized memory of any core
+    int sched_job_len() const {
+        int jobs = (sched_jobs > 0) ? sched_jobs : 1;
+        int len = (samples * NUM_CORES / jobs / N) * N;
+        int max_len = (samples / N) * N;
+        if (len > max_len) len = max_len;
+        if (len < N) len = N;
+        return len;
+    }
+
+    // Samples a single core may process (any core can receive every scheduled job)
+    int core_capacity() const {
+        return (sched_jobs > 0) ? sched_jobs * sched_job_len() : samples;
+    }
+
+    // Outputs of in_samples inputs (real input: a frame of N samples returns N/2 beats)
+    static int output_len(int in_samples) {
+        return REAL_INPUT ? in_samples / 2 : in_samples;
+    }
+
+    // Samples of core c's round-robin share of the STFT: from its first frame on, none if
+    // that frame starts past the samples (as assigned by the Top)
+    int stft_samples(int c) const {
+        int left = samples - c * stft_hop;
+        return (c == 0 || left >= fft_len) ? left : 0;
+    }
+
+    // STFT frames of core c, NUM_CORES hops apart
+    int stft_frames(int c) const {
+        int total = stft_samples(c);
+        if (total <= 0) {
+            return 0;
+        }
+        return (total < fft_len) ? 1 : 1 + (total - fft_len) / (NUM_CORES * stft_hop);
+    }
+
+    // Outputs a single job of core c writes
+    int core_outputs(int c) const {
+        if (stft_hop > 0) {
+            return stft_frames(c) * output_len(fft_len);
+        }
+        return bins_active() ? selected_count : output_len(samples);
+    }
+
+    typename Dma::BinRange bins() const {
+        return typename Dma::BinRange{ bin_lo, bin_hi };
+    }
+
+    // Output bin range other than all bins
+    bool bins_active() const {
+        return bin_lo > 0 || bin_hi > 0;
+    }
+
+    // Output indices among the first `outputs` that the DMA writes back for the bin range
+    std::vector<int> selected_outputs(int outputs) const {
+        int frame = output_len(fft_len);
+        std::vector<int> kept;
+        for (int i = 0; i < outputs; ++i) {
+            if (Dma::beat_selected((i % frame) / LANES, fft_len, bins())) {
+                kept.push_back(i);
+            }
+        }
+        return kept;
+    }
+
+    // FFT length of the job that input sample index of core c belongs to
+    int frame_len_at(int c, int index) const {
+        int len = N;
+        for (const LenSegment& seg : len_segments[c]) {
+            if (seg.start <= index) {
+                len = seg.len;
+            }
+        }
+        return len;
+    }
+
+    // Total output scaling applied by the stages selected in SCALE_MASK that a len-point
+    // transform runs through (block floating point: included in the frame exponents)
+    static double output_scale(int len = N) {
+        if (BFP) {
+            return 1.0;
+        }
+        int num_stages = (int)std::log2(N) - (REAL_INPUT ? 1 : 0);
+        int first = (int)std::log2(N / len); // Leading stages bypassed at a shorter length
+        double scale = 1.0;
+        for (int s = first; s < num_stages; ++s) {
+            if ((SCALE_MASK >> s) & 1u) {
+                scale *= 0.5;
+            }
+        }
+        return scale;
+    }
+
+    // Output scaling of a len-point job: 1/len for an inverse transform, whose stages all scale
+    double transform_scale(int len) const {
+        return inverse ? 1.0 / len : output_scale(len);
+    }
+
+    // Trace channel transactions for validation
+    void monitor_transfers() {
+        if (!rst_n.read()) {
+            return;
+        }
+        for (int c = 0; c < NUM_CORES; ++c) {
+            // Track active channel stall cycles only after first read has occurred (active streaming phase)
+            if (first_read_times_ns[c] >= 0.0 && !core_done[c]) {
+                // Count read starvation stalls (FFT wants data but DMA does not supply it)
+                if (!fft_sys.cores[c].dma_to_fft_chan.in_val.read() && fft_sys.cores[c].dma_to_fft_chan.in_rdy.read()) {
+                    read_stall_cycles[c]++;
+                }
+                // Count write backpressure stalls (FFT has output but DMA is not ready)
+                if (fft_sys.cores[c].fft_to_dma_chan.in_val.read() && !fft_sys.cores[c].fft_to_dma_chan.in_rdy.read()) {
+                    write_stall_cycles[c]++;
+                }
+            }
+
+            // Read channel (descriptor fetches are not samples)
+            if (mem_read_chans[c].r.in_val.read() && mem_read_chans[c].r.in_rdy.read() &&
+                mem_read_chans[c].r.in_msg.read().id != DESC_READ_ID) {
+                if (first_read_times_ns[c] < 0.0) {
+                    first_read_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+                }
+                auto r_pay = mem_read_chans[c].r.in_msg.read();
+                sample_log.log(r_logs[c], (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS)), r_pay.data.to_uint64());
+                for (int l = 0; l < LANES && read_count[c] < core_capacity(); ++l) {
+                    complex_t val = Packing::unpack_lane(r_pay.data, l);
+                    if (REAL_INPUT) {
+                        // Two real samples, even one in the real part
+                        inputs[c][read_count[c]++] = complex_t(val.real, 0.0);
+                        inputs[c][read_count[c]++] = complex_t(val.imag, 0.0);
+                    } else {
+                        inputs[c][read_count[c]++] = val;
+                    }
+                }
+            }
+            // Write bursts: a frame's exponent goes to the exponent table, samples below it
+            if (BFP && mem_write_chans[c].aw.in_val.read() && mem_write_chans[c].aw.in_rdy.read()) {
+                bool in_table = mem_write_chans[c].aw.in_msg.read().addr >= (uint64_t)dma_cfg::standard::expBase;
+                if (in_table != exp_pending[c]) {
+                    exp_addr_errors[c]++;
+                }
+            }
+            // Write channel
+            if (mem_write_chans[c].w.in_val.read() && mem_write_chans[c].w.in_rdy.read()) {
+                if (first_write_times_ns[c] < 0.0) {
+                    first_write_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+                }
+                last_write_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+                auto w_pay = mem_write_chans[c].w.in_msg.read();
+                if (exp_pending[c]) {
+                    apply_exponent(c, w_pay.data);
+                } else {
+                    sample_log.log(w_logs[c], (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS)), w_pay.data.to_uint64());
+                    for (int l = 0; l < LANES && write_count[c] < (int)outputs[c].size(); ++l) {
+                        outputs[c][write_count[c]] = Packing::unpack_lane(w_pay.data, l);
+                        write_count[c]++;
+                        bool last = (sched_jobs == 0 && write_count[c] == core_outputs(c));
+                        if (BFP && (write_count[c] - frame_start[c] == frame_len_at(c, frame_start[c]) || last)) {
+                            exp_pending[c] = true; // The frame's exponent follows
+                        } else if (last) {
+                            core_end_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+                            core_done[c] = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Scheduled jobs land on any core: done once all of their outputs are written
+        if (sched_jobs > 0) {
+            int total_writes = 0;
+            for (int c = 0; c < NUM_CORES; ++c) {
+                total_writes += write_count[c];
+            }
+            bool exps_done = true;
+            for (int c = 0; c < NUM_CORES; ++c) {
+                exps_done = exps_done && !exp_pending[c];
+            }
+            if (exps_done && total_writes == sched_jobs * output_len(sched_job_len())) {
+                for (int c = 0; c < NUM_CORES; ++c) {
+                    if (!core_done[c]) {
+                        core_end_times_ns[c] = (last_write_times_ns[c] >= 0.0) ? last_write_times_ns[c] : start_time_ns;
+                        core_done[c] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // Exponent beat of the frame written last: scale its outputs by 2^exp
+    void apply_exponent(int c, const sc_uint<AxiCfg::dataWidth>& word) {
+        BfpFrame f;
+        f.start = frame_start[c];
+        f.end = write_count[c];
+        f.exp = unpack_exponent(word, f.sat);
+        for (int i = f.start; i < f.end; ++i) {
+            outputs[c][i] = complex_t(std::ldexp(outputs[c][i].real, f.exp), std::ldexp(outputs[c][i].imag, f.exp));
+        }
+        bfp_frames[c].push_back(f);
+        frame_start[c] = f.end;
+        exp_pending[c] = false;
+        if (sched_jobs == 0 && write_count[c] == core_outputs(c)) {
+            core_end_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+            core_done[c] = true;
+        }
+    }
+
+    // Feed the adaptive scheduler sched_jobs whole-frame jobs once the run starts
+    void job_source() {
+        job_out.Reset();
+        wait();
+
+        while (!sched_go) {
+            wait();
+        }
+        int len = sched_job_len();
+        int jobs_fit = samples / len;
+        for (int j = 0; j < sched_jobs; ++j) {
+            FftJob<AxiCfg> job;
+            job.addr = (uint64_t)(j % jobs_fit) * len * SAMPLE_BYTES;
+            job.samples = len;
+            job.len = fft_len;
+            job_out.Push(job);
+        }
+        while (true) {
+            wait();
+        }
+    }
+
+    // Initialize memory arrays
+    void init_slave_memories() {
+#ifdef USE_CSV_INIT
+        std::cout << "@" << sc_time_stamp() << " Slave memories were initialized from files using SlaveFromFile." << std::endl;
+#else
+        const int bpb = AxiCfg::dataWidth / 8;
+        const char* stim_bin_env = std::getenv("STIMULUS_BIN");
+        if (stim_bin_env != nullptr) {
+            // Backdoor load of mmap'ed binary stimulus (generate_stimulus.py --format bin)
+            std::cout << "@" << sc_time_stamp() << " Loading Slave memories from binary stimulus files..." << std::endl;
+            for (int c = 0; c < NUM_CORES; ++c) {
+                std::string filename = stimulus_filename(stim_bin_env, core_base + c);
+                MappedFile file(filename);
+                int beats = samples / SAMPLES_PER_BEAT;
+                if (!file.is_open() || file.words(bpb) < (size_t)beats) {
+                    std::cerr << "Error: " << filename << " does not hold " << samples << " samples" << std::endl;
+                    sc_report_handler::report(SC_ERROR, "Config error", "short binary stimulus", __FILE__, __LINE__);
+                    continue;
+                }
+                for (int i = 0; i < beats; ++i) {
+                    slave_write_word(c, (uint64_t)i * bpb, file.word(i, bpb));
+                }
+            }
+            return;
+        }
+
+        std::cout << "@" << sc_time_stamp() << " Initializing Slave memories with random traffic pattern..." << std::endl;
+        boost::random::mt19937 gen(seed);
+        boost::random::uniform_int_distribution<> uniform_rand;
+        for (int g = 0; g < core_base + NUM_CORES; ++g) {
+            int c = g - core_base; // A partition draws the patterns of the cores before its own
+            for (int i = 0; i < samples / SAMPLES_PER_BEAT; ++i) {
+                // 16-bit random real/imag values, LANES samples per word (two real samples
+                // in the real/imag parts with REAL_INPUT)
+                Packing::word_t wr_data = 0;
+                for (int l = 0; l < LANES; ++l) {
+                    uint16_t rand_real = uniform_rand(gen) & 0xFFFF;
+                    uint16_t rand_imag = uniform_rand(gen) & 0xFFFF;
+                    Packing::pack_lane(wr_data, l, Packing::wrap(rand_real), Packing::wrap(rand_imag));
+                }
+                if (c >= 0) {
+                    slave_write_word(c, (uint64_t)i * bpb, wr_data);
+                }
+            }
+        }
+#endif
+    }
+
+    // Backdoor write of one word into the memory model of a slave
+    void slave_write_word(int c, uint64_t byte_addr, sc_uint<AxiCfg::dataWidth> data) {
+        slaves[c].localMem[byte_addr] = data;
+        for (int j = 0; j < (AxiCfg::dataWidth / 8); j++) {
+            slaves[c].localMem_wstrb[byte_addr + j] = nvhls::get_slc<8>(data, 8 * j);
+        }
+        slaves[c].validReadAddresses.push_back(byte_addr);
+    }
+
+    // Byte address of the descriptor chain of every core, past the output region
+    uint64_t desc_base_addr() {
+        return (uint64_t)(2 * samples + 2 * N) * (AxiCfg::dataWidth / 8);
+    }
+
+    // Byte address of the STFT spectrogram of every core, where descriptor chains would go
+    uint64_t stft_dst_addr() {
+        return desc_base_addr();
+    }
+
+    // Chain desc_frames descriptors covering the samples, in the single-job memory layout
+    void init_descriptors() {
+        const int bpb = AxiCfg::dataWidth / 8;
+        int frame_len = (samples / desc_frames / N) * N;
+        for (int c = 0; c < NUM_CORES; ++c) {
+            for (int f = 0; f < desc_frames; ++f) {
+                uint64_t desc_addr = desc_base_addr() + f * 4 * bpb;
+                int len = (f == desc_frames - 1) ? samples - f * frame_len : frame_len;
+                uint64_t src = (uint64_t)f * frame_len * SAMPLE_BYTES;
+                uint64_t next = (f == desc_frames - 1) ? 0 : desc_addr + 4 * bpb;
+                sc_uint<AxiCfg::dataWidth> words[4] = {
+                    src, src + N * SAMPLE_BYTES, ((uint64_t)len << (AxiCfg::dataWidth / 2)) | bpb, next
+                };
+                for (int w = 0; w < 4; ++w) {
+                    slave_write_word(c, desc_addr + w * bpb, words[w]);
+                }
+            }
+        }
+    }
+
+    // Natural-order N-point spectra of real frames as written by the real-input mode:
+    // per frame {(X[0], X[N/2]), X[1], ..., X[N/2-1]}
+    static std::vector<complex_t> pack_real_bins(const std::vector<complex_t>& spectra) {
+        std::vector<complex_t> packed;
+        for (size_t f = 0; f + N <= spectra.size(); f += N) {
+            packed.push_back(complex_t(spectra[f].real, spectra[f + N / 2].real));
+            for (int k = 1; k < N / 2; ++k) {
+                packed.push_back(spectra[f + k]);
+            }
+        }
+        return packed;
+    }
+
+    // The window of the run applied to every len-sample frame of data
+    void apply_window(std::vector<complex_t>& data, int len) const {
+        if (window_kind == WindowRom::rectangular) {
+            return;
+        }
+        const WindowRom& rom = WindowRom::instance(N, window_kind);
+        for (size_t i = 0; i < data.size(); ++i) {
+            double w = rom.coeff((int)(i % len), len);
+            data[i] = complex_t(data[i].real * w, data[i].imag * w);
+        }
+    }
+
+    // Reference spectra of core c's STFT frames from its inputs, which hold every fetched
+    // sample once: frame f starts f hops in, or f frames in for hops longer than a frame
+    // (the samples in between are not read)
+    std::vector<complex_t> stft_reference(int c) const {
+        int step = std::min(NUM_CORES * stft_hop, fft_len);
+        std::vector<complex_t> frames;
+        for (int f = 0; f < stft_frames(c); ++f) {
+            for (int i = f * step; i < f * step + fft_len; ++i) {
+                frames.push_back((i < read_count[c]) ? inputs[c][i] : complex_t(0.0, 0.0));
+            }
+        }
+        apply_window(frames, fft_len);
+        FftReference reference(fft_len);
+        return reference.frames(frames, NATURAL_ORDER || REAL_INPUT, transform_scale(fft_len), inverse);
+    }
+
+    // Reference outputs of core c: the inputs of every job transformed at its FFT length, the
+    // last job zero-padded to whole frames
+    std::vector<complex_t> reference_outputs(int c, int in_len) const {
+        std::vector<complex_t> expected;
+        const std::vector<LenSegment>& segs = len_segments[c];
+        for (size_t s = 0; s < segs.size(); ++s) {
+            int len = segs[s].len;
+            size_t begin = segs[s].start;
+            size_t end = (s + 1 < segs.size()) ? segs[s + 1].start : std::max(inputs[c].size(), (size_t)in_len);
+            std::vector<complex_t> part;
+            for (size_t i = begin; i < end; ++i) {
+                part.push_back((i < inputs[c].size()) ? inputs[c][i] : complex_t(0.0, 0.0));
+            }
+            while (part.size() % len != 0) {
+                part.push_back(complex_t(0.0, 0.0));
+            }
+            apply_window(part, len);
+            FftReference reference(len);
+            std::vector<complex_t> out = reference.frames(part, NATURAL_ORDER || REAL_INPUT, transform_scale(len),
+                                                          inverse);
+            expected.insert(expected.end(), out.begin(), out.end());
+        }
+        return expected;
+    }
+
+    bool verify_slave_memories() {
+        std::cout << "@" << sc_time_stamp() << " Simulation complete. Verifying Slave memory..." << std::endl;
+
+        bool all_pass = true;
+        for (int c = 0; c < NUM_CORES; ++c) {
+            int len = (sched_jobs > 0) ? write_count[c] : core_outputs(c);
+            int full_len = bins_active() ? output_len(samples) : len;
+            int in_len = REAL_INPUT ? 2 * full_len : full_len;
+
+            std::vector<complex_t> expected = (stft_hop > 0) ? stft_reference(c) : reference_outputs(c, in_len);
+            if (REAL_INPUT) {
+                expected = pack_real_bins(expected);
+            }
+            if (bins_active()) {
+                // Only the selected bins are written, in output order
+                std::vector<complex_t> selected;
+                for (int i : selected_outputs(full_len)) {
+                    selected.push_back(expected[i]);
+                }
+                expected = selected;
+            }
+
+            std::vector<complex_t> actual = outputs[c];
+            bool frames_pass = true;
+            if (BFP) {
+                // The stages start scaled and skip zero frames when they adapt, so no frame of
+                // the run may saturate; flagged frames fail the run and stay in the SQNR
+                int saturated = 0, min_exp = 0, max_exp = 0;
+                for (size_t f = 0; f < bfp_frames[c].size(); ++f) {
+                    const BfpFrame& fr = bfp_frames[c][f];
+                    min_exp = (f == 0 || fr.exp < min_exp) ? fr.exp : min_exp;
+                    max_exp = (f == 0 || fr.exp > max_exp) ? fr.exp : max_exp;
+                    if (fr.sat) {
+                        saturated++;
+                    }
+                }
+                std::cout << "BFP_RESULT: CORE=" << core_base + c
+                          << " FRAMES=" << bfp_frames[c].size()
+                          << " SATURATED=" << saturated
+                          << " MIN_EXP=" << min_exp
+                          << " MAX_EXP=" << max_exp
+                          << std::endl;
+                if (frame_start[c] < len) {
+                    std::cout << "Core " << core_base + c << " [OUTPUTS FROM " << frame_start[c]
+                              << " WITHOUT FRAME EXPONENT]" << std::endl;
+                    frames_pass = false;
+                }
+                if (saturated > 0) {
+                    std::cout << "Core " << core_base + c << " [" << saturated << " SATURATED FRAMES]" << std::endl;
+                    frames_pass = false;
+                }
+                if (exp_addr_errors[c] > 0) {
+                    std::cout << "Core " << core_base + c << " [" << exp_addr_errors[c]
+                              << " WRITE BURSTS MISPLACED AROUND THE EXPONENT TABLE]" << std::endl;
+                    frames_pass = false;
+                }
+                all_pass = all_pass && frames_pass;
+            }
+            if ((prune_zeros && Dma::PRUNE_ZEROS) || (bins_active() && Dma::PRUNE_BINS)) {
+                // Zero operands depend on the stimulus, but a bin range always leaves whole
+                // blocks of the last stages unselected
+                unsigned long pruned = fft_sys.cores[c].pruned_butterflies();
+                std::cout << "PRUNE_RESULT: CORE=" << core_base + c
+                          << " PRUNED_BUTTERFLIES=" << pruned
+                          << std::endl;
+                if (bins_active() && Dma::PRUNE_BINS && pruned == 0) {
+                    std::cout << "Core " << core_base + c << " [NO BUTTERFLY PRUNED FOR THE BIN RANGE]" << std::endl;
+                    frames_pass = false;
+                    all_pass = false;
+                }
+            }
+
+            double sqnr_db = compute_sqnr_db(actual, expected, len);
+            std::cout << "SQNR_RESULT: CORE=" << core_base + c << " SQNR_DB=" << sqnr_db << std::endl;
+            if (FIXED_POINT) {
+                // Bit-accurate datapath is checked against the SQNR budget instead of exact rounding
+                if (sqnr_db < sqnr_min_db) {
+                    std::cout << "Core " << core_base + c << " [SQNR BELOW " << sqnr_min_db << " dB]" << std::endl;
+                    all_pass = false;
+                } else if (frames_pass) {
+                    std::cout << "Core " << core_base + c << " [OK]" << std::endl;
+                }
+                continue;
+            }
+
+            for (int i = 0; i < len; ++i) {
+                complex_t actual = outputs[c][i];
+                complex_t exp = expected[i];
+                
+                double diff_real = std::abs(actual.real - std::round(exp.real));
+                double diff_imag = std::abs(actual.imag - std::round(exp.imag));
+                bool match = (diff_real < 1e-2) && (diff_imag < 1e-2);
+                
+                if (match) {
+                    continue;
+                } else {
+                    std::cout << "Core " << core_base + c << " index " << i << " [MISMATCH] Expected: (" 
+                              << exp.real << ", " << exp.imag << "), Actual: (" 
+                              << actual.real << ", " << actual.imag << ")" << std::endl;
+                    all_pass = false;
+                    break;
+                }
+            }
+            if (all_pass) std::cout << "Core " << core_base + c << " [OK]" << std::endl;
+        }
+
+        if (all_pass) {
+            std::cout << "Verification Successful!" << std::endl;
+        } else {
+            std::cout << "Verification Failed!" << std::endl;
+        }
+        return all_pass;
+    }
+
+    // A partition starts its core when the Top stagger of the whole system would: core_base
+    // hops after the start
+    void wait_stagger() {
+        if (partitioned && core_base * HOP > 0) {
+            wait(core_base * HOP * CLK_PERIOD);
+        }
+    }
+
+    void run() {
+        rst_n.write(false);
+        start_signal.write(false);
+        stream_mode.write(stream_jobs > 0);
+        desc_mode.write(desc_frames > 0 && sched_jobs == 0);
+        adaptive_mode.write(sched_jobs > 0);
+        window_signal.write(window_kind);
+        stft_hop_signal.write(stft_hop);
+        stft_dst_signal.write(stft_dst_addr());
+        prune_signal.write(prune_zeros);
+        bin_lo_signal.write(bin_lo);
+        bin_hi_signal.write(bin_hi);
+        inverse_signal.write(inverse);
+        for (int i = 0; i < NUM_CORES; ++i) {
+            base_addrs[i].write(0);
+            num_samples[i].write(0);
+            fft_lens[i].write(fft_len);
+            if (stream_jobs == 0) {
+                len_segments[i].push_back({0, fft_len});
+            }
+        }
+        wait(5, SC_NS);
+
+        rst_n.write(true);
+        wait(5, SC_NS);
+        
+        init_slave_memories();
+        if (desc_frames > 0) {
+            init_descriptors();
+        }
+        wait(5, SC_NS);
+
+        std::cout << "@" << sc_time_stamp() << " Starting FFT system..." << std::endl;
+        start_time_ns = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
+        if (sched_jobs > 0) {
+            // Adaptive scheduling: the Top launches queued jobs as cores and bus free up
+            sched_go = true;
+        } else if (desc_frames > 0) {
+            // Scatter-gather: a single start walks every core's descriptor chain
+            for (int c = 0; c < NUM_CORES; ++c) {
+                base_addrs[c].write(desc_base_addr());
+            }
+            wait_stagger();
+            start_signal.write(true);
+            wait(1, SC_NS);
+            start_signal.write(false);
+        } else if (stream_jobs > 0) {
+            // Continuous streaming: submit the samples as back-to-back jobs of whole frames,
+            // alternating between FFT_LEN and N point transforms
+            int job_len = (samples / stream_jobs / N) * N;
+            for (int j = 0; j < stream_jobs; ++j) {
+                // Keep at most jobQueueDepth jobs waiting in each DMA
+                bool has_room = false;
+                while (!has_room) {
+                    has_room = true;
+                    for (int c = 0; c < NUM_CORES; ++c) {
+                        if (read_count[c] < (j - (int)dma_cfg::standard::jobQueueDepth) * job_len + 1) {
+                            has_room = false;
+                        }
+                    }
+                    if (!has_room) {
+                        wait(CLK_PERIOD);
+                    }
+                }
+                int len = (j == stream_jobs - 1) ? samples - j * job_len : job_len;
+                int points = (j % 2 == 0) ? fft_len : N;
+                for (int c = 0; c < NUM_CORES; ++c) {
+                    base_addrs[c].write(j * job_len * SAMPLE_BYTES);
+                    num_samples[c].write(len);
+                    fft_lens[c].write(points);
+                    len_segments[c].push_back({j * job_len, points});
+                }
+                start_signal.write(true);
+                wait(1, SC_NS);
+                start_signal.write(false);
+                // Let the stagger sequence pick up this job on every core
+                wait((NUM_CORES * HOP + 4) * CLK_PERIOD);
+            }
+        } else {
+            // One job per core; with STFT_HOP the Top splits the frames of core 0's job
+            for (int c = 0; c < NUM_CORES; ++c) {
+                base_addrs[c].write(0);
+                num_samples[c].write(samples);
+                if (core_outputs(c) == 0) {
+                    core_done[c] = true;
+                    core_end_times_ns[c] = start_time_ns;
+                }
+            }
+            wait_stagger();
+            start_signal.write(true);
+            wait(1, SC_NS);
+            start_signal.write(false);
+        }
+
+        // Dynamically wait until all cores have written all their samples
+        bool all_done = false;
+        int timeout_cycles = (int)outputs[0].size() * 100;
+        int elapsed_cycles = 0;
+        while (!all_done && elapsed_cycles < timeout_cycles) {
+            wait(1, SC_NS);
+            elapsed_cycles++;
+            all_done = true;
+            for (int i = 0; i < NUM_CORES; ++i) {
+                if (!core_done[i]) {
+                    all_done = false;
+                }
+            }
+        }
+
+        // Print performance result to stdout (a partition reports its core to the parent)
+        std::vector<CoreTiming> timings;
+        for (int c = 0; c < NUM_CORES; ++c) {
+            timings.push_back({ first_read_times_ns[c], last_write_times_ns[c], core_end_times_ns[c],
+                                read_stall_cycles[c] + write_stall_cycles[c] });
+        }
+
+#ifdef FFT_FIXED_W
+        // Storage and multiplier sizing of the bit-accurate datapath
+#if FFT_BFP
+        const int sample_bits = 2 * FFT_FIXED_W + sample_t::exp_width + 1; // Exponent and flag travel along
+#else
+        const int sample_bits = 2 * FFT_FIXED_W;
+#endif
+        std::cout << "DATAPATH_RESULT: W=" << FFT_FIXED_W
+                  << " I=" << FFT_FIXED_I
+                  << " BFP=" << BFP
+                  << " DELAY_LINE_BITS=" << sample_bits * (N - 1)
+                  << " MULT_WIDTH=" << FFT_FIXED_W << "x" << FFT_FIXED_W
+                  << std::endl;
+#endif
+
+        if (partitioned) {
+            // Full precision: the parent recomputes the cycle counts from these times
+            const CoreTiming& t = timings[0];
+            std::ostringstream line;
+            line << std::setprecision(17)
+                 << "PARTITION_RESULT: CORE=" << core_base
+                 << " START=" << start_time_ns
+                 << " FIRST_READ=" << t.first_read_ns
+                 << " LAST_WRITE=" << t.last_write_ns
+                 << " END=" << t.end_ns
+                 << " STALLS=" << t.stall_cycles;
+            std::cout << line.str() << std::endl;
+        } else {
+            print_performance_result(run_cfg, start_time_ns, timings);
+        }
+
+        if (stft_hop > 0) {
+            // Samples read over AXI against samples transformed (overlap reuse)
+            for (int c = 0; c < NUM_CORES; ++c) {
+                int transformed = stft_frames(c) * fft_len;
+                std::cout << "STFT_RESULT: CORE=" << c
+                          << " FRAMES=" << stft_frames(c)
+                          << " SAMPLES_READ=" << read_count[c]
+                          << " SAMPLES_TRANSFORMED=" << transformed
+                          << " READ_REDUCTION=" << ((read_count[c] > 0) ? (double)transformed / read_count[c] : 0.0)
+                          << std::endl;
+            }
+        }
+
+        if (sched_jobs > 0) {
+            for (int c = 0; c < NUM_CORES; ++c) {
+                std::cout << "SCHED_RESULT: CORE=" << c
+                          << " JOBS=" << fft_sys.core_launches[c]
+                          << " SAMPLES=" << write_count[c]
+                          << std::endl;
+            }
+        }
+
+        write_perf_report();
+
+        bool all_pass = verify_slave_memories();
+        if (!all_pass) {
+            sc_report_handler::report(SC_ERROR, "Verification failed", "Some outputs mismatch", __FILE__, __LINE__);
+        }
+        sc_stop();
+    }
+
+    // Dump the built-in counters of every core to perf_counters.json and print each core's
+    // utilization and busiest block
+    void write_perf_report() {
+        const char* out_dir_env = std::getenv("SIM_OUT_DIR");
+        std::string out_dir = (out_dir_env != nullptr) ? out_dir_env : "out";
+        std::ofstream ofs(out_dir + "/perf_counters.json");
+        rapidjson::OStreamWrapper osw(ofs);
+        rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(osw);
+        writer.StartObject();
+        writer.Key("cycle_ns"); writer.Double(CLK_PERIOD.to_seconds() * 1e9);
+        writer.Key("cores"); fft_sys.write_perf_json(writer);
+        writer.EndObject();
+        ofs << std::endl;
+
+        for (int c = 0; c < NUM_CORES; ++c) {
+            const auto& core = fft_sys.cores[c];
+            NamedCounters b = core.bottleneck();
+            std::cout << "STALL_RESULT: CORE=" << core_base + c
+                      << " UTIL=" << core.dma.perf.utilization()
+                      << " BOTTLENECK=" << b.name
+                      << " BOTTLENECK_UTIL=" << b.perf->utilization()
+                      << " READ_WAIT=" << core.dma.perf.read_wait_cycles
+                      << " FFT_WAIT=" << core.dma.perf.fft_wait_cycles
+                      << " R_LATENCY=" << core.dma.perf.read.latency.mean()
+                      << std::endl;
+        }
+    }
+};
+
+// Elaborate and simulate one configuration, or core partition_core of it alone (on a
+// one-core Top); returns non-zero on failure
+template<int N, int NUM_CORES, int HOP, int NUM_MULT, int NUM_ADD>
+int simulate_system(const SystemConfig& cfg, int partition_core) {
+    SystemTestbench<N, NUM_CORES, HOP, NUM_MULT, NUM_ADD> tb("tb", cfg, partition_core);
+
+    // Waveform tracing (TRACE=none elaborates no tracer)
+    const char* out_dir_env = std::getenv("SIM_OUT_DIR");
+    std::string out_dir = (out_dir_env != nullptr) ? out_dir_env : "out";
+    std::unique_ptr<WaveTracer> tracer;
+    if (cfg.trace.format != "none") {
+        tracer.reset(new WaveTracer("tracer", tb.clk, cfg.trace, out_dir + "/trace"));
+        WaveTracer& tr = *tracer;
+        tr.add("control", -1, "Control.rst_n", tb.rst_n);
+        tr.add("control", -1, "Control.start_signal", tb.start_signal);
+
+        tr.add("stagger", -1, "Stagger.active", tb.fft_sys.active_stagger);
+        tr.add("stagger", -1, "Stagger.counter", tb.fft_sys.stagger_counter);
+
+        for (int i = 0; i < NUM_CORES; ++i) {
+            std::string core_prefix = "Core" + std::to_string(i) + ".";
+            tr.add("control", i, core_prefix + "base_addr", tb.base_addrs[i]);
+            tr.add("control", i, core_prefix + "num_samples", tb.num_samples[i]);
+            tr.add("control", i, core_prefix + "fft_len", tb.fft_lens[i]);
+            tr.add("control", i, core_prefix + "start", tb.fft_sys.core_starts[i]);
+            tr.add("control", i, core_prefix + "busy", tb.fft_sys.core_busy[i]);
+
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_val", tb.mem_read_chans[i].ar.in_val);
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_rdy", tb.mem_read_chans[i].ar.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_msg", tb.mem_read_chans[i].ar.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_R.r_val", tb.mem_read_chans[i].r.in_val);
+            tr.add("axi", i, core_prefix + "AXI_R.r_rdy", tb.mem_read_chans[i].r.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_R.r_msg", tb.mem_read_chans[i].r.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_val", tb.mem_write_chans[i].aw.in_val);
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_rdy", tb.mem_write_chans[i].aw.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_msg", tb.mem_write_chans[i].aw.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_W.w_val", tb.mem_write_chans[i].w.in_val);
+            tr.add("axi", i, core_prefix + "AXI_W.w_rdy", tb.mem_write_chans[i].w.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_W.w_msg", tb.mem_write_chans[i].w.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_B.b_val", tb.mem_write_chans[i].b.in_val);
+            tr.add("axi", i, core_prefix + "AXI_B.b_rdy", tb.mem_write_chans[i].b.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_B.b_msg", tb.mem_write_chans[i].b.in_msg);
+
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_val", tb.fft_sys.cores[i].dma_to_fft_chan.in_val);
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_rdy", tb.fft_sys.cores[i].dma_to_fft_chan.in_rdy);
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_msg", tb.fft_sys.cores[i].dma_to_fft_chan.in_msg);
+
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_val", tb.fft_sys.cores[i].fft_to_dma_chan.in_val);
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_rdy", tb.fft_sys.cores[i].fft_to_dma_chan.in_rdy);
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_msg", tb.fft_sys.cores[i].fft_to_dma_chan.in_msg);
+
+            // AR and AW handshakes define the transaction window
+            tr.add_transaction(tb.mem_read_chans[i].ar.in_val, tb.mem_read_chans[i].ar.in_rdy, i);
+            tr.add_transaction(tb.mem_write_chans[i].aw.in_val, tb.mem_write_chans[i].aw.in_rdy, i);
+        }
+    }
+
+    // Transaction monitor (MONITOR=off elaborates no monitor)
+    typedef Monitor<NUM_CORES, AxiCfg> SystemMonitor;
+    std::unique_ptr<SystemMonitor> monitor;
+    std::ofstream monitor_log;
+    if (cfg.monitor.mode != MON_OFF) {
+        monitor.reset(new SystemMonitor("monitor", tb.mem_read_chans, tb.mem_write_chans, cfg.monitor));
+        monitor->clk(tb.clk);
+        monitor->rst_n(tb.rst_n);
+        if (cfg.monitor_file == "-") {
+            monitor->start(std::cout);
+        } else {
+            monitor_log.open(cfg.monitor_file.empty() ? out_dir + "/monitor.log" : cfg.monitor_file);
+            monitor->start(monitor_log);
+        }
+    }
+
+    sc_report_handler::set_actions(SC_ERROR, SC_DISPLAY);
+
+    sc_start();
+
+    // Flush and close the trace file
+    tracer.reset();
+    if (monitor) {
+        monitor->close();
+        monitor->report();
+    }
+
+    bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
+    if (rc) 
+        DCOUT("TESTBENCH FAIL" << endl);
+    else 
+        DCOUT("TESTBENCH PASS" << endl);
+    return rc;
+}
+
+// Output directory of the partition simulating core c
+inline std::string partition_dir(const std::string& out_dir, int c) {
+    return out_dir + "/partition" + std::to_string(c);
+}
+
+// Partitioned simulation: the cores share nothing but the clock and the staggered start, so
+// every core runs with its slave in a child process of its own, its start delayed by its
+// stagger offset, on as many processes at a time as the host has CPUs. The parent merges
+// the logs, sample files and counters of the partitions in core order and reports the
+// cycles of the whole system from their data flow events.
+template<int N, int NUM_CORES, int HOP, int NUM_MULT, int NUM_ADD>
+int run_partitioned(const SystemConfig& cfg) {
+    const char* out_dir_env = std::getenv("SIM_OUT_DIR");
+    std::string out_dir = (out_dir_env != nullptr) ? out_dir_env : "out";
+    std::filesystem::create_directories(out_dir + "/data");
+    int workers = std::max(1, std::min(NUM_CORES, (int)std::thread::hardware_concurrency()));
+    std::cout << "@" << sc_time_stamp() << " Simulating " << NUM_CORES << " cores as partitions on " << workers
+              << " processes..." << std::endl;
+
+    int failures = 0;
+    int running = 0;
+    int next = 0;
+    while (next < NUM_CORES || running > 0) {
+        if (next < NUM_CORES && running < workers) {
+            int c = next++;
+            std::string dir = partition_dir(out_dir, c);
+            std::filesystem::create_directories(dir);
+            std::cout.flush();
+            pid_t pid = fork();
+            if (pid == 0) {
+                setenv("SIM_OUT_DIR", dir.c_str(), 1);
+                if (std::freopen((dir + "/sim_log.txt").c_str(), "w", stdout) == nullptr) {
+                    std::_Exit(1);
+                }
+                std::exit(simulate_system<N, 1, HOP, NUM_MULT, NUM_ADD>(cfg, c));
+            }
+            if (pid < 0) {
+                std::cerr << "Error: cannot fork the partition of core " << c << std::endl;
+                failures++;
+            } else {
+                running++;
+            }
+            continue;
+        }
+        int status = 0;
+        if (wait(&status) < 0) {
+            break;
+        }
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failures++;
+        }
+    }
+
+    // Logs and data flow events in core order, sample files under the usual names
+    double start_ns = 0.0;
+    std::vector<CoreTiming> timings(NUM_CORES, CoreTiming{ -1.0, -1.0, -1.0, 0 });
+    int reported = 0;
+    for (int c = 0; c < NUM_CORES; ++c) {
+        std::string dir = partition_dir(out_dir, c);
+        std::ifstream log(dir + "/sim_log.txt");
+        std::string line;
+        while (std::getline(log, line)) {
+            std::cout << line << std::endl;
+            int core = 0;
+            CoreTiming t;
+            if (std::sscanf(line.c_str(), "PARTITION_RESULT: CORE=%d START=%lf FIRST_READ=%lf LAST_WRITE=%lf END=%lf STALLS=%d",
+                            &core, &start_ns, &t.first_read_ns, &t.last_write_ns, &t.end_ns, &t.stall_cycles) == 6 &&
+                core == c) {
+                timings[c] = t;
+                reported++;
+            }
+        }
+        for (const char* kind : { "_input.bin", "_output.bin" }) {
+            std::string file = "/data/core" + std::to_string(c) + kind;
+            std::error_code ec;
+            std::filesystem::rename(dir + file, out_dir + file, ec);
+        }
+    }
+
+    // Counters of every partition's core, named by its system index
+    rapidjson::Document merged;
+    merged.SetObject();
+    rapidjson::Value cores(rapidjson::kArrayType);
+    for (int c = 0; c < NUM_CORES; ++c) {
+        std::ifstream ifs(partition_dir(out_dir, c) + "/perf_counters.json");
+        rapidjson::IStreamWrapper isw(ifs);
+        rapidjson::Document doc;
+        doc.ParseStream(isw);
+        if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("cores") || !doc["cores"].IsArray()) {
+            continue;
+        }
+        if (!merged.HasMember("cycle_ns")) {
+            merged.AddMember("cycle_ns", rapidjson::Value(doc["cycle_ns"], merged.GetAllocator()), merged.GetAllocator());
+        }
+        for (auto& core : doc["cores"].GetArray()) {
+            rapidjson::Value copy(core, merged.GetAllocator());
+            std::string name = "core_" + std::to_string(c);
+            if (copy.HasMember("name")) {
+                copy["name"].SetString(name.c_str(), (rapidjson::SizeType)name.size(), merged.GetAllocator());
+            }
+            cores.PushBack(copy, merged.GetAllocator());
+        }
+    }
+    merged.AddMember("cores", cores, merged.GetAllocator());
+    std::ofstream ofs(out_dir + "/perf_counters.json");
+    rapidjson::OStreamWrapper osw(ofs);
+    rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(osw);
+    merged.Accept(writer);
+    ofs << std::endl;
+
+    if (reported == NUM_CORES) {
+        print_performance_result(cfg, start_ns, timings);
+    } else {
+        failures++;
+    }
+
+    bool rc = (failures > 0);
+    if (rc)
+        DCOUT("TESTBENCH FAIL" << endl);
+    else
+        DCOUT("TESTBENCH PASS" << endl);
+    return rc;
+}
+
+// Simulate one configuration, partitioned if cfg.partition asks for it and the cores run
+// independent jobs; returns non-zero on failure
+template<int N, int NUM_CORES, int HOP, int NUM_MULT, int NUM_ADD>
+int run_system(const SystemConfig& cfg) {
+    if constexpr (NUM_CORES > 1) {
+        if (cfg.partition != 0) {
+            if (cfg.stream_jobs == 0 && cfg.sched_jobs == 0 && cfg.stft_hop == 0) {
+                return run_partitioned<N, NUM_CORES, HOP, NUM_MULT, NUM_ADD>(cfg);
+            }
+            std::cout << "PARTITION needs a single job or descriptor chain per core, "
+                      << "simulating all cores in one kernel" << std::endl;
+        }
+    }
+    return simulate_system<N, NUM_CORES, HOP, NUM_MULT, NUM_ADD>(cfg, -1);
+}
+#endif // TB_SYSTEM_H
@@ -0,0 +1,234 @@
+#include "tb_system.h"
+
+#include <rapidjson/document.h>
+#include <rapidjson/istreamwrapper.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Single system testbench binary holding a table of pre-instantiated Top configurations.
+// Usage:
+//   tb_system_multi N=16 NUM_CORES=2 HOP=4 SAMPLES=256 [STREAM_JOBS=.. ...]
+//   tb_system_multi --config test_configs.json --case test_n16_random [KEY=VALUE ...]
+//   tb_system_multi --config test_configs.json   (every case, one child process each)
+
+typedef int (*SystemRunner)(const SystemConfig&);
+
+struct SystemEntry {
+    int n;
+    int num_cores;
+    int hop;
+    int num_mult;
+    int num_add;
+    SystemRunner run;
+};
+
+// Runner of one configuration; none for frames shorter than a beat (LANES, REAL_INPUT builds)
+template<int N, int C, int H, int M, int A>
+constexpr SystemRunner system_runner() {
+    if constexpr (N >= SAMPLES_PER_BEAT) {
+        return &run_system<N, C, H, M, A>;
+    } else {
+        return nullptr;
+    }
+}
+
+#define SYSTEM_ENTRY(N, C, H, M, A) { N, C, H, M, A, system_runner<N, C, H, M, A>() }
+
+// test_configs.json cases, the default tb_system configuration and the
+// sweep_performance.py matrix (single core, HOP 1). Cases with build-wide parameters
+// (e.g. test_n1024_radix4) run on the same rows of a binary built for them
+// (EXTRA_CXXFLAGS=-DFFT_RADIX=4).
+static const SystemEntry system_table[] = {
+    SYSTEM_ENTRY(1, 2, 1, 4, 6),
+    SYSTEM_ENTRY(2, 4, 1, 4, 6),
+    SYSTEM_ENTRY(4, 3, 2, 4, 6),
+    SYSTEM_ENTRY(8, 1, 1, 4, 6),
+    SYSTEM_ENTRY(8, 2, 1, 4, 6),
+    SYSTEM_ENTRY(8, 6, 1, 4, 6),
+    SYSTEM_ENTRY(16, 2, 1, 4, 6),
+    SYSTEM_ENTRY(16, 2, 4, 4, 6),
+    SYSTEM_ENTRY(64, 2, 1, 4, 6),
+    SYSTEM_ENTRY(64, 2, 1, 1, 1),
+    SYSTEM_ENTRY(1024, 2, 1, 4, 6),
+
+    SYSTEM_ENTRY(4, 1, 1, 1, 1),
+    SYSTEM_ENTRY(4, 1, 1, 2, 2),
+    SYSTEM_ENTRY(4, 1, 1, 4, 4),
+    SYSTEM_ENTRY(4, 1, 1, 4, 6),
+    SYSTEM_ENTRY(8, 1, 1, 1, 1),
+    SYSTEM_ENTRY(8, 1, 1, 2, 2),
+    SYSTEM_ENTRY(8, 1, 1, 4, 4),
+    SYSTEM_ENTRY(16, 1, 1, 1, 1),
+    SYSTEM_ENTRY(16, 1, 1, 2, 2),
+    SYSTEM_ENTRY(16, 1, 1, 4, 4),
+    SYSTEM_ENTRY(16, 1, 1, 4, 6),
+    SYSTEM_ENTRY(256, 1, 1, 1, 1),
+    SYSTEM_ENTRY(256, 1, 1, 2, 2),
+    SYSTEM_ENTRY(256, 1, 1, 4, 4),
+    SYSTEM_ENTRY(256, 1, 1, 4, 6),
+    SYSTEM_ENTRY(1024, 1, 1, 1, 1),
+    SYSTEM_ENTRY(1024, 1, 1, 2, 2),
+    SYSTEM_ENTRY(1024, 1, 1, 4, 4),
+    SYSTEM_ENTRY(1024, 1, 1, 4, 6),
+    SYSTEM_ENTRY(2048, 1, 1, 1, 1),
+    SYSTEM_ENTRY(2048, 1, 1, 2, 2),
+    SYSTEM_ENTRY(2048, 1, 1, 4, 4),
+    SYSTEM_ENTRY(2048, 1, 1, 4, 6),
+};
+
+static const SystemEntry* find_system(const SystemConfig& cfg) {
+    for (const SystemEntry& e : system_table) {
+        if (e.run != nullptr && e.n == cfg.n && e.num_cores == cfg.num_cores && e.hop == cfg.hop &&
+            e.num_mult == cfg.num_mult && e.num_add == cfg.num_add) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+static int dispatch(const SystemConfig& cfg) {
+    const SystemEntry* entry = find_system(cfg);
+    if (entry == nullptr) {
+        std::cerr << "Error: no pre-instantiated configuration N=" << cfg.n
+                  << " NUM_CORES=" << cfg.num_cores << " HOP=" << cfg.hop
+                  << " NUM_MULS=" << cfg.num_mult << " NUM_ADDS=" << cfg.num_add
+                  << ", add it to system_table or build tb_system for it" << std::endl;
+        return 1;
+    }
+    return entry->run(cfg);
+}
+
+// Apply the params object of one test_configs.json case
+static bool apply_case_params(const rapidjson::Value& params, SystemConfig& cfg) {
+    for (auto it = params.MemberBegin(); it != params.MemberEnd(); ++it) {
+        std::string key = it->name.GetString();
+        if (key == "use_file_stim" || key == "fs") {
+            continue; // Stimulus options of the Python runner
+        }
+        double value = it->value.IsBool() ? (it->value.GetBool() ? 1.0 : 0.0) : it->value.GetDouble();
+        if (!apply_system_param(cfg, key, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// First build-wide parameter of a case that this binary was compiled with another value of
+// (empty: the case runs here)
+static std::string rebuild_param(const rapidjson::Value& params) {
+    for (auto it = params.MemberBegin(); it != params.MemberEnd(); ++it) {
+        std::string key = it->name.GetString();
+        if (!is_build_param(key)) {
+            continue;
+        }
+        double value = it->value.IsBool() ? (it->value.GetBool() ? 1.0 : 0.0) : it->value.GetDouble();
+        if (!build_param_matches(key, value)) {
+            return key;
+        }
+    }
+    return "";
+}
+
+static std::string option_value(int argc, char* argv[], const std::string& option) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (option == argv[i]) {
+            return argv[i + 1];
+        }
+    }
+    return "";
+}
+
+int sc_main(int argc, char *argv[]) {
+    sc_report_handler::set_actions( "/IEEE_Std_1666/deprecated", SC_DO_NOTHING );
+    sc_set_default_time_unit(1.0, SC_NS);
+
+    nvhls::set_random_seed();
+
+    SystemConfig defaults = { 8, 2, 1, 4, 6, 256, 0, 0, 0, 0, FFT_SQNR_MIN_DB, 0, 0, 0, 0, 0, 0, 0, 0 };
+    std::string config_file = option_value(argc, argv, "--config");
+    std::string case_name = option_value(argc, argv, "--case");
+
+    if (config_file.empty()) {
+        SystemConfig cfg = defaults;
+        if (!parse_system_args(argc, argv, cfg)) {
+            return 1;
+        }
+        return dispatch(cfg);
+    }
+
+    std::ifstream ifs(config_file);
+    rapidjson::IStreamWrapper isw(ifs);
+    rapidjson::Document doc;
+    doc.ParseStream(isw);
+    if (!ifs.good() || doc.HasParseError() || !doc.IsArray()) {
+        std::cerr << "Error: cannot read test configurations from " << config_file << std::endl;
+        return 1;
+    }
+
+    // Every case runs in its own child process: a SystemC kernel elaborates only once
+    int failures = 0;
+    int runs = 0;
+    int skipped = 0;
+    for (auto& entry : doc.GetArray()) {
+        std::string name = entry["case"].GetString();
+        if (!case_name.empty() && name != case_name) {
+            continue;
+        }
+        // Cores sharing a BankedMemory only run on tb_system_wmem
+        if (entry["params"].HasMember("SHARED_BANKS")) {
+            std::cout << "[ SKIPPED ] " << name << " (SHARED_BANKS runs on tb_system_wmem)" << std::endl;
+            if (!case_name.empty()) {
+                return 1;
+            }
+            skipped++;
+            continue;
+        }
+        // Cases of another datapath build (RADIX, BFP, ...) are left to a binary built for them
+        std::string rebuild = rebuild_param(entry["params"]);
+        if (!rebuild.empty()) {
+            std::cout << "[ SKIPPED ] " << name << " (" << rebuild << " needs a rebuild)" << std::endl;
+            if (!case_name.empty()) {
+                return 1;
+            }
+            skipped++;
+            continue;
+        }
+        SystemConfig cfg = defaults;
+        if (!apply_case_params(entry["params"], cfg) || !parse_system_args(argc, argv, cfg)) {
+            std::cout << "[ SKIPPED ] " << name << std::endl;
+            if (!case_name.empty()) {
+                return 1;
+            }
+            failures++;
+            continue;
+        }
+        runs++;
+
+        if (!case_name.empty()) {
+            return dispatch(cfg);
+        }
+
+        std::cout << "[ RUNNING ] " << name << std::endl;
+        std::cout.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            std::string out_dir = "out/test_runs_multi/" + name;
+            setenv("SIM_OUT_DIR", out_dir.c_str(), 1);
+            std::exit(dispatch(cfg));
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        bool pass = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        std::cout << (pass ? "[ PASSED ] " : "[ FAILED ] ") << name << std::endl;
+        if (!pass) {
+            failures++;
+        }
+    }
+
+    if (runs == 0 && !case_name.empty()) {
+        std::cerr << "Error: case " << case_name << " not found in " << config_file << std::endl;
+        return 1;
+    }
+    std::cout << "SUMMARY: RUNS=" << runs << " FAILURES=" << failures << " SKIPPED=" << skipped << std::endl;
+    return (failures > 0) ? 1 : 0;
+}
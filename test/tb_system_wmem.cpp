@@ -15,8 +15,12 @@
 #include <string>
 #include <cmath>
 #include <top.h>
+#include <banked_memory.h>
 #include <filesystem>
 #include <fft_types.h>
+#include <fft_ref.h>
+#include "wave_tracer.h"
+#include "sample_logger.h"
 
 #define SRAM_SYSC
 #include <axi_slave_to_sram64.h>
@@ -49,12 +53,64 @@ using namespace std;
 #define FFT_NUM_ADD 6
 #endif
 
+#ifndef FFT_RADIX
+#define FFT_RADIX 2
+#endif
+
+// Number of back-to-back jobs per core in continuous streaming mode (0: single job)
+#ifndef FFT_STREAM_JOBS
+#define FFT_STREAM_JOBS 0
+#endif
+
+// Reorder FFT outputs to natural order before write-back (0: bit-reversed)
+#ifndef FFT_NATURAL_ORDER
+#define FFT_NATURAL_ORDER 0
+#endif
+
+// Butterfly units of the folded FFT core (0: pipelined stage cascade)
+#ifndef FFT_FOLD_BF
+#define FFT_FOLD_BF 0
+#endif
+
+// Bit i enables the divide-by-2 scaling of stage i
+#ifndef FFT_SCALE_MASK
+#define FFT_SCALE_MASK 0
+#endif
+
+// Banks of one BankedMemory shared by all cores (0: a private slave per core)
+#ifndef FFT_SHARED_BANKS
+#define FFT_SHARED_BANKS 0
+#endif
+
+// Minimum SQNR (dB) accepted for the fixed-point datapath
+#ifndef FFT_SQNR_MIN_DB
+#define FFT_SQNR_MIN_DB 40.0
+#endif
+
 const int samples = FFT_SAMPLES;
 const int N = FFT_N;
 const int NUM_CORES = FFT_NUM_CORES;
 const int HOP = FFT_HOP;
 const int NUM_MULT = FFT_NUM_MULT;
 const int NUM_ADD = FFT_NUM_ADD;
+const int RADIX = FFT_RADIX;
+const unsigned SCALE_MASK = FFT_SCALE_MASK;
+const int STREAM_JOBS = FFT_STREAM_JOBS;
+const bool NATURAL_ORDER = FFT_NATURAL_ORDER;
+const int FOLD_BF = FFT_FOLD_BF;
+const int SHARED_BANKS = FFT_SHARED_BANKS;
+
+// Datapath sample type: FFT_FIXED_W total bits with FFT_FIXED_I integer bits
+#ifdef FFT_FIXED_W
+#ifndef FFT_FIXED_I
+#define FFT_FIXED_I 32
+#endif
+typedef complex_fixed_t<FFT_FIXED_W, FFT_FIXED_I> sample_t;
+const bool FIXED_POINT = true;
+#else
+typedef complex_t sample_t;
+const bool FIXED_POINT = false;
+#endif
 
 const sc_time CLK_PERIOD (2.0, SC_NS);
 
@@ -62,31 +118,39 @@ const unsigned int seed = 0;
 
 typedef axi::cfg::standard AxiCfg;
 
-// Helper Functions for DFT Verification
-inline int bit_reverse(int index, int bits) {
-    int rev = 0;
-    for (int i = 0; i < bits; ++i) {
-        if ((index & (1 << i)) != 0) {
-            rev |= (1 << (bits - 1 - i));
+// Shared memory: core c owns the region from beat c * REGION_BEATS, its inputs followed by
+// the outputs, which the DMA writes one frame further on
+const int REGION_BEATS = ((samples + N - 1) / N + 1) * N;
+const int SHARED_DEPTH = NUM_CORES * REGION_BEATS;
+const int NUM_BANKS = (SHARED_BANKS > 0) ? SHARED_BANKS : 1;
+typedef BankedMemory<((SHARED_DEPTH + NUM_BANKS - 1) / NUM_BANKS) * NUM_BANKS, AxiCfg, NUM_CORES, NUM_BANKS> SharedMemory;
+
+// Total output scaling applied by the stages selected in SCALE_MASK
+inline double output_scale() {
+    int num_stages = (int)std::log2(N);
+    double scale = 1.0;
+    for (int s = 0; s < num_stages; ++s) {
+        if ((SCALE_MASK >> s) & 1u) {
+            scale *= 0.5;
         }
     }
-    return rev;
+    return scale;
 }
 
-inline std::vector<complex_t> compute_dft(const std::vector<complex_t>& input) {
-    int size = input.size();
-    std::vector<complex_t> output(size);
-    const double PI = 3.14159265358979323846;
-    for (int k = 0; k < size; ++k) {
-        complex_t sum(0, 0);
-        for (int n = 0; n < size; ++n) {
-            double angle = -2.0 * PI * k * n / size;
-            complex_t w(cos(angle), sin(angle));
-            sum = sum + input[n] * w;
-        }
-        output[k] = sum;
+// Signal-to-quantization-noise ratio of actual outputs against the reference
+inline double compute_sqnr_db(const std::vector<complex_t>& actual, const std::vector<complex_t>& expected, int len) {
+    double signal_power = 0.0;
+    double noise_power = 0.0;
+    for (int i = 0; i < len; ++i) {
+        double er = actual[i].real - expected[i].real;
+        double ei = actual[i].imag - expected[i].imag;
+        signal_power += expected[i].real * expected[i].real + expected[i].imag * expected[i].imag;
+        noise_power += er * er + ei * ei;
+    }
+    if (noise_power == 0.0) {
+        return INFINITY;
     }
-    return output;
+    return 10.0 * std::log10(signal_power / noise_power);
 }
 
 // System testbench
@@ -94,21 +158,36 @@ SC_MODULE(testbench) {
     sc_clock clk;
     sc_signal<bool> rst_n;
     sc_signal<bool> start_signal;
+    sc_signal<bool> stream_mode;
+    sc_signal<bool> desc_mode; // Tied low: descriptor chains need backdoor access to the SRAM
+    sc_signal<bool> adaptive_mode; // Tied low: HOP stagger launches
+    Connections::Combinational<FftJob<AxiCfg>> job_chan;
     
     // Core Configuration Ports
     sc_vector<sc_signal<sc_uint<AxiCfg::addrWidth>>> base_addrs;
     sc_vector<sc_signal<int>> num_samples;
+    sc_vector<sc_signal<int>> fft_lens; // Tied to 0: full-length jobs
+    sc_signal<int> window;   // Tied to 0: rectangular window
+    sc_signal<int> stft_hop; // Tied to 0: no STFT split
+    sc_signal<sc_uint<AxiCfg::addrWidth>> stft_dst;
+    sc_signal<bool> prune_zeros; // Tied to 0: no pruning, all bins
+    sc_signal<int> bin_lo;
+    sc_signal<int> bin_hi;
+    sc_signal<bool> inverse; // Tied to 0: forward transforms
     
     // AXI4 Transaction Channels
     sc_vector<typename axi4<AxiCfg>::read::template chan<>> mem_read_chans;
     sc_vector<typename axi4<AxiCfg>::write::template chan<>> mem_write_chans;
 
     sc_vector<axi_slave_to_sram64<AxiCfg>> slaves;
+    SharedMemory* shared_mem; // Replaces the slaves with SHARED_BANKS > 0
 
-    Top<N, NUM_CORES, HOP, AxiCfg, NUM_MULT, NUM_ADD> fft_sys;
+    Top<N, NUM_CORES, HOP, AxiCfg, NUM_MULT, NUM_ADD, RADIX, sample_t, SCALE_MASK,
+        dma_cfg::standard, NATURAL_ORDER, FOLD_BF> fft_sys;
 
-    std::ofstream r_csv_files[NUM_CORES];
-    std::ofstream w_csv_files[NUM_CORES];
+    SampleLogger sample_log;
+    int r_logs[NUM_CORES];
+    int w_logs[NUM_CORES];
     vector<vector<complex_t>> inputs{NUM_CORES, vector<complex_t>(samples)};
     vector<vector<complex_t>> outputs{NUM_CORES, vector<complex_t>(samples)};
     int read_count[NUM_CORES];
@@ -129,11 +208,17 @@ SC_MODULE(testbench) {
         : clk("clk", CLK_PERIOD, 0.5, SC_ZERO_TIME, true),
           rst_n("rst_n"),
           start_signal("start_signal"),
+          stream_mode("stream_mode"),
+          desc_mode("desc_mode"),
+          adaptive_mode("adaptive_mode"),
+          job_chan("job_chan"),
           base_addrs("base_addrs", NUM_CORES),
           num_samples("num_samples", NUM_CORES),
+          fft_lens("fft_lens", NUM_CORES),
           mem_read_chans("mem_read_chans", NUM_CORES),
           mem_write_chans("mem_write_chans", NUM_CORES),
-          slaves("slaves", NUM_CORES),
+          slaves("slaves", (SHARED_BANKS > 0) ? 0 : NUM_CORES),
+          shared_mem(nullptr),
           fft_sys("fft_sys") 
     {
         Connections::set_sim_clk(&clk);
@@ -141,6 +226,17 @@ SC_MODULE(testbench) {
         fft_sys.clk(clk);
         fft_sys.rst_n(rst_n);
         fft_sys.start(start_signal);
+        fft_sys.stream_mode(stream_mode);
+        fft_sys.desc_mode(desc_mode);
+        fft_sys.adaptive_mode(adaptive_mode);
+        fft_sys.job_in(job_chan);
+        fft_sys.window(window);
+        fft_sys.stft_hop(stft_hop);
+        fft_sys.stft_dst(stft_dst);
+        fft_sys.prune_zeros(prune_zeros);
+        fft_sys.bin_lo(bin_lo);
+        fft_sys.bin_hi(bin_hi);
+        fft_sys.inverse(inverse);
 
         // Determine output directory
         const char* out_dir_env = std::getenv("SIM_OUT_DIR");
@@ -149,25 +245,34 @@ SC_MODULE(testbench) {
         // Create output directory and its data subfolder
         std::filesystem::create_directories(out_dir + "/data");
 
+        if (SHARED_BANKS > 0) {
+            shared_mem = new SharedMemory("shared_mem");
+            shared_mem->clk(clk);
+            shared_mem->rst_n(rst_n);
+            init_shared_memory();
+        }
+
         // Connect Cores, Channels, and Slaves
         for (int i = 0; i < NUM_CORES; ++i) {
             fft_sys.mem_read_ports[i](mem_read_chans[i]);
             fft_sys.mem_write_ports[i](mem_write_chans[i]);
             fft_sys.base_addrs[i](base_addrs[i]);
             fft_sys.num_samples[i](num_samples[i]);
+            fft_sys.fft_lens[i](fft_lens[i]);
             
-            slaves[i].clk(clk);
-            slaves[i].reset_bar(rst_n);
-            slaves[i].if_rd(mem_read_chans[i]);
-            slaves[i].if_wr(mem_write_chans[i]);
-            
-            std::string r_filename = out_dir + "/data/core" + std::to_string(i) + "_input.csv";
-            r_csv_files[i].open(r_filename);
-            r_csv_files[i] << "Timestamp,Real,Imaginary\n";
+            if (SHARED_BANKS > 0) {
+                shared_mem->read_ports[i](mem_read_chans[i]);
+                shared_mem->write_ports[i](mem_write_chans[i]);
+            } else {
+                slaves[i].clk(clk);
+                slaves[i].reset_bar(rst_n);
+                slaves[i].if_rd(mem_read_chans[i]);
+                slaves[i].if_wr(mem_write_chans[i]);
+            }
             
-            std::string w_filename = out_dir + "/data/core" + std::to_string(i) + "_output.csv";
-            w_csv_files[i].open(w_filename);
-            w_csv_files[i] << "Timestamp,Real,Imaginary\n";
+            std::string prefix = out_dir + "/data/core" + std::to_string(i);
+            r_logs[i] = sample_log.open(prefix + "_input.bin", AxiCfg::dataWidth);
+            w_logs[i] = sample_log.open(prefix + "_output.bin", AxiCfg::dataWidth);
 
             read_count[i] = 0;
             write_count[i] = 0;
@@ -180,6 +285,7 @@ SC_MODULE(testbench) {
             write_stall_cycles[i] = 0;
         }
         start_time_ns = -1.0;
+        sample_log.start();
 
         SC_THREAD(run);
         
@@ -188,12 +294,25 @@ SC_MODULE(testbench) {
     }
     
     ~testbench() {
-        for (int i = 0; i < NUM_CORES; ++i) {
-            if (r_csv_files[i].is_open()) {
-                r_csv_files[i].close();
-            }
-            if (w_csv_files[i].is_open()) {
-                w_csv_files[i].close();
+        sample_log.close();
+        delete shared_mem;
+    }
+
+    // Byte address of the region of core c (0 on private slaves)
+    static unsigned int core_base(int c) {
+        return (SHARED_BANKS > 0) ? c * REGION_BEATS * (AxiCfg::dataWidth / 8) : 0;
+    }
+
+    // Random 16-bit real/imag inputs in the region of every core
+    void init_shared_memory() {
+        boost::random::mt19937 gen(seed);
+        boost::random::uniform_int_distribution<> uniform_rand;
+        for (int c = 0; c < NUM_CORES; ++c) {
+            for (int i = 0; i < samples; ++i) {
+                uint16_t rand_real = uniform_rand(gen) & 0xFFFF;
+                uint16_t rand_imag = uniform_rand(gen) & 0xFFFF;
+                shared_mem->write_word(core_base(c) + i * (AxiCfg::dataWidth / 8),
+                                       pack_complex<AxiCfg>(rand_real, rand_imag));
             }
         }
     }
@@ -223,7 +342,7 @@ SC_MODULE(testbench) {
                 }
                 auto r_pay = mem_read_chans[c].r.in_msg.read();
                 complex_t val = unpack_complex<AxiCfg>(r_pay.data);
-                r_csv_files[c] << sc_time_stamp().to_string() << "," << val.real << "," << val.imag << "\n";
+                sample_log.log(r_logs[c], (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS)), r_pay.data.to_uint64());
                 if (read_count[c] < samples) {
                     inputs[c][read_count[c]] = val;
                     read_count[c]++;
@@ -237,7 +356,7 @@ SC_MODULE(testbench) {
                 last_write_times_ns[c] = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
                 auto w_pay = mem_write_chans[c].w.in_msg.read();
                 complex_t val = unpack_complex<AxiCfg>(w_pay.data);
-                w_csv_files[c] << sc_time_stamp().to_string() << "," << val.real << "," << val.imag << "\n";
+                sample_log.log(w_logs[c], (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS)), w_pay.data.to_uint64());
                 if (write_count[c] < samples) {
                     outputs[c][write_count[c]] = val;
                     write_count[c]++;
@@ -254,6 +373,7 @@ SC_MODULE(testbench) {
         std::cout << "@" << sc_time_stamp() << " Simulation complete. Verifying Slave memory..." << std::endl;
 
         bool all_pass = true;
+        FftReference reference(N);
         for (int c = 0; c < NUM_CORES; ++c) {
             int len = samples;
             int aligned_len = ((len + N - 1) / N) * N;
@@ -263,19 +383,19 @@ SC_MODULE(testbench) {
                 padded_inputs.push_back(complex_t(0.0, 0.0));
             }
 
-            std::vector<complex_t> expected(aligned_len);
-            int num_blocks = aligned_len / N;
-            int bits = (int)std::log2(N);
-            for (int b = 0; b < num_blocks; ++b) {
-                std::vector<complex_t> block_in(N);
-                for (int i = 0; i < N; ++i) {
-                    block_in[i] = padded_inputs[b * N + i];
-                }
-                std::vector<complex_t> block_out = compute_dft(block_in);
-                for (int i = 0; i < N; ++i) {
-                    int rev_i = bit_reverse(i, bits);
-                    expected[b * N + rev_i] = block_out[i];
+            std::vector<complex_t> expected = reference.frames(padded_inputs, NATURAL_ORDER, output_scale());
+
+            double sqnr_db = compute_sqnr_db(outputs[c], expected, len);
+            std::cout << "SQNR_RESULT: CORE=" << c << " SQNR_DB=" << sqnr_db << std::endl;
+            if (FIXED_POINT) {
+                // Bit-accurate datapath is checked against the SQNR budget instead of exact rounding
+                if (sqnr_db < FFT_SQNR_MIN_DB) {
+                    std::cout << "Core " << c << " [SQNR BELOW " << FFT_SQNR_MIN_DB << " dB]" << std::endl;
+                    all_pass = false;
+                } else {
+                    std::cout << "Core " << c << " [OK]" << std::endl;
                 }
+                continue;
             }
 
             for (int i = 0; i < len; ++i) {
@@ -310,6 +430,7 @@ SC_MODULE(testbench) {
     void run() {
         rst_n.write(false);
         start_signal.write(false);
+        stream_mode.write(STREAM_JOBS > 0);
         for (int i = 0; i < NUM_CORES; ++i) {
             base_addrs[i].write(0);
             num_samples[i].write(0);
@@ -319,16 +440,45 @@ SC_MODULE(testbench) {
         rst_n.write(true);
         wait(5 * CLK_PERIOD);
 
-        for (int c = 0; c < NUM_CORES; ++c) {
-            base_addrs[c].write(0);
-            num_samples[c].write(samples);
-        }
-
         std::cout << "@" << sc_time_stamp() << " Starting FFT system..." << std::endl;
         start_time_ns = sc_time_stamp().to_double() / sc_time(1.0, SC_NS).to_double();
-        start_signal.write(true);
-        wait(CLK_PERIOD);
-        start_signal.write(false);
+        if (STREAM_JOBS > 0) {
+            // Continuous streaming: submit the samples as back-to-back jobs of whole frames
+            int job_len = (samples / STREAM_JOBS / N) * N;
+            for (int j = 0; j < STREAM_JOBS; ++j) {
+                // Keep at most jobQueueDepth jobs waiting in each DMA
+                bool has_room = false;
+                while (!has_room) {
+                    has_room = true;
+                    for (int c = 0; c < NUM_CORES; ++c) {
+                        if (read_count[c] < (j - (int)dma_cfg::standard::jobQueueDepth) * job_len + 1) {
+                            has_room = false;
+                        }
+                    }
+                    if (!has_room) {
+                        wait(CLK_PERIOD);
+                    }
+                }
+                int len = (j == STREAM_JOBS - 1) ? samples - j * job_len : job_len;
+                for (int c = 0; c < NUM_CORES; ++c) {
+                    base_addrs[c].write(core_base(c) + j * job_len * (AxiCfg::dataWidth / 8));
+                    num_samples[c].write(len);
+                }
+                start_signal.write(true);
+                wait(CLK_PERIOD);
+                start_signal.write(false);
+                // Let the stagger sequence pick up this job on every core
+                wait((NUM_CORES * HOP + 4) * CLK_PERIOD);
+            }
+        } else {
+            for (int c = 0; c < NUM_CORES; ++c) {
+                base_addrs[c].write(core_base(c));
+                num_samples[c].write(samples);
+            }
+            start_signal.write(true);
+            wait(CLK_PERIOD);
+            start_signal.write(false);
+        }
 
         // Dynamically wait until all cores have written all their samples
         bool all_done = false;
@@ -367,11 +517,25 @@ SC_MODULE(testbench) {
         avg_overhead_cycles /= NUM_CORES;
         double avg_ideal_cycles = total_cycles - avg_overhead_cycles;
 
+#ifdef FFT_FIXED_W
+        // Storage and multiplier sizing of the bit-accurate datapath
+        std::cout << "DATAPATH_RESULT: W=" << FFT_FIXED_W
+                  << " I=" << FFT_FIXED_I
+                  << " DELAY_LINE_BITS=" << 2 * FFT_FIXED_W * (N - 1)
+                  << " MULT_WIDTH=" << FFT_FIXED_W << "x" << FFT_FIXED_W
+                  << std::endl;
+#endif
+
         std::cout << "PERFORMANCE_RESULT: N=" << N 
                   << " CORES=" << NUM_CORES 
                   << " HOP=" << HOP 
                   << " MULT=" << NUM_MULT 
                   << " ADD=" << NUM_ADD 
+                  << " RADIX=" << RADIX 
+                  << " STREAM_JOBS=" << STREAM_JOBS 
+                  << " NATURAL_ORDER=" << NATURAL_ORDER 
+                  << " FOLD_BF=" << FOLD_BF 
+                  << " SHARED_BANKS=" << SHARED_BANKS 
                   << " SAMPLES=" << samples 
                   << " START=" << start_time_ns 
                   << " END=" << max_end_time 
@@ -380,6 +544,11 @@ SC_MODULE(testbench) {
                   << " OVERHEAD=" << avg_overhead_cycles 
                   << std::endl;
 
+        if (SHARED_BANKS > 0) {
+            // Bank conflicts of the HOP stagger on the shared memory
+            shared_mem->report();
+        }
+
         bool all_pass = verify_slave_memories();
         if (!all_pass) {
             sc_report_handler::report(SC_ERROR, "Verification failed", "Some outputs mismatch", __FILE__, __LINE__);
@@ -394,55 +563,71 @@ int sc_main(int argc, char *argv[]) {
 
     nvhls::set_random_seed();
 
+    // TRACE*=... arguments select the waveform format, window and signals
+    TraceOptions trace_opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos || !set_trace_option(trace_opts, arg.substr(0, eq), arg.substr(eq + 1)) ||
+            !valid_trace_format(trace_opts.format)) {
+            std::cerr << "Error: unsupported argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
     testbench tb("tb");
 
-    // VCD setup
+    // Waveform tracing (TRACE=none elaborates no tracer)
     const char* out_dir_env = std::getenv("SIM_OUT_DIR");
     std::string out_dir = (out_dir_env != nullptr) ? out_dir_env : "out";
-    std::string vcd_path = out_dir + "/trace";
-    sc_trace_file *tf = sc_create_vcd_trace_file(vcd_path.c_str());
-    if (tf) {
-        sc_trace(tf, tb.clk, "Control.clk");
-        sc_trace(tf, tb.rst_n, "Control.rst_n");
-        sc_trace(tf, tb.start_signal, "Control.start_signal");
+    std::unique_ptr<WaveTracer> tracer;
+    if (trace_opts.format != "none") {
+        tracer.reset(new WaveTracer("tracer", tb.clk, trace_opts, out_dir + "/trace"));
+        WaveTracer& tr = *tracer;
+        tr.add("control", -1, "Control.rst_n", tb.rst_n);
+        tr.add("control", -1, "Control.start_signal", tb.start_signal);
         
-        sc_trace(tf, tb.fft_sys.active_stagger, "Stagger.active");
-        sc_trace(tf, tb.fft_sys.stagger_counter, "Stagger.counter");
+        tr.add("stagger", -1, "Stagger.active", tb.fft_sys.active_stagger);
+        tr.add("stagger", -1, "Stagger.counter", tb.fft_sys.stagger_counter);
         
         for (int i = 0; i < NUM_CORES; ++i) {
             std::string core_prefix = "Core" + std::to_string(i) + ".";
-            sc_trace(tf, tb.base_addrs[i], (core_prefix + "base_addr").c_str());
-            sc_trace(tf, tb.num_samples[i], (core_prefix + "num_samples").c_str());
-            sc_trace(tf, tb.fft_sys.core_starts[i], (core_prefix + "start").c_str());
-            sc_trace(tf, tb.fft_sys.core_busy[i], (core_prefix + "busy").c_str());
-
-            sc_trace(tf, tb.mem_read_chans[i].ar.in_val, (core_prefix + "AXI_AR.ar_val").c_str());
-            sc_trace(tf, tb.mem_read_chans[i].ar.in_rdy, (core_prefix + "AXI_AR.ar_rdy").c_str());
-            sc_trace(tf, tb.mem_read_chans[i].ar.in_msg, (core_prefix + "AXI_AR.ar_msg").c_str());
-
-            sc_trace(tf, tb.mem_read_chans[i].r.in_val, (core_prefix + "AXI_R.r_val").c_str());
-            sc_trace(tf, tb.mem_read_chans[i].r.in_rdy, (core_prefix + "AXI_R.r_rdy").c_str());
-            sc_trace(tf, tb.mem_read_chans[i].r.in_msg, (core_prefix + "AXI_R.r_msg").c_str());
-
-            sc_trace(tf, tb.mem_write_chans[i].aw.in_val, (core_prefix + "AXI_AW.aw_val").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].aw.in_rdy, (core_prefix + "AXI_AW.aw_rdy").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].aw.in_msg, (core_prefix + "AXI_AW.aw_msg").c_str());
-
-            sc_trace(tf, tb.mem_write_chans[i].w.in_val, (core_prefix + "AXI_W.w_val").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].w.in_rdy, (core_prefix + "AXI_W.w_rdy").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].w.in_msg, (core_prefix + "AXI_W.w_msg").c_str());
-
-            sc_trace(tf, tb.mem_write_chans[i].b.in_val, (core_prefix + "AXI_B.b_val").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].b.in_rdy, (core_prefix + "AXI_B.b_rdy").c_str());
-            sc_trace(tf, tb.mem_write_chans[i].b.in_msg, (core_prefix + "AXI_B.b_msg").c_str());
-
-            sc_trace(tf, tb.fft_sys.cores[i].dma_to_fft_chan.in_val, (core_prefix + "Internal.dma_to_fft_val").c_str());
-            sc_trace(tf, tb.fft_sys.cores[i].dma_to_fft_chan.in_rdy, (core_prefix + "Internal.dma_to_fft_rdy").c_str());
-            sc_trace(tf, tb.fft_sys.cores[i].dma_to_fft_chan.in_msg, (core_prefix + "Internal.dma_to_fft_msg").c_str());
-
-            sc_trace(tf, tb.fft_sys.cores[i].fft_to_dma_chan.in_val, (core_prefix + "Internal.fft_to_dma_val").c_str());
-            sc_trace(tf, tb.fft_sys.cores[i].fft_to_dma_chan.in_rdy, (core_prefix + "Internal.fft_to_dma_rdy").c_str());
-            sc_trace(tf, tb.fft_sys.cores[i].fft_to_dma_chan.in_msg, (core_prefix + "Internal.fft_to_dma_msg").c_str());
+            tr.add("control", i, core_prefix + "base_addr", tb.base_addrs[i]);
+            tr.add("control", i, core_prefix + "num_samples", tb.num_samples[i]);
+            tr.add("control", i, core_prefix + "start", tb.fft_sys.core_starts[i]);
+            tr.add("control", i, core_prefix + "busy", tb.fft_sys.core_busy[i]);
+
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_val", tb.mem_read_chans[i].ar.in_val);
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_rdy", tb.mem_read_chans[i].ar.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_AR.ar_msg", tb.mem_read_chans[i].ar.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_R.r_val", tb.mem_read_chans[i].r.in_val);
+            tr.add("axi", i, core_prefix + "AXI_R.r_rdy", tb.mem_read_chans[i].r.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_R.r_msg", tb.mem_read_chans[i].r.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_val", tb.mem_write_chans[i].aw.in_val);
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_rdy", tb.mem_write_chans[i].aw.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_AW.aw_msg", tb.mem_write_chans[i].aw.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_W.w_val", tb.mem_write_chans[i].w.in_val);
+            tr.add("axi", i, core_prefix + "AXI_W.w_rdy", tb.mem_write_chans[i].w.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_W.w_msg", tb.mem_write_chans[i].w.in_msg);
+
+            tr.add("axi", i, core_prefix + "AXI_B.b_val", tb.mem_write_chans[i].b.in_val);
+            tr.add("axi", i, core_prefix + "AXI_B.b_rdy", tb.mem_write_chans[i].b.in_rdy);
+            tr.add("axi", i, core_prefix + "AXI_B.b_msg", tb.mem_write_chans[i].b.in_msg);
+
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_val", tb.fft_sys.cores[i].dma_to_fft_chan.in_val);
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_rdy", tb.fft_sys.cores[i].dma_to_fft_chan.in_rdy);
+            tr.add("internal", i, core_prefix + "Internal.dma_to_fft_msg", tb.fft_sys.cores[i].dma_to_fft_chan.in_msg);
+
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_val", tb.fft_sys.cores[i].fft_to_dma_chan.in_val);
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_rdy", tb.fft_sys.cores[i].fft_to_dma_chan.in_rdy);
+            tr.add("internal", i, core_prefix + "Internal.fft_to_dma_msg", tb.fft_sys.cores[i].fft_to_dma_chan.in_msg);
+
+            // AR and AW handshakes define the transaction window
+            tr.add_transaction(tb.mem_read_chans[i].ar.in_val, tb.mem_read_chans[i].ar.in_rdy, i);
+            tr.add_transaction(tb.mem_write_chans[i].aw.in_val, tb.mem_write_chans[i].aw.in_rdy, i);
         }
     }
 
@@ -450,10 +635,8 @@ int sc_main(int argc, char *argv[]) {
 
     sc_start();
 
-    // Close VCD
-    if (tf) {
-        sc_close_vcd_trace_file(tf);
-    }
+    // Flush and close the trace file
+    tracer.reset();
 
     bool rc = (sc_report_handler::get_count(SC_ERROR) > 0);
     if (rc) 
@@ -0,0 +1,312 @@
+#include "tb_system.h"
+#include <tlm_top.h>
+#include <fft.h>
+#include <chrono>
+
+// Loosely-timed TLM model of Top against the reference FFT and, for core 0, against the
+// cycle-accurate FFT pipeline fed with the same frames (outputs must match word for word).
+// Usage: tb_tlm [SAMPLES=..] [STREAM_JOBS=..]
+
+#ifndef FFT_SAMPLES
+#define FFT_SAMPLES 256
+#endif
+
+#ifndef FFT_N
+#define FFT_N 8
+#endif
+
+#ifndef FFT_NUM_CORES
+#define FFT_NUM_CORES 2
+#endif
+
+#ifndef FFT_HOP
+#define FFT_HOP 1
+#endif
+
+#ifndef FFT_NUM_MULT
+#define FFT_NUM_MULT 4
+#endif
+
+#ifndef FFT_NUM_ADD
+#define FFT_NUM_ADD 6
+#endif
+
+// Cycles every TLM core may run ahead of the kernel
+#ifndef FFT_TLM_QUANTUM
+#define FFT_TLM_QUANTUM 10000
+#endif
+
+// Run the cycle-accurate pipeline on the core 0 frames as well (0: TLM model only)
+#ifndef FFT_TLM_CROSSCHECK
+#define FFT_TLM_CROSSCHECK 1
+#endif
+
+const int TLM_MEM_DEPTH = 1 << 20; // Words of the shared TLM memory
+
+// Cycle-accurate FFT pipeline fed with the frames of one core
+SC_MODULE(PipelineReference) {
+    sc_clock clk;
+    sc_signal<bool> rst_n;
+    Combinational<sample_t> in_chan;
+    Combinational<sample_t> out_chan;
+    Out<sample_t> in_port;
+    In<sample_t> out_port;
+    FFT<FFT_N, FFT_NUM_MULT, FFT_NUM_ADD, RADIX, sample_t, SCALE_MASK> fft;
+
+    std::vector<complex_t> inputs; // Zero padded to whole frames
+    std::vector<sc_uint<AxiCfg::dataWidth>> words;
+    bool done;
+
+    // The frames, then one zero frame pushing the last frame out
+    void source_thread() {
+        in_port.Reset();
+        wait();
+        for (size_t i = 0; i < inputs.size() + FFT_N; ++i) {
+            in_port.Push(i < inputs.size() ? sample_t(inputs[i]) : sample_t(0.0, 0.0));
+        }
+    }
+
+    void sink_thread() {
+        out_port.Reset();
+        wait();
+        int bits = (int)std::log2(FFT_N);
+        std::vector<sample_t> frame(FFT_N);
+        for (size_t f = 0; f < inputs.size(); f += FFT_N) {
+            for (int i = 0; i < FFT_N; ++i) {
+                // The reorder buffer only permutes the frame
+                frame[NATURAL_ORDER ? bit_reverse(i, bits) : i] = out_port.Pop();
+            }
+            for (int i = 0; i < FFT_N; ++i) {
+                words.push_back(pack_complex<AxiCfg>(frame[i]));
+            }
+        }
+        done = true;
+    }
+
+    SC_HAS_PROCESS(PipelineReference);
+    PipelineReference(sc_module_name name, const std::vector<complex_t>& frames)
+        : sc_module(name),
+          clk("clk", CLK_PERIOD),
+          in_chan("in_chan"),
+          out_chan("out_chan"),
+          in_port("in_port"),
+          out_port("out_port"),
+          fft("fft"),
+          inputs(frames),
+          done(false)
+    {
+        Connections::set_sim_clk(&clk);
+        fft.clk(clk);
+        fft.rst_n(rst_n);
+        in_port(in_chan);
+        fft.in_data(in_chan);
+        fft.out_data(out_chan);
+        out_port(out_chan);
+        rst_n.write(true);
+
+        SC_THREAD(source_thread);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+
+        SC_THREAD(sink_thread);
+        sensitive << clk.posedge_event();
+        async_reset_signal_is(rst_n, false);
+    }
+};
+
+SC_MODULE(TlmTestbench) {
+    const int samples;
+    const int stream_jobs;
+    const double sqnr_min_db;
+
+    TlmTop<FFT_N, FFT_NUM_CORES, FFT_HOP, AxiCfg, FFT_NUM_MULT, FFT_NUM_ADD, RADIX, sample_t,
+           SCALE_MASK, NATURAL_ORDER> top;
+    TlmMemory<TLM_MEM_DEPTH, AxiCfg> mem;
+    PipelineReference* reference; // Cross-check of core 0 (FFT_TLM_CROSSCHECK only)
+
+    std::vector<std::vector<complex_t>> inputs;
+
+    static const int bpb = AxiCfg::dataWidth / 8;
+
+    int aligned_len() const {
+        return ((samples + FFT_N - 1) / FFT_N) * FFT_N;
+    }
+
+    // Byte address of the input region of core c; outputs follow N beats later
+    uint64_t core_base(int c) const {
+        return (uint64_t)c * (aligned_len() + 2 * FFT_N) * bpb;
+    }
+
+    void init_memory() {
+        boost::random::mt19937 gen(seed);
+        boost::random::uniform_int_distribution<> uniform_rand;
+        for (int c = 0; c < FFT_NUM_CORES; ++c) {
+            for (int i = 0; i < samples; ++i) {
+                // 16-bit random real/imag values
+                uint16_t rand_real = uniform_rand(gen) & 0xFFFF;
+                uint16_t rand_imag = uniform_rand(gen) & 0xFFFF;
+                sc_uint<AxiCfg::dataWidth> wr_data = ((uint64_t)rand_real << 32) | rand_imag;
+                mem.write_word(core_base(c) + i * bpb, wr_data);
+                inputs[c].push_back(unpack_complex<AxiCfg>(wr_data));
+            }
+        }
+    }
+
+    void submit_jobs() {
+        for (int c = 0; c < FFT_NUM_CORES; ++c) {
+            if (stream_jobs > 0) {
+                // Back-to-back jobs of whole frames, in the streaming memory layout
+                int job_len = (samples / stream_jobs / FFT_N) * FFT_N;
+                for (int j = 0; j < stream_jobs; ++j) {
+                    int len = (j == stream_jobs - 1) ? samples - j * job_len : job_len;
+                    top.submit(c, core_base(c) + (uint64_t)j * job_len * bpb, len);
+                }
+            } else {
+                top.submit(c, core_base(c), samples);
+            }
+        }
+    }
+
+    bool tlm_idle() const {
+        for (int c = 0; c < FFT_NUM_CORES; ++c) {
+            if (top.cores[c].busy || !top.cores[c].jobs.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The reference clock never stops: end the run once both models are done
+    void finish_thread() {
+        do {
+            wait(CLK_PERIOD * (double)FFT_TLM_QUANTUM);
+        } while (!reference->done || !tlm_idle());
+        sc_stop();
+    }
+
+    bool verify() {
+        bool all_pass = true;
+        int bits = (int)std::log2(FFT_N);
+        double scale = 1.0;
+        for (int s = 0; s < bits; ++s) {
+            if ((SCALE_MASK >> s) & 1u) {
+                scale *= 0.5;
+            }
+        }
+
+        FftReference reference_fft(FFT_N);
+        for (int c = 0; c < FFT_NUM_CORES; ++c) {
+            std::vector<complex_t> expected = reference_fft.frames(inputs[c], NATURAL_ORDER, scale);
+
+            std::vector<complex_t> actual(samples);
+            for (int i = 0; i < samples; ++i) {
+                actual[i] = unpack_complex<AxiCfg>(mem.read_word(core_base(c) + (FFT_N + i) * bpb));
+            }
+
+            bool pass = true;
+            double sqnr_db = compute_sqnr_db(actual, expected, samples);
+            std::cout << "SQNR_RESULT: CORE=" << c << " SQNR_DB=" << sqnr_db << std::endl;
+            if (FIXED_POINT) {
+                pass = (sqnr_db >= sqnr_min_db);
+            } else {
+                for (int i = 0; i < samples && pass; ++i) {
+                    pass = std::abs(actual[i].real - std::round(expected[i].real)) < 1e-2 &&
+                           std::abs(actual[i].imag - std::round(expected[i].imag)) < 1e-2;
+                    if (!pass) {
+                        std::cout << "Core " << c << " index " << i << " [MISMATCH] Expected: ("
+                                  << expected[i].real << ", " << expected[i].imag << "), Actual: ("
+                                  << actual[i].real << ", " << actual[i].imag << ")" << std::endl;
+                    }
+                }
+            }
+
+            if (c == 0 && reference != nullptr) {
+                int mismatches = 0;
+                for (int i = 0; i < samples; ++i) {
+                    if (!reference->done || mem.read_word(core_base(0) + (FFT_N + i) * bpb) != reference->words[i]) {
+                        mismatches++;
+                    }
+                }
+                std::cout << "CROSSCHECK_RESULT: CORE=0 MISMATCHES=" << mismatches << std::endl;
+                pass = pass && (mismatches == 0);
+            }
+
+            std::cout << "Core " << c << (pass ? " [OK]" : " [FAILED]") << std::endl;
+            all_pass = all_pass && pass && !top.cores[c].errors;
+        }
+        return all_pass;
+    }
+
+    SC_HAS_PROCESS(TlmTestbench);
+    TlmTestbench(sc_module_name name, const SystemConfig& cfg)
+        : sc_module(name),
+          samples(cfg.samples),
+          stream_jobs(cfg.stream_jobs),
+          sqnr_min_db(cfg.sqnr_min_db),
+          top("top", CLK_PERIOD),
+          mem("mem", CLK_PERIOD),
+          reference(nullptr),
+          inputs(FFT_NUM_CORES)
+    {
+        for (int c = 0; c < FFT_NUM_CORES; ++c) {
+            top.cores[c].socket.bind(mem.socket);
+        }
+
+        init_memory();
+        submit_jobs();
+
+        if (FFT_TLM_CROSSCHECK) {
+            std::vector<complex_t> frames = inputs[0];
+            frames.resize(aligned_len(), complex_t(0.0, 0.0));
+            reference = new PipelineReference("reference", frames);
+            SC_THREAD(finish_thread);
+        }
+    }
+
+    ~TlmTestbench() {
+        delete reference;
+    }
+};
+
+int sc_main(int argc, char *argv[]) {
+    sc_report_handler::set_actions( "/IEEE_Std_1666/deprecated", SC_DO_NOTHING );
+    sc_set_default_time_unit(1.0, SC_NS);
+
+    SystemConfig cfg = {
+        FFT_N, FFT_NUM_CORES, FFT_HOP, FFT_NUM_MULT, FFT_NUM_ADD,
+        FFT_SAMPLES, 0, 0, 0, 0, FFT_SQNR_MIN_DB
+    };
+    if (!parse_system_args(argc, argv, cfg)) {
+        return 1;
+    }
+    if (cfg.n != FFT_N || cfg.num_cores != FFT_NUM_CORES || cfg.hop != FFT_HOP ||
+        cfg.num_mult != FFT_NUM_MULT || cfg.num_add != FFT_NUM_ADD) {
+        std::cerr << "Error: N/NUM_CORES/HOP/NUM_MULS/NUM_ADDS are compiled in" << std::endl;
+        return 1;
+    }
+    if ((uint64_t)FFT_NUM_CORES * (cfg.samples + 3 * FFT_N) > (uint64_t)TLM_MEM_DEPTH) {
+        std::cerr << "Error: SAMPLES does not fit in the TLM memory" << std::endl;
+        return 1;
+    }
+
+    tlm::tlm_global_quantum::instance().set(CLK_PERIOD * (double)FFT_TLM_QUANTUM);
+    TlmTestbench tb("tb", cfg);
+
+    auto wall_start = std::chrono::steady_clock::now();
+    sc_start();
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+
+    double total_cycles = tb.top.done_time() / CLK_PERIOD;
+    unsigned long frames = 0;
+    for (int c = 0; c < FFT_NUM_CORES; ++c) {
+        frames += tb.top.cores[c].frames_done;
+    }
+    std::cout << "TLM_RESULT: N=" << FFT_N << " NUM_CORES=" << FFT_NUM_CORES
+              << " SAMPLES=" << cfg.samples << " TOTAL_CYCLES=" << total_cycles
+              << " FRAMES=" << frames
+              << " WALL_MS=" << wall_ms << std::endl;
+
+    bool pass = tb.verify();
+    std::cout << (pass ? "TESTBENCH PASS" : "TESTBENCH FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
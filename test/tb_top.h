@@ -9,6 +9,7 @@
 #include <connections/connections.h>
 #include "top.h"
 #include "memory.h"
+#include "fft_ref.h"
 #include <vector>
 #include <queue>
 #include <iostream>
@@ -22,7 +23,8 @@ using namespace Connections;
 typedef axi::cfg::standard AxiCfg;
 
 // Top-level testbench for verifying the Multi-Core Interleaved FFT system.
-template<int N, int NUM_CORES, int HOP, int NUM_MULT=4, int NUM_ADD=6>
+// MEM_READ_LATENCY sets the access latency (cycles) of the per-core memories.
+template<int N, int NUM_CORES, int HOP, int NUM_MULT=4, int NUM_ADD=6, int MEM_READ_LATENCY=0>
 SC_MODULE(Testbench) {
     sc_clock clk;
     sc_signal<int> cycle_count;
@@ -33,7 +35,7 @@ SC_MODULE(Testbench) {
     static const int DATA_WIDTH  = AxiCfg::dataWidth;
     
     // Dedicated Single-Port Memories
-    sc_vector<Memory<MEM_DEPTH, AxiCfg>> mems;
+    sc_vector<Memory<MEM_DEPTH, AxiCfg, MEM_READ_LATENCY, 4, true>> mems;
     
     // Read and Write channels connecting Memory and Cores (default port types)
     sc_vector<typename axi4<AxiCfg>::read::template chan<>> mem_read_chans;
@@ -42,9 +44,21 @@ SC_MODULE(Testbench) {
     Top<N, NUM_CORES, HOP, AxiCfg, NUM_MULT, NUM_ADD>* fft_sys;
     
     sc_signal<bool> start_signal;
+    sc_signal<bool> stream_mode; // Tied low: one job per start
+    sc_signal<bool> desc_mode;   // Tied low: jobs come from base_addrs/num_samples
+    sc_signal<bool> adaptive_mode; // Tied low: HOP stagger launches
+    Combinational<FftJob<AxiCfg>> job_chan; // Adaptive scheduler jobs (unused)
     
     sc_vector<sc_signal<sc_uint<ADDR_WIDTH>>> base_addrs;
     sc_vector<sc_signal<int>> num_samples;
+    sc_vector<sc_signal<int>> fft_lens; // Tied to 0: full-length jobs
+    sc_signal<int> window;   // Tied to 0: rectangular window
+    sc_signal<int> stft_hop; // Tied to 0: no STFT split
+    sc_signal<sc_uint<ADDR_WIDTH>> stft_dst;
+    sc_signal<bool> prune_zeros; // Tied to 0: no pruning, all bins
+    sc_signal<int> bin_lo;
+    sc_signal<int> bin_hi;
+    sc_signal<bool> inverse; // Tied to 0: forward transforms
     
     sc_trace_file* tf;
     
@@ -58,7 +72,8 @@ SC_MODULE(Testbench) {
         mem_read_chans("mem_read_chans", NUM_CORES),
         mem_write_chans("mem_write_chans", NUM_CORES),
         base_addrs("base_addr", NUM_CORES),
-        num_samples("num_samples", NUM_CORES)
+        num_samples("num_samples", NUM_CORES),
+        fft_lens("fft_lens", NUM_CORES)
     {
 
 
@@ -75,12 +90,24 @@ SC_MODULE(Testbench) {
         fft_sys->clk(clk);
         fft_sys->rst_n(rst_n);
         fft_sys->start(start_signal);
+        fft_sys->stream_mode(stream_mode);
+        fft_sys->desc_mode(desc_mode);
+        fft_sys->adaptive_mode(adaptive_mode);
+        fft_sys->job_in(job_chan);
         fft_sys->mem_read_ports(mem_read_chans);
         for(int i=0; i<NUM_CORES; i++) {
             fft_sys->mem_write_ports[i](mem_write_chans[i]);
         }
         fft_sys->base_addrs(base_addrs);
         fft_sys->num_samples(num_samples);
+        fft_sys->fft_lens(fft_lens);
+        fft_sys->window(window);
+        fft_sys->stft_hop(stft_hop);
+        fft_sys->stft_dst(stft_dst);
+        fft_sys->prune_zeros(prune_zeros);
+        fft_sys->bin_lo(bin_lo);
+        fft_sys->bin_hi(bin_hi);
+        fft_sys->inverse(inverse);
 
 
 
@@ -140,34 +167,7 @@ SC_MODULE(Testbench) {
                 target_core = 0;
             }
         }
-        mems[target_core].mem[addr >> 3] = data;
-    }
-
-    // Verification reference DFT model
-    std::vector<complex_t> compute_dft(const std::vector<complex_t>& input) {
-        int size = input.size();
-        std::vector<complex_t> output(size);
-        const double PI = 3.14159265358979323846;
-        for (int k = 0; k < size; ++k) {
-            complex_t sum(0, 0);
-            for (int n = 0; n < size; ++n) {
-                double angle = -2.0 * PI * k * n / size;
-                complex_t w(cos(angle), sin(angle));
-                sum = sum + input[n] * w;
-            }
-            output[k] = sum;
-        }
-        return output;
-    }
-
-    int bit_reverse(int index, int bits) {
-        int rev = 0;
-        for (int i = 0; i < bits; ++i) {
-            if ((index & (1 << i)) != 0) {
-                rev |= (1 << (bits - 1 - i));
-            }
-        }
-        return rev;
+        mems[target_core].write_word(addr, data);
     }
 
     // Validate outputs against expected DFT results
@@ -177,32 +177,19 @@ SC_MODULE(Testbench) {
         std::vector<complex_t> inputs(aligned_len);
         for (int i = 0; i < aligned_len; ++i) {
             if (i < len) {
-                sc_uint<AxiCfg::dataWidth> raw = mems[core_idx].mem[(start_addr >> 3) + i];
+                sc_uint<AxiCfg::dataWidth> raw = mems[core_idx].read_word(start_addr + i * bytesPerBeat);
                 inputs[i] = unpack_complex<AxiCfg>(raw);
             } else {
                 inputs[i] = complex_t(0.0, 0.0);
             }
         }
 
-        std::vector<complex_t> expected(aligned_len);
-        int num_blocks = aligned_len / N;
-        int bits = (int)std::log2(N);
-        for (int b = 0; b < num_blocks; ++b) {
-            std::vector<complex_t> block_in(N);
-            for (int i = 0; i < N; ++i) {
-                block_in[i] = inputs[b * N + i];
-            }
-            std::vector<complex_t> block_out = compute_dft(block_in);
-            for (int i = 0; i < N; ++i) {
-                int rev_i = bit_reverse(i, bits);
-                expected[b * N + rev_i] = block_out[i];
-            }
-        }
+        std::vector<complex_t> expected = FftReference(N).frames(inputs);
 
         bool pass = true;
         std::cout << "Core " << core_idx << " Verification (Base Addr: " << start_addr + N * bytesPerBeat << "):" << std::endl;
         for (int i = 0; i < len; ++i) {
-            sc_uint<AxiCfg::dataWidth> raw = mems[core_idx].mem[((start_addr + N * bytesPerBeat) >> 3) + i];
+            sc_uint<AxiCfg::dataWidth> raw = mems[core_idx].read_word(start_addr + (N + i) * bytesPerBeat);
             complex_t actual = unpack_complex<AxiCfg>(raw);
             complex_t exp = expected[i];
             
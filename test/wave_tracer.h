@@ -0,0 +1,452 @@
+/*
+ * wave_tracer.h
+ *
+ * Run-time configurable waveform tracer for the system testbenches.
+ * Signals are registered with a group (control, stagger, axi, internal) and a core index,
+ * and only the selected subset is kept. Values are sampled once per clock cycle (at the
+ * falling edge, after the registered updates) inside a time window given in cycles or a
+ * transaction window counted in AXI address handshakes, and value changes are written as
+ * VCD text, as a compact binary stream (wave_convert.py turns it into VCD) or, when built
+ * with -DFFT_TRACE_FST and the GTKWave fstapi, as FST. TRACE=none elaborates no tracer.
+ */
+
+#ifndef WAVE_TRACER_H
+#define WAVE_TRACER_H
+
+#include <systemc.h>
+#include <nvhls_marshaller.h>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef FFT_TRACE_FST
+#include <fstapi.h>
+#endif
+
+using namespace sc_core;
+
+// Trace selection given on the command line (TRACE*=... arguments)
+struct TraceOptions {
+    std::string format = "vcd";   // none, vcd, bin or fst
+    long start_cycle = 0;         // First traced cycle
+    long stop_cycle = -1;         // Last traced cycle (-1: end of simulation)
+    long start_txn = 0;           // Trace from this AXI address handshake on
+    long stop_txn = -1;           // Stop after this many handshakes (-1: no limit)
+    std::string cores;            // Comma-separated core indices (empty: all)
+    std::string groups;           // Comma-separated signal groups (empty: all)
+};
+
+inline bool list_contains(const std::string& list, const std::string& item) {
+    if (list.empty()) {
+        return true;
+    }
+    std::stringstream ss(list);
+    std::string entry;
+    while (std::getline(ss, entry, ',')) {
+        if (entry == item) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Apply one TRACE* argument; returns false if key is not a trace option
+inline bool set_trace_option(TraceOptions& opts, const std::string& key, const std::string& value) {
+    if (key == "TRACE") opts.format = value;
+    else if (key == "TRACE_START") opts.start_cycle = std::atol(value.c_str());
+    else if (key == "TRACE_STOP") opts.stop_cycle = std::atol(value.c_str());
+    else if (key == "TRACE_START_TXN") opts.start_txn = std::atol(value.c_str());
+    else if (key == "TRACE_STOP_TXN") opts.stop_txn = std::atol(value.c_str());
+    else if (key == "TRACE_CORES") opts.cores = value;
+    else if (key == "TRACE_GROUPS") opts.groups = value;
+    else return false;
+    return true;
+}
+
+inline bool valid_trace_format(const std::string& format) {
+#ifdef FFT_TRACE_FST
+    if (format == "fst") return true;
+#endif
+    return format == "none" || format == "vcd" || format == "bin";
+}
+
+// Bit string (MSB first) and width of the traced value types; channel payloads are
+// traced through their marshalled bits
+template<typename T> struct WaveValue {
+    static int width() { return Wrapped<T>::width; }
+    static std::string bits(const T& v) {
+        return WaveValue<sc_lv<Wrapped<T>::width>>::bits(TypeToBits(v));
+    }
+};
+
+template<> struct WaveValue<bool> {
+    static int width() { return 1; }
+    static std::string bits(bool v) { return v ? "1" : "0"; }
+};
+
+template<> struct WaveValue<int> {
+    static int width() { return 32; }
+    static std::string bits(int v) {
+        std::string s(32, '0');
+        for (int i = 0; i < 32; ++i) {
+            if (((unsigned)v >> i) & 1u) s[31 - i] = '1';
+        }
+        return s;
+    }
+};
+
+template<int W> struct WaveValue<sc_uint<W>> {
+    static int width() { return W; }
+    static std::string bits(const sc_uint<W>& v) {
+        std::string s(W, '0');
+        for (int i = 0; i < W; ++i) {
+            if (v[i]) s[W - 1 - i] = '1';
+        }
+        return s;
+    }
+};
+
+template<int W> struct WaveValue<sc_lv<W>> {
+    static int width() { return W; }
+    static std::string bits(const sc_lv<W>& v) {
+        std::string s = v.to_string();
+        for (char& c : s) {
+            c = (c == 'X') ? 'x' : (c == 'Z') ? 'z' : c;
+        }
+        return s;
+    }
+};
+
+// Value-change writers
+class WaveWriter {
+public:
+    virtual ~WaveWriter() {}
+    virtual bool ok() const = 0;
+    virtual void declare(const std::string& name, int width) = 0;
+    virtual void end_header() = 0;
+    virtual void time(uint64_t ps) = 0;
+    virtual void change(int index, const std::string& bits) = 0;
+};
+
+class VcdWriter : public WaveWriter {
+public:
+    explicit VcdWriter(const std::string& path) : os(path) {
+        os << "$timescale 1 ps $end\n";
+    }
+
+    bool ok() const override { return os.good(); }
+
+    void declare(const std::string& name, int width) override {
+        // Hierarchical names "Core0.AXI_AR.ar_val" become scopes Core0 / AXI_AR
+        std::vector<std::string> parts = split(name);
+        size_t common = 0;
+        while (common < scopes.size() && common + 1 < parts.size() && scopes[common] == parts[common]) {
+            common++;
+        }
+        for (size_t i = scopes.size(); i > common; --i) {
+            os << "$upscope $end\n";
+        }
+        scopes.resize(common);
+        for (size_t i = common; i + 1 < parts.size(); ++i) {
+            os << "$scope module " << parts[i] << " $end\n";
+            scopes.push_back(parts[i]);
+        }
+        ids.push_back(make_id(ids.size()));
+        os << "$var wire " << width << " " << ids.back() << " " << parts.back() << " $end\n";
+        widths.push_back(width);
+    }
+
+    void end_header() override {
+        for (size_t i = 0; i < scopes.size(); ++i) {
+            os << "$upscope $end\n";
+        }
+        os << "$enddefinitions $end\n";
+    }
+
+    void time(uint64_t ps) override {
+        os << "#" << ps << "\n";
+    }
+
+    void change(int index, const std::string& bits) override {
+        if (widths[index] == 1) {
+            os << bits << ids[index] << "\n";
+        } else {
+            os << "b" << bits << " " << ids[index] << "\n";
+        }
+    }
+
+private:
+    std::ofstream os;
+    std::vector<std::string> scopes;
+    std::vector<std::string> ids;
+    std::vector<int> widths;
+
+    static std::vector<std::string> split(const std::string& name) {
+        std::vector<std::string> parts;
+        std::stringstream ss(name);
+        std::string part;
+        while (std::getline(ss, part, '.')) {
+            parts.push_back(part);
+        }
+        return parts;
+    }
+
+    static std::string make_id(size_t n) {
+        std::string id;
+        do {
+            id += (char)('!' + n % 94);
+            n /= 94;
+        } while (n > 0);
+        return id;
+    }
+};
+
+// Binary value-change stream:
+//   "FFTWAVE1", varint signal count, per signal {varint name length, name, varint width},
+//   then records {varint time delta (ps), {varint index + 1, 2-bit packed value}..., 0}
+// Every bit takes two bits (0, 1, x, z = 0..3), four bits per byte, MSB first.
+class BinaryWriter : public WaveWriter {
+public:
+    explicit BinaryWriter(const std::string& path) : os(path, std::ios::binary), last_ps(0), open_record(false) {
+        os.write("FFTWAVE1", 8);
+    }
+
+    bool ok() const override { return os.good(); }
+
+    void declare(const std::string& name, int width) override {
+        names.push_back(name);
+        widths.push_back(width);
+    }
+
+    void end_header() override {
+        varint(names.size());
+        for (size_t i = 0; i < names.size(); ++i) {
+            varint(names[i].size());
+            os.write(names[i].data(), names[i].size());
+            varint(widths[i]);
+        }
+    }
+
+    void time(uint64_t ps) override {
+        close_record();
+        varint(ps - last_ps);
+        last_ps = ps;
+        open_record = true;
+    }
+
+    void change(int index, const std::string& bits) override {
+        varint(index + 1);
+        unsigned char byte = 0;
+        for (size_t i = 0; i < bits.size(); ++i) {
+            int code = (bits[i] == '1') ? 1 : (bits[i] == 'x') ? 2 : (bits[i] == 'z') ? 3 : 0;
+            byte = (unsigned char)((byte << 2) | code);
+            if (i % 4 == 3 || i + 1 == bits.size()) {
+                byte <<= 2 * (3 - i % 4);
+                os.put((char)byte);
+                byte = 0;
+            }
+        }
+    }
+
+    ~BinaryWriter() override {
+        close_record();
+    }
+
+private:
+    std::ofstream os;
+    std::vector<std::string> names;
+    std::vector<int> widths;
+    uint64_t last_ps;
+    bool open_record;
+
+    void close_record() {
+        if (open_record) {
+            os.put(0);
+            open_record = false;
+        }
+    }
+
+    void varint(uint64_t v) {
+        while (v >= 0x80) {
+            os.put((char)((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        os.put((char)v);
+    }
+};
+
+#ifdef FFT_TRACE_FST
+class FstWriter : public WaveWriter {
+public:
+    explicit FstWriter(const std::string& path) : ctx(fstWriterCreate(path.c_str(), 1)) {
+        if (ctx) {
+            fstWriterSetTimescaleFromString(ctx, "1ps");
+            fstWriterSetPackType(ctx, FST_WR_PT_LZ4);
+        }
+    }
+
+    bool ok() const override { return ctx != nullptr; }
+
+    void declare(const std::string& name, int width) override {
+        handles.push_back(fstWriterCreateVar(ctx, FST_VT_VCD_WIRE, FST_VD_IMPLICIT, width, name.c_str(), 0));
+    }
+
+    void end_header() override {}
+
+    void time(uint64_t ps) override {
+        fstWriterEmitTimeChange(ctx, ps);
+    }
+
+    void change(int index, const std::string& bits) override {
+        fstWriterEmitValueChange(ctx, handles[index], bits.c_str());
+    }
+
+    ~FstWriter() override {
+        if (ctx) {
+            fstWriterClose(ctx);
+        }
+    }
+
+private:
+    void* ctx;
+    std::vector<fstHandle> handles;
+};
+#endif
+
+// Cycle-sampled tracer of the selected signals
+SC_MODULE(WaveTracer) {
+    // One traced signal
+    struct Probe {
+        virtual ~Probe() {}
+        virtual std::string sample() const = 0;
+        std::string name;
+        int width;
+        std::string last;
+    };
+
+    template<typename T>
+    struct SignalProbe : Probe {
+        const sc_signal_in_if<T>& sig;
+        explicit SignalProbe(const sc_signal_in_if<T>& s) : sig(s) {}
+        std::string sample() const override { return WaveValue<T>::bits(sig.read()); }
+    };
+
+    // Valid/ready pair counted as one transaction per handshake cycle
+    struct Handshake {
+        const sc_signal_in_if<bool>* val;
+        const sc_signal_in_if<bool>* rdy;
+    };
+
+    const TraceOptions opts;
+    sc_clock& clk;
+    std::vector<std::unique_ptr<Probe>> probes;
+    std::vector<Handshake> handshakes;
+    std::unique_ptr<WaveWriter> writer;
+
+    long cycle;
+    long transactions;
+    bool header_done;
+    unsigned long samples_written;
+
+    bool selected(const std::string& group, int core) const {
+        return list_contains(opts.groups, group) &&
+               (core < 0 || list_contains(opts.cores, std::to_string(core)));
+    }
+
+    // Register a signal of a group; core -1 marks a signal shared by all cores
+    template<typename T>
+    void add(const std::string& group, int core, const std::string& name, const sc_signal_in_if<T>& sig) {
+        if (!selected(group, core)) {
+            return;
+        }
+        SignalProbe<T>* probe = new SignalProbe<T>(sig);
+        probe->name = name;
+        probe->width = WaveValue<T>::width();
+        probes.emplace_back(probe);
+    }
+
+    // Count the handshakes of an address channel for the transaction window
+    void add_transaction(const sc_signal_in_if<bool>& val, const sc_signal_in_if<bool>& rdy, int core) {
+        if (core < 0 || list_contains(opts.cores, std::to_string(core))) {
+            Handshake h = { &val, &rdy };
+            handshakes.push_back(h);
+        }
+    }
+
+    bool in_window() const {
+        return cycle >= opts.start_cycle && (opts.stop_cycle < 0 || cycle <= opts.stop_cycle) &&
+               transactions >= opts.start_txn && (opts.stop_txn < 0 || transactions < opts.stop_txn);
+    }
+
+    void sample_method() {
+        cycle++;
+        for (const Handshake& h : handshakes) {
+            if (h.val->read() && h.rdy->read()) {
+                transactions++;
+            }
+        }
+        if (!writer || !in_window()) {
+            return;
+        }
+        if (!header_done) {
+            writer->declare("Control.clk", 1);
+            for (const auto& probe : probes) {
+                writer->declare(probe->name, probe->width);
+            }
+            writer->end_header();
+            header_done = true;
+        }
+
+        // Values of the cycle are shown from its rising edge; clk falls at the sample point
+        uint64_t now_ps = (uint64_t)(sc_time_stamp() / sc_time(1.0, SC_PS));
+        uint64_t half_ps = (uint64_t)(clk.period() / sc_time(2.0, SC_PS));
+        writer->time(now_ps - half_ps);
+        writer->change(0, "1");
+        for (size_t i = 0; i < probes.size(); ++i) {
+            std::string value = probes[i]->sample();
+            if (value != probes[i]->last) {
+                writer->change(i + 1, value);
+                probes[i]->last = value;
+            }
+        }
+        writer->time(now_ps);
+        writer->change(0, "0");
+        samples_written++;
+    }
+
+    SC_HAS_PROCESS(WaveTracer);
+    WaveTracer(sc_module_name name, sc_clock& clk, const TraceOptions& opts, const std::string& path_base)
+        : sc_module(name),
+          opts(opts),
+          clk(clk),
+          cycle(-1),
+          transactions(0),
+          header_done(false),
+          samples_written(0)
+    {
+        if (opts.format == "vcd") {
+            writer.reset(new VcdWriter(path_base + ".vcd"));
+        } else if (opts.format == "bin") {
+            writer.reset(new BinaryWriter(path_base + ".wave"));
+#ifdef FFT_TRACE_FST
+        } else if (opts.format == "fst") {
+            writer.reset(new FstWriter(path_base + ".fst"));
+#endif
+        }
+        if (!writer || !writer->ok()) {
+            std::cerr << "Warning: cannot open trace file " << path_base << ", tracing disabled" << std::endl;
+            writer.reset();
+        }
+
+        SC_METHOD(sample_method);
+        sensitive << clk.negedge_event();
+        dont_initialize();
+    }
+};
+
+#endif // WAVE_TRACER_H
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+import argparse
+import sys
+
+CODES = "01xz"
+
+def read_varint(data, pos):
+    """Decodes one LEB128 varint and returns (value, next position)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+def vcd_id(n):
+    """Short printable VCD identifier, the same as the tracer's VCD writer."""
+    ident = ""
+    while True:
+        ident += chr(ord('!') + n % 94)
+        n //= 94
+        if n == 0:
+            return ident
+
+def write_header(out, names, widths):
+    """Declarations with one scope per dotted name component."""
+    out.write("$timescale 1 ps $end\n")
+    scopes = []
+    for i, (name, width) in enumerate(zip(names, widths)):
+        parts = name.split(".")
+        common = 0
+        while common < len(scopes) and common + 1 < len(parts) and scopes[common] == parts[common]:
+            common += 1
+        for _ in range(len(scopes) - common):
+            out.write("$upscope $end\n")
+        scopes = scopes[:common]
+        for part in parts[common:-1]:
+            out.write(f"$scope module {part} $end\n")
+            scopes.append(part)
+        out.write(f"$var wire {width} {vcd_id(i)} {parts[-1]} $end\n")
+    for _ in scopes:
+        out.write("$upscope $end\n")
+    out.write("$enddefinitions $end\n")
+
+def convert(data, out):
+    """Translates a binary .wave stream (test/wave_tracer.h) into VCD text."""
+    if data[:8] != b"FFTWAVE1":
+        raise ValueError("not an FFT waveform file")
+    pos = 8
+    count, pos = read_varint(data, pos)
+    names, widths = [], []
+    for _ in range(count):
+        length, pos = read_varint(data, pos)
+        names.append(data[pos:pos + length].decode())
+        pos += length
+        width, pos = read_varint(data, pos)
+        widths.append(width)
+    write_header(out, names, widths)
+
+    time_ps = 0
+    while pos < len(data):
+        delta, pos = read_varint(data, pos)
+        time_ps += delta
+        out.write(f"#{time_ps}\n")
+        while True:
+            index, pos = read_varint(data, pos)
+            if index == 0:
+                break
+            index -= 1
+            width = widths[index]
+            nbytes = (width + 3) // 4
+            bits = []
+            for b in data[pos:pos + nbytes]:
+                for shift in (6, 4, 2, 0):
+                    bits.append(CODES[(b >> shift) & 3])
+            pos += nbytes
+            value = "".join(bits[:width])
+            if width == 1:
+                out.write(f"{value}{vcd_id(index)}\n")
+            else:
+                out.write(f"b{value} {vcd_id(index)}\n")
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a binary waveform (TRACE=bin) to VCD")
+    parser.add_argument("input", help="Binary waveform, e.g. out/trace.wave")
+    parser.add_argument("output", nargs="?", help="VCD file (default: input with .vcd extension)")
+    args = parser.parse_args()
+
+    output = args.output
+    if output is None:
+        output = args.input[:-5] + ".vcd" if args.input.endswith(".wave") else args.input + ".vcd"
+    with open(args.input, "rb") as f_in:
+        data = f_in.read()
+    try:
+        with open(output, "w") as f_out:
+            convert(data, f_out)
+    except (ValueError, IndexError) as e:
+        print(f"Error: {args.input}: {e}", file=sys.stderr)
+        return 1
+    print(f"Wrote {output}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())